@@ -56,6 +56,41 @@ namespace casadi {
     return (*this)->FunctionInternal::eval_dm(arg);
   }
 
+  bool Callback::has_eval_batch() const {
+    return false;
+  }
+
+  std::vector<DM> Callback::eval_batch(casadi_int n, const std::vector<DM>& arg) const {
+    casadi_error("'eval_batch' not defined for Callback '" + name() + "'");
+  }
+
+  int Callback::eval_batch(casadi_int n, const double** arg, double** res) const {
+    // Instances side by side
+    std::vector<DM> argv(n_in());
+    for (casadi_int i=0; i<argv.size(); ++i) {
+      argv[i] = DM(repmat(sparsity_in(i), 1, n));
+      casadi_copy(arg[i], argv[i].nnz(), argv[i].ptr());
+    }
+
+    // Evaluate
+    std::vector<DM> resv = eval_batch(n, argv);
+    casadi_assert(resv.size()==n_out(),
+      "Expected " + str(n_out()) + " outputs, got " + str(resv.size()) + ".");
+
+    // Get outputs
+    for (casadi_int i=0; i<resv.size(); ++i) {
+      Sparsity sp = repmat(sparsity_out(i), 1, n);
+      if (resv[i].sparsity()!=sp) {
+        casadi_assert(resv[i].size()==sp.size(),
+          "Shape mismatch for output " + str(i) + ": got " + resv[i].dim() + ", "
+          "expected " + sp.dim() + ".");
+        resv[i] = project(resv[i], sp);
+      }
+      casadi_copy(resv[i].ptr(), resv[i].nnz(), res[i]);
+    }
+    return 0;
+  }
+
   casadi_int Callback::get_n_in() {
     return (*this)->FunctionInternal::get_n_in();
   }
@@ -85,6 +85,25 @@ namespace casadi {
     /** \brief Evaluate numerically, temporary matrices and work vectors */
     virtual std::vector<DM> eval(const std::vector<DM>& arg) const;
 
+    ///@{
+    /** \brief Evaluate n instances at once
+     * Input/output k holds the instances side by side, as in map, i.e. it is
+     * size1_in(k)-by-(n*size2_in(k)). Used by map (serial or thread) when
+     * has_eval_batch returns true.
+     */
+    virtual bool has_eval_batch() const;
+    virtual std::vector<DM> eval_batch(casadi_int n, const std::vector<DM>& arg) const;
+    ///@}
+
+#ifndef SWIG
+    /** \brief Evaluate n instances at once, with raw buffers
+     * Input/output k of instance i starts at arg[k]/res[k] + i*nnz_in(k)/nnz_out(k);
+     * null pointers are to be skipped. Return 0 on success.
+     * Defaults to wrapping the buffers and calling the DM overload.
+     */
+    virtual int eval_batch(casadi_int n, const double** arg, double** res) const;
+#endif // SWIG
+
    /** \brief Get the number of inputs
      * This function is called during construction.
      */
@@ -91,6 +91,15 @@ namespace casadi {
     TRY_CALL(eval, self_, arg);
   }
 
+  bool CallbackInternal::has_eval_batch() const {
+    TRY_CALL(has_eval_batch, self_);
+  }
+
+  int CallbackInternal::eval_batch(casadi_int n, const double** arg, double** res,
+                                   casadi_int* iw, double* w, void* mem) const {
+    TRY_CALL(eval_batch, self_, n, arg, res);
+  }
+
   bool CallbackInternal::uses_output() const {
     TRY_CALL(uses_output, self_);
   }
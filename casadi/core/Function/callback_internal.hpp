@@ -73,6 +73,13 @@ namespace casadi {
     bool has_eval_dm() const override { return true;}
     ///@}
 
+    ///@{
+    /** \brief Evaluate n instances at once */
+    bool has_eval_batch() const override;
+    int eval_batch(casadi_int n, const double** arg, double** res,
+                   casadi_int* iw, double* w, void* mem) const override;
+    ///@}
+
     /** \brief Do the derivative functions need nondifferentiated outputs? */
     bool uses_output() const override;
 
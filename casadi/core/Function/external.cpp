@@ -79,6 +79,10 @@ namespace casadi {
     // Work vector sizes
     work_ = (work_t)li_.get_function(name_ + "_work");
 
+    // Evaluation of several instances in one call, optional
+    eval_batch_ = li_.has_function(name_ + "_eval_batch") ?
+      (eval_batch_t)li_.get_function(name_ + "_eval_batch") : nullptr;
+
     // Increase reference counter - external function memory initialized at this point
     if (incref_) incref_();
   }
@@ -288,6 +292,11 @@ namespace casadi {
     }
   }
 
+  int External::eval_batch(casadi_int n, const double** arg, double** res,
+                           casadi_int* iw, double* w, void* mem) const {
+    return eval_batch_(n, arg, res, iw, w, mem);
+  }
+
   bool External::has_jacobian() const {
     if (FunctionInternal::has_jacobian()) return true;
     return li_.has_function("jac_" + name_);
@@ -66,6 +66,9 @@ namespace casadi {
     /** \brief Work vector sizes */
     work_t work_;
 
+    /** \brief Evaluation of several instances in one call */
+    eval_batch_t eval_batch_;
+
     ///@{
     /** \brief Data vectors */
     std::vector<casadi_int> int_data_;
@@ -105,6 +108,13 @@ namespace casadi {
     /** \brief Generate code for the body of the C function */
     void codegen_body(CodeGenerator& g) const override;
 
+    ///@{
+    /** \brief  Evaluate n instances in one call */
+    bool has_eval_batch() const override { return eval_batch_!=nullptr;}
+    int eval_batch(casadi_int n, const double** arg, double** res,
+                   casadi_int* iw, double* w, void* mem) const override;
+    ///@}
+
     ///@{
     /** \brief Number of function inputs and outputs */
     size_t get_n_in() override;
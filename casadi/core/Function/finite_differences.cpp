@@ -66,6 +66,10 @@ namespace casadi {
         {OT_INT,
         "Number of iterations to improve on the step-size "
         "[default: 1 if error estimate available, otherwise 0]"}},
+      {"parallelization",
+        {OT_STRING,
+        "Evaluate the perturbations of all directions in one mapped call: "
+        "serial|openmp|thread [default: serial, one direction at a time]"}},
      }
   };
 
@@ -82,6 +86,7 @@ namespace casadi {
     h_ = calc_stepsize(m_.abstol);
     u_aim_ = 100;
     h_iter_ = has_err() ? 1 : 0;
+    parallelization_ = "serial";
 
     // Read options
     for (auto&& op : opts) {
@@ -101,6 +106,8 @@ namespace casadi {
         u_aim_ = op.second;
       } else if (op.first=="h_iter") {
         h_iter_ = op.second;
+      } else if (op.first=="parallelization") {
+        parallelization_ = op.second.to_string();
       }
     }
 
@@ -127,6 +134,15 @@ namespace casadi {
 
     // Allocate sufficient temporary memory for function evaluation
     alloc(derivative_of_);
+
+    // Map over the directions, each thread checks out its own memory
+    if (parallelization_!="serial" && n_>1) {
+      fmap_ = derivative_of_.map(n_, parallelization_);
+      alloc(fmap_);
+      alloc_w(n_, true); // h
+      alloc_w(n_ * (n_pert() + 1) * n_y_, true); // J, yk for all directions
+      alloc_w(n_ * (n_z_ + n_y_), true); // z, y for all directions
+    }
   }
 
   Sparsity FiniteDiff::get_sparsity_in(casadi_int i) {
@@ -199,6 +215,8 @@ namespace casadi {
 
   int FiniteDiff::eval(const double** arg, double** res,
       casadi_int* iw, double* w, void* mem) const {
+    if (!fmap_.is_null()) return eval_map(arg, res, iw, w);
+
     // Shorthands
     casadi_int n_in = derivative_of_.n_in(), n_out = derivative_of_.n_out();
     casadi_int n_pert = this->n_pert();
@@ -297,6 +315,117 @@ namespace casadi {
     return 0;
   }
 
+  int FiniteDiff::eval_map(const double** arg, double** res,
+      casadi_int* iw, double* w) const {
+    // Shorthands
+    casadi_int n_in = derivative_of_.n_in(), n_out = derivative_of_.n_out();
+    casadi_int n_pert = this->n_pert();
+
+    // Non-differentiated input
+    const double** x0 = arg;
+    arg += n_in;
+
+    // Non-differentiated output
+    double* y0 = w;
+    for (casadi_int j=0; j<n_out; ++j) {
+      const casadi_int nnz = derivative_of_.nnz_out(j);
+      casadi_copy(*arg++, nnz, w);
+      w += nnz;
+    }
+
+    // Forward seeds
+    const double** seed = arg;
+    arg += n_in;
+
+    // Forward sensitivities
+    double** sens = res;
+    res += n_out;
+
+    // Perturbed function values of the current direction
+    double** yk = res;
+    res += n_pert;
+
+    // Step size, finite difference approximation and perturbed values, per direction
+    double* h = w;
+    w += n_;
+    double* J = w;
+    w += n_ * n_y_;
+    double* Yk = w;
+    w += n_ * n_pert * n_y_;
+
+    // Inputs and outputs of the mapped function, direction i at offset i*nnz
+    double* z = w;
+    for (casadi_int j=0; j<n_in; ++j) {
+      arg[j] = w;
+      w += n_ * derivative_of_.nnz_in(j);
+    }
+    for (casadi_int j=0; j<n_out; ++j) {
+      res[j] = w;
+      w += n_ * derivative_of_.nnz_out(j);
+    }
+
+    // Initial stepsize
+    casadi_fill(h, n_, h_);
+
+    // Perform finite difference algorithm with different step sizes
+    for (casadi_int iter=0; iter<1+h_iter_; ++iter) {
+      // Calculate perturbed function values, all directions at once
+      for (casadi_int k=0; k<n_pert; ++k) {
+        // Perturb inputs
+        double* zj = z;
+        for (casadi_int j=0; j<n_in; ++j) {
+          casadi_int nnz = derivative_of_.nnz_in(j);
+          for (casadi_int i=0; i<n_; ++i) {
+            casadi_copy(x0[j], nnz, zj);
+            if (seed[j]) casadi_axpy(nnz, pert(k, h[i]), seed[j] + i*nnz, zj);
+            zj += nnz;
+          }
+        }
+        // Evaluate
+        if (fmap_(arg, res, iw, w)) return 1;
+        // Save outputs
+        for (casadi_int i=0; i<n_; ++i) {
+          double* yki = Yk + (i*n_pert + k)*n_y_;
+          for (casadi_int j=0; j<n_out; ++j) {
+            casadi_int nnz = derivative_of_.nnz_out(j);
+            casadi_copy(res[j] + i*nnz, nnz, yki);
+            yki += nnz;
+          }
+        }
+      }
+
+      // For all sensitivity directions
+      for (casadi_int i=0; i<n_; ++i) {
+        for (casadi_int k=0; k<n_pert; ++k) yk[k] = Yk + (i*n_pert + k)*n_y_;
+        // Finite difference calculation with error estimate
+        double u = calc_fd(yk, y0, J + i*n_y_, h[i]);
+        if (iter==h_iter_) continue;
+
+        // Update step size
+        if (u < 0) {
+          // Perturbation failed, try a smaller step size
+          h[i] /= u_aim_;
+        } else {
+          // Update h to get u near the target ratio
+          h[i] *= sqrt(u_aim_ / fmax(1., u));
+        }
+        // Make sure h stays in the range [h_min_,h_max_]
+        h[i] = fmin(fmax(h[i], h_min_), h_max_);
+      }
+    }
+
+    // Gather sensitivities
+    for (casadi_int i=0; i<n_; ++i) {
+      casadi_int off = 0;
+      for (casadi_int j=0; j<n_out; ++j) {
+        casadi_int nnz = derivative_of_.nnz_out(j);
+        if (sens[j]) casadi_copy(J + i*n_y_ + off, nnz, sens[j] + i*nnz);
+        off += nnz;
+      }
+    }
+    return 0;
+  }
+
   double ForwardDiff::calc_fd(double** yk, double* y0, double* J, double h) const {
     return casadi_forward_diff(yk, y0, J, h, n_y_, &m_);
   }
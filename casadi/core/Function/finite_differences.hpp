@@ -76,6 +76,9 @@ namespace casadi {
     // Evaluate numerically
     int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
 
+    // Evaluate numerically, all directions in one call to the mapped function
+    int eval_map(const double** arg, double** res, casadi_int* iw, double* w) const;
+
     /** \brief Is the scheme using the (nondifferentiated) output? */
     bool uses_output() const override {return true;}
 
@@ -128,6 +131,12 @@ namespace casadi {
     // Allowed step size range
     double h_min_, h_max_;
 
+    // Parallelization of the perturbed evaluations over the directions
+    std::string parallelization_;
+
+    // derivative_of_ mapped over the directions, unless serial
+    Function fmap_;
+
     // Memory object
     casadi_finite_diff_mem<double> m_;
   };
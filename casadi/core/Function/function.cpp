@@ -33,6 +33,8 @@
 #include "sx_function.hpp"
 #include "mx_function.hpp"
 #include "switch.hpp"
+#include "map.hpp"
+#include "mapaccum.hpp"
 #include "bspline.hpp"
 #include "nlpsol.hpp"
 #include "conic.hpp"
@@ -261,9 +263,25 @@ namespace casadi {
 
   Function Function::expand(const string& name, const Dict& opts) const {
     casadi_assert(!has_free(), "Function with free symbols cannot be expanded.");
+    Dict options = opts;
+
+    // Keep loops, e.g. maps, instead of unrolling them into the SX algorithm
+    bool keep_loops = false;
+    auto it = options.find("keep_loops");
+    if (it!=options.end()) {
+      keep_loops = it->second;
+      options.erase(it);
+    }
+
+    // Loop over an expanded body
+    if (keep_loops) {
+      Function ret = (*this)->expand_loops(name, options);
+      if (!ret.is_null()) return ret;
+    }
+
     vector<SX> ex_in = sx_in();
     vector<SX> ex_out = Function(*this)(ex_in);
-    return Function(name, ex_in, ex_out, name_in(), name_out(), opts);
+    return Function(name, ex_in, ex_out, name_in(), name_out(), options);
   }
 
   Function Function::create(FunctionInternal* node) {
@@ -452,8 +470,19 @@ namespace casadi {
       options.erase(it);
     }
 
+    // Snapshots for the reverse mode of the loop
+    casadi_int checkpoints = 0;
+    it = options.find("checkpoints");
+    if (it!=options.end()) {
+      checkpoints = it->second;
+      options.erase(it);
+    }
+
     casadi_assert(N>0, "mapaccum: N must be positive");
 
+    if (base==0) {
+      return Function::create(new MapAccum(name, *this, N, n_accum, checkpoints), options);
+    }
     if (base==-1)
       return mapaccum(name, std::vector<Function>(N, *this), n_accum, options);
     casadi_assert(base>=2, "mapaccum: base must be positive");
@@ -558,6 +587,13 @@ namespace casadi {
   Function Function::map(const string& name, const std::string& parallelization, casadi_int n,
       const vector<casadi_int>& reduce_in, const vector<casadi_int>& reduce_out,
         const Dict& opts) const {
+    // Reduced inputs and outputs are handled by the map itself
+    if (parallelization=="serial" || parallelization=="openmp" || parallelization=="thread") {
+      vector<bool> red_in(n_in(), false), red_out(n_out(), false);
+      for (casadi_int i : reduce_in) red_in.at(i) = true;
+      for (casadi_int i : reduce_out) red_out.at(i) = true;
+      return Map::create(name, parallelization, *this, n, red_in, red_out, opts);
+    }
     // Wrap in an MXFunction
     Function f = map(n, parallelization);
     // Start with the fully mapped inputs
@@ -689,9 +725,11 @@ namespace casadi {
       const vector<double>& coeffs, const vector<casadi_int>& degree,
         casadi_int m, const Dict& opts) {
     try {
-      MX x = MX::sym("x", degree.size());
       std::vector<std::string> lookup_mode;
+      casadi_int batch_x = 1;
       Dict opts_remainder = extract_from_dict(opts, "lookup_mode", lookup_mode);
+      extract_from_dict_inplace(opts_remainder, "batch_x", batch_x);
+      MX x = MX::sym("x", degree.size(), batch_x);
       Dict opts_bspline;
       opts_bspline["lookup_mode"] = lookup_mode;
       MX y = MX::bspline(x, DM(coeffs), knots, degree, m, opts_bspline);
@@ -184,7 +184,11 @@ namespace casadi {
     /** \brief  Destructor */
     ~Function();
 
-    /** \brief Expand a function to SX */
+    /** \brief Expand a function to SX
+
+        Set the option "keep_loops" to true to not unroll maps and mapaccum
+        loops: each becomes a loop over an SX expansion of its body, connected
+        by MX, and the result is an MXFunction if there are any. */
     ///@{
     Function expand() const;
     Function expand(const std::string& name,
@@ -540,6 +544,13 @@ namespace casadi {
 
         Set base to -1 to unroll all the way; no gains in memory efficiency here.
 
+        Set base to 0 to evaluate the recurrence in a loop, with a graph size
+        independent of N. The accumulated outputs must then have the sparsity of
+        the corresponding inputs. Its reverse mode sweeps over the state
+        trajectory X, or, if the option checkpoints is set, recomputes the states
+        from that many snapshots following a binomial (Revolve) schedule, without
+        depending on X.
+
     */
     Function mapaccum(const std::string& name, casadi_int N, const Dict& opts = Dict()) const;
     Function mapaccum(const std::string& name, casadi_int N, casadi_int n_accum,
@@ -609,7 +620,8 @@ namespace casadi {
 
     /** \brief BSpline evaluator function
      *
-     *  Requires a known coefficient tensor
+     *  Requires a known coefficient tensor.
+     *  With option batch_x, the function is evaluated at batch_x points at once
      */
     static Function bspline(const std::string &name,
       const std::vector< std::vector<double> >& knots, const std::vector<double>& coeffs,
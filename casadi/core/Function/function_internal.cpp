@@ -34,6 +34,7 @@
 #include "sx_function.hpp"
 #include "rootfinder_impl.hpp"
 #include "map.hpp"
+#include "mapaccum.hpp"
 #include "switch.hpp"
 #include "interpolant_impl.hpp"
 #include "nlpsol_impl.hpp"
@@ -772,6 +773,11 @@ namespace casadi {
     return f;
   }
 
+  Function FunctionInternal::expand_loops(const std::string& name, const Dict& opts) const {
+    // No loops by default
+    return Function();
+  }
+
   std::vector<MX> FunctionInternal::symbolic_output(const std::vector<MX>& arg) const {
     return self()(arg);
   }
@@ -3074,6 +3080,12 @@ namespace casadi {
     }
   }
 
+  int FunctionInternal::
+  eval_batch(casadi_int n, const double** arg, double** res,
+             casadi_int* iw, double* w, void* mem) const {
+    casadi_error("'eval_batch' not defined for " + class_name());
+  }
+
   int FunctionInternal::
   eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
     if (has_eval_dm()) {
@@ -3373,6 +3385,8 @@ namespace casadi {
     {"Interpolant", Interpolant::deserialize},
     {"Switch", Switch::deserialize},
     {"Map", Map::deserialize},
+    {"MapAccum", MapAccum::deserialize},
+    {"MapAccumRev", MapAccumRev::deserialize},
     {"Nlpsol", Nlpsol::deserialize},
     {"Rootfinder", Rootfinder::deserialize},
     {"Integrator", Integrator::deserialize},
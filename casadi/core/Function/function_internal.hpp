@@ -125,6 +125,14 @@ namespace casadi {
     /** \brief Clear all memory (called from destructor) */
     void clear_mem();
 
+    /** \brief Work vector lengths of generated code for nrhs right-hand-sides
+
+        Lets a linear solver generate code that works in the caller's "iw" and
+        "w" rather than in local arrays, e.g. for blocked multi-RHS solves */
+    virtual void codegen_work(casadi_int nrhs, size_t& sz_iw, size_t& sz_w) const {
+      sz_iw = sz_w = 0;
+    }
+
     /** \brief C-style formatted printing during evaluation */
     void print(const char* fmt, ...) const;
 
@@ -238,6 +246,22 @@ namespace casadi {
     virtual int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const;
     ///@}
 
+    ///@{
+    /** \brief  Evaluate n instances in one call
+     * Input/output k of instance i starts at arg[k]/res[k] + i*nnz, as in Map.
+     * Work vectors are those of a single evaluation.
+     */
+    virtual bool has_eval_batch() const { return false;}
+    virtual int eval_batch(casadi_int n, const double** arg, double** res,
+                           casadi_int* iw, double* w, void* mem) const;
+    ///@}
+
+    /** \brief  Can eval_batch be used without bypassing the options handled by eval_gen? */
+    bool use_eval_batch() const {
+      return has_eval_batch() && !eval_ && !dump_in_ && !dump_out_ && !dump_
+        && !print_in_ && !print_out_;
+    }
+
     /** \brief  Evaluate with symbolic scalars */
     virtual int eval_sx(const SXElem** arg, SXElem** res,
       casadi_int* iw, SXElem* w, void* mem) const;
@@ -530,6 +554,12 @@ namespace casadi {
     /** \brief Wrap in an Function instance consisting of only one MX call */
     Function wrap() const;
 
+    /** \brief Expand to SX, keeping loops (null if there are none)
+
+        Loops such as Map and MapAccum are kept as a single node looping over
+        an SX expansion of their body, instead of being unrolled. */
+    virtual Function expand_loops(const std::string& name, const Dict& opts) const;
+
     /** \brief Get function in cache */
     bool incache(const std::string& fname, Function& f) const;
 
@@ -159,6 +159,7 @@ namespace casadi {
               : FunctionInternal(name), m_(m), grid_(grid), offset_(offset),  values_(values) {
     // Number of grid points
     ndim_ = offset_.size()-1;
+    batch_x_ = 1;
   }
 
   Interpolant::~Interpolant() {
@@ -166,7 +167,7 @@ namespace casadi {
 
   Sparsity Interpolant::get_sparsity_in(casadi_int i) {
     if (i==0) {
-      return Sparsity::dense(ndim_);
+      return Sparsity::dense(ndim_, batch_x_);
     }
     if (i==1) {
       casadi_assert_dev(is_parametric());
@@ -177,7 +178,7 @@ namespace casadi {
 
   Sparsity Interpolant::get_sparsity_out(casadi_int i) {
     casadi_assert_dev(i==0);
-    return Sparsity::dense(m_);
+    return Sparsity::dense(m_, batch_x_);
   }
 
   std::string Interpolant::get_name_in(casadi_int i) {
@@ -206,12 +207,28 @@ namespace casadi {
        {OT_STRINGVECTOR,
         "Specifies, for each grid dimenion, the lookup algorithm used to find the correct index. "
         "'linear' uses a for-loop + break; (default when #knots<=100), "
-        "'exact' uses floored division (only for uniform grids), "
-        "'binary' uses a binary search. (default when #knots>100)."}}
+        "'exact' uses floored division (only for uniform grids, default for those), "
+        "'binary' uses a binary search, "
+        "'index' uses a precomputed table followed by a short scan "
+        "(default when #knots>100)."}},
+      {"batch_x",
+       {OT_INT,
+        "Evaluate a batch of different inputs at once (default 1). "
+        "Only for plugins that support it."}}
      }
   };
 
   void Interpolant::init(const Dict& opts) {
+    // The batch size determines the sparsities, queried by the base class
+    for (auto&& op : opts) {
+      if (op.first=="batch_x") {
+        batch_x_ = op.second;
+      }
+    }
+    casadi_assert(batch_x_>=1, "'batch_x' must be positive");
+    casadi_assert(batch_x_==1 || has_batch_x(),
+      "Interpolant plugin '" + std::string(plugin_name()) + "' does not support 'batch_x'");
+
     // Call the base class initializer
     FunctionInternal::init(opts);
 
@@ -222,9 +239,49 @@ namespace casadi {
       }
     }
 
-    // Needed by casadi_interpn
-    alloc_w(ndim_, true);
-    alloc_iw(2*ndim_, true);
+    // Lookup modes
+    lookup_mode_ = interpret_lookup_mode(lookup_modes_, grid_, offset_);
+    lookup_index(grid_, offset_, lookup_mode_, lookup_index_, lookup_index_offset_);
+
+    // Needed by casadi_interpn and casadi_interpn_batch
+    alloc_w((ndim_+1)*batch_x_, true);
+    alloc_iw((ndim_+1)*batch_x_ + ndim_, true);
+  }
+
+  void Interpolant::lookup_index(const std::vector<double>& grid,
+      const std::vector<casadi_int>& offset, const std::vector<casadi_int>& lookup_mode,
+      std::vector<casadi_int>& index, std::vector<casadi_int>& index_offset) {
+    index.clear();
+    index_offset.resize(1, 0);
+    for (casadi_int i=0; i<lookup_mode.size(); ++i) {
+      if (lookup_mode[i]==3) {
+        // One bucket per interval, storing the left index of the bucket start
+        const double* g = get_ptr(grid) + offset[i];
+        casadi_int ng = offset[i+1]-offset[i], j = 0;
+        for (casadi_int b=0; b<ng; ++b) {
+          double xb = g[0] + b*(g[ng-1]-g[0])/ng;
+          while (j<ng-2 && xb>=g[j+1]) j++;
+          index.push_back(j);
+        }
+      }
+      index_offset.push_back(index.size());
+    }
+  }
+
+  void Interpolant::interpn_batch(double* res, const double* x, const double* values,
+                                  casadi_int* iw, double* w) const {
+    casadi_interpn_batch(res, ndim_, get_ptr(grid_), get_ptr(offset_), values, x,
+                         get_ptr(lookup_mode_), get_ptr(lookup_index_),
+                         get_ptr(lookup_index_offset_), m_, batch_x_, iw, w);
+  }
+
+  std::string Interpolant::codegen_interpn_batch(CodeGenerator& g, const std::string& res,
+      const std::string& x, const std::string& values,
+      const std::string& iw, const std::string& w) const {
+    return g.interpn_batch(res, ndim_, g.constant(grid_), g.constant(offset_), values, x,
+                           g.constant(lookup_mode_),
+                           lookup_index_.empty() ? "0" : g.constant(lookup_index_),
+                           g.constant(lookup_index_offset_), m_, batch_x_, iw, w);
   }
 
   std::vector<std::string> Interpolant::lookup_mode_from_enum(
@@ -241,6 +298,9 @@ namespace casadi {
         case 2:
           ret[i] = "binary";
           break;
+        case 3:
+          ret[i] = "index";
+          break;
         default:
           casadi_error("lookup_mode error.");
       }
@@ -257,8 +317,19 @@ namespace casadi {
     std::vector<casadi_int> ret(offset.size()-1, 0);
 
     for (casadi_int i=0;i<ret.size();++i) {
-      // If more than 100 knots -> default is binary search
-      if (offset[i+1]-offset[i]>100) ret[i] = 2;
+      casadi_int m_left  = margin_left.empty() ? 0 : margin_left[i];
+      casadi_int m_right = margin_right.empty() ? 0 : margin_right[i];
+      std::vector<double> grid(
+          knots.begin()+offset[i]+m_left,
+          knots.begin()+offset[i+1]-m_right);
+      if (grid.size()>2 && is_equally_spaced(grid)) {
+        // Uniform grid -> floored division
+        ret[i] = 1;
+      } else if (grid.size()>100) {
+        // More than 100 knots -> precomputed table if the caller builds one
+        // (no margins, see lookup_index), else binary search
+        ret[i] = margin_left.empty() && margin_right.empty() ? 3 : 2;
+      }
     }
 
     if (modes.empty()) return ret;
@@ -278,9 +349,11 @@ namespace casadi {
         casadi_assert_dev(is_increasing(grid) && is_equally_spaced(grid));
       } else if (modes[i]=="binary") {
         ret[i] = 2;
+      } else if (modes[i]=="index") {
+        ret[i] = 3;
       } else {
         casadi_error("Unknown lookup_mode option '" + modes[i] + ". "
-                     "Allowed values: linear, binary, exact.");
+                     "Allowed values: linear, binary, exact, index.");
       }
     }
     return ret;
@@ -288,13 +361,17 @@ namespace casadi {
 
   void Interpolant::serialize_body(SerializingStream &s) const {
     FunctionInternal::serialize_body(s);
-    s.version("Interpolant", 1);
+    s.version("Interpolant", 2);
     s.pack("Interpolant::ndim", ndim_);
     s.pack("Interpolant::m", m_);
     s.pack("Interpolant::grid", grid_);
     s.pack("Interpolant::offset", offset_);
     s.pack("Interpolant::values", values_);
     s.pack("Interpolant::lookup_modes", lookup_modes_);
+    s.pack("Interpolant::batch_x", batch_x_);
+    s.pack("Interpolant::lookup_mode", lookup_mode_);
+    s.pack("Interpolant::lookup_index", lookup_index_);
+    s.pack("Interpolant::lookup_index_offset", lookup_index_offset_);
   }
 
   void Interpolant::serialize_type(SerializingStream &s) const {
@@ -307,13 +384,17 @@ namespace casadi {
   }
 
   Interpolant::Interpolant(DeserializingStream & s) : FunctionInternal(s) {
-    s.version("Interpolant", 1);
+    s.version("Interpolant", 2);
     s.unpack("Interpolant::ndim", ndim_);
     s.unpack("Interpolant::m", m_);
     s.unpack("Interpolant::grid", grid_);
     s.unpack("Interpolant::offset", offset_);
     s.unpack("Interpolant::values", values_);
     s.unpack("Interpolant::lookup_modes", lookup_modes_);
+    s.unpack("Interpolant::batch_x", batch_x_);
+    s.unpack("Interpolant::lookup_mode", lookup_mode_);
+    s.unpack("Interpolant::lookup_index", lookup_index_);
+    s.unpack("Interpolant::lookup_index_offset", lookup_index_offset_);
   }
 
 } // namespace casadi
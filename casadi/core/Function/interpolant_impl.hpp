@@ -80,6 +80,9 @@ namespace casadi {
     /// Initialize
     void init(const Dict& opts) override;
 
+    /// Does the plugin evaluate batch_x query points at once (e.g. via interpn_batch)?
+    virtual bool has_batch_x() const { return false;}
+
     /// Convert from (optional) lookup modes labels to enum
     static std::vector<casadi_int> interpret_lookup_mode(const std::vector<std::string>& modes,
         const std::vector<double>& grid, const std::vector<casadi_int>& offset,
@@ -88,6 +91,11 @@ namespace casadi {
 
     static std::vector<std::string> lookup_mode_from_enum(const std::vector<casadi_int>& modes);
 
+    /// Precompute the lookup tables of the dimensions with lookup mode 'index'
+    static void lookup_index(const std::vector<double>& grid,
+      const std::vector<casadi_int>& offset, const std::vector<casadi_int>& lookup_mode,
+      std::vector<casadi_int>& index, std::vector<casadi_int>& index_offset);
+
     static void stack_grid(const std::vector< std::vector<double> >& grid,
       std::vector<casadi_int>& offset, std::vector<double>& stacked);
 
@@ -129,6 +137,21 @@ namespace casadi {
     // Lookup modes
     std::vector<std::string> lookup_modes_;
 
+    // Number of query points per evaluation
+    casadi_int batch_x_;
+
+    // Lookup mode enums and tables for the 'index' lookup mode
+    std::vector<casadi_int> lookup_mode_, lookup_index_, lookup_index_offset_;
+
+    /// Evaluate the multilinear interpolant at all batch_x query points
+    void interpn_batch(double* res, const double* x, const double* values,
+                       casadi_int* iw, double* w) const;
+
+    /// Generate code for the multilinear interpolant at all batch_x query points
+    std::string codegen_interpn_batch(CodeGenerator& g, const std::string& res,
+                                      const std::string& x, const std::string& values,
+                                      const std::string& iw, const std::string& w) const;
+
     /** \brief Serialize an object without type information */
     void serialize_body(SerializingStream &s) const override;
     /** \brief Serialize type information */
@@ -24,6 +24,7 @@
 
 
 #include "map.hpp"
+#include "switch.hpp"
 #include "serializing_stream.hpp"
 
 #ifdef CASADI_WITH_THREAD
@@ -34,6 +35,10 @@
 #endif // CASADI_WITH_THREAD_MINGW
 #endif // CASADI_WITH_THREAD
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif // WITH_OPENMP
+
 using namespace std;
 
 namespace casadi {
@@ -42,6 +47,10 @@ namespace casadi {
     // Create instance of the right class
     string suffix = str(n) + "_" + f.name();
     if (parallelization == "serial") {
+      // Switch instances are grouped by case
+      if (f.class_name()=="Switch") {
+        return Function::create(new SwitchMap("map" + suffix, f, n), Dict());
+      }
       return Function::create(new Map("map" + suffix, f, n), Dict());
     } else if (parallelization== "openmp") {
       return Function::create(new OmpMap("ompmap" + suffix, f, n), Dict());
@@ -52,14 +61,42 @@ namespace casadi {
     }
   }
 
-  Map::Map(const std::string& name, const Function& f, casadi_int n)
-    : FunctionInternal(name), f_(f), n_(n) {
+  Function Map::create(const std::string& name, const std::string& parallelization,
+                       const Function& f, casadi_int n,
+                       const std::vector<bool>& reduce_in,
+                       const std::vector<bool>& reduce_out, const Dict& opts) {
+    if (parallelization == "serial") {
+      // Switch instances are grouped by case
+      if (f.class_name()=="Switch") {
+        return Function::create(new SwitchMap(name, f, n, reduce_in, reduce_out), opts);
+      }
+      return Function::create(new Map(name, f, n, reduce_in, reduce_out), opts);
+    } else if (parallelization== "openmp") {
+      return Function::create(new OmpMap(name, f, n, reduce_in, reduce_out), opts);
+    } else if (parallelization== "thread") {
+      return Function::create(new ThreadMap(name, f, n, reduce_in, reduce_out), opts);
+    } else {
+      casadi_error("Unknown parallelization: " + parallelization);
+    }
+  }
+
+  Map::Map(const std::string& name, const Function& f, casadi_int n,
+           const std::vector<bool>& reduce_in, const std::vector<bool>& reduce_out)
+    : FunctionInternal(name), f_(f), n_(n), reduce_in_(reduce_in), reduce_out_(reduce_out) {
+    if (reduce_in_.empty()) reduce_in_.resize(f.n_in(), false);
+    if (reduce_out_.empty()) reduce_out_.resize(f.n_out(), false);
+    casadi_assert_dev(reduce_in_.size()==f.n_in() && reduce_out_.size()==f.n_out());
   }
 
   void Map::serialize_body(SerializingStream &s) const {
     FunctionInternal::serialize_body(s);
+    s.version("Map", 2);
     s.pack("Map::f", f_);
     s.pack("Map::n", n_);
+    s.pack("Map::reduce_in", reduce_in_);
+    s.pack("Map::reduce_out", reduce_out_);
+    s.pack("Map::nnz_red", nnz_red_);
+    s.pack("Map::nw", nw_);
   }
 
   void Map::serialize_type(SerializingStream &s) const {
@@ -68,8 +105,29 @@ namespace casadi {
   }
 
   Map::Map(DeserializingStream& s) : FunctionInternal(s) {
+    int version = s.version("Map", 1, 2);
     s.unpack("Map::f", f_);
     s.unpack("Map::n", n_);
+    if (version==1) {
+      // Written before reduced inputs/outputs: nothing reduced, one instance per worker
+      reduce_in_.resize(f_.n_in(), false);
+      reduce_out_.resize(f_.n_out(), false);
+      nnz_red_ = 0;
+      nw_ = n_;
+      // Parallel maps now pad the work of each worker, size it for the worst case
+      size_t sz_arg, sz_res, sz_iw, sz_w;
+      parallel_work(f_, sz_arg, sz_res, sz_iw, sz_w, 0);
+      alloc_iw(nw_, true);
+      alloc_arg(sz_arg * nw_);
+      alloc_res(sz_res * nw_);
+      alloc_iw(sz_iw * nw_);
+      alloc_w(sz_w * nw_);
+      return;
+    }
+    s.unpack("Map::reduce_in", reduce_in_);
+    s.unpack("Map::reduce_out", reduce_out_);
+    s.unpack("Map::nnz_red", nnz_red_);
+    s.unpack("Map::nw", nw_);
   }
 
   ProtoFunction* Map::deserialize(DeserializingStream& s) {
@@ -81,6 +139,8 @@ namespace casadi {
       return new OmpMap(s);
     } else if (class_name=="ThreadMap") {
       return new ThreadMap(s);
+    } else if (class_name=="SwitchMap") {
+      return new SwitchMap(s);
     } else {
       casadi_error("class name '" + class_name + "' unknown.");
     }
@@ -93,57 +153,176 @@ namespace casadi {
     // Call the initialization method of the base class
     FunctionInternal::init(opts);
 
+    // Nonzeros of the reduced outputs
+    nnz_red_ = 0;
+    for (casadi_int j=0; j<n_out_; ++j) {
+      if (reduce_out_[j]) nnz_red_ += f_.nnz_out(j);
+    }
+
+    // One instance per worker, unless redefined by a parallel map
+    nw_ = n_;
+
     // Allocate sufficient memory for serial evaluation
     alloc_arg(f_.sz_arg());
     alloc_res(f_.sz_res());
-    alloc_w(f_.sz_w());
+    alloc_w(f_.sz_w() + 2*nnz_red_);
     alloc_iw(f_.sz_iw());
   }
 
+  // Add the outputs of an instance to the partial sum
   template<typename T>
-  int Map::eval_gen(const T** arg, T** res, casadi_int* iw, T* w, casadi_int mem) const {
-    const T** arg1 = arg+n_in_;
-    copy_n(arg, n_in_, arg1);
-    T** res1 = res+n_out_;
-    copy_n(res, n_out_, res1);
-    for (casadi_int i=0; i<n_; ++i) {
+  static void map_sum(T* sum, const T* x, casadi_int n) {
+    for (casadi_int i=0; i<n; ++i) sum[i] += x[i];
+  }
+  static void map_sum(bvec_t* sum, const bvec_t* x, casadi_int n) {
+    for (casadi_int i=0; i<n; ++i) sum[i] |= x[i];
+  }
+
+  template<typename T>
+  int Map::eval_range(casadi_int k0, casadi_int k1, const T** arg, T** res,
+                      const T** arg1, T** res1, casadi_int* iw, T* w, casadi_int mem) const {
+    // Partial sums of the reduced outputs, outputs of one instance
+    T* sum = w; w += nnz_red_;
+    T* tmp = w; w += nnz_red_;
+    fill_n(sum, nnz_red_, T(0));
+    for (casadi_int j=0; j<n_in_; ++j) {
+      arg1[j] = arg[j] && !reduce_in_[j] ? arg[j] + k0*f_.nnz_in(j) : arg[j];
+    }
+    T* t = tmp;
+    for (casadi_int j=0; j<n_out_; ++j) {
+      if (reduce_out_[j]) {
+        res1[j] = res[j] ? t : nullptr;
+        t += f_.nnz_out(j);
+      } else {
+        res1[j] = res[j] ? res[j] + k0*f_.nnz_out(j) : nullptr;
+      }
+    }
+    for (casadi_int i=k0; i<k1; ++i) {
       if (f_(arg1, res1, iw, w, mem)) return 1;
       for (casadi_int j=0; j<n_in_; ++j) {
-        if (arg1[j]) arg1[j] += f_.nnz_in(j);
+        if (arg1[j] && !reduce_in_[j]) arg1[j] += f_.nnz_in(j);
       }
+      casadi_int off = 0;
       for (casadi_int j=0; j<n_out_; ++j) {
-        if (res1[j]) res1[j] += f_.nnz_out(j);
+        if (reduce_out_[j]) {
+          if (res1[j]) map_sum(sum + off, res1[j], f_.nnz_out(j));
+          off += f_.nnz_out(j);
+        } else if (res1[j]) {
+          res1[j] += f_.nnz_out(j);
+        }
+      }
+    }
+    return 0;
+  }
+
+  template<typename T>
+  int Map::eval_gen(const T** arg, T** res, casadi_int* iw, T* w, casadi_int mem) const {
+    if (eval_range(0, n_, arg, res, arg+n_in_, res+n_out_, iw, w, mem)) return 1;
+    // Reduced outputs
+    const T* sum = w;
+    for (casadi_int j=0; j<n_out_; ++j) {
+      if (reduce_out_[j]) {
+        if (res[j]) copy_n(sum, f_.nnz_out(j), res[j]);
+        sum += f_.nnz_out(j);
       }
     }
     return 0;
   }
 
+  void Map::reduce_tree(double** res, double* w, size_t sz_w) const {
+    // Pairwise sums in a fixed order, independent of the thread scheduling
+    for (casadi_int d=1; d<nw_; d*=2) {
+      for (casadi_int s=0; s+d<nw_; s+=2*d) {
+        casadi_axpy(nnz_red_, 1., w + (s+d)*sz_w, w + s*sz_w);
+      }
+    }
+    // Reduced outputs
+    const double* sum = w;
+    for (casadi_int j=0; j<n_out_; ++j) {
+      if (reduce_out_[j]) {
+        if (res[j]) copy_n(sum, f_.nnz_out(j), res[j]);
+        sum += f_.nnz_out(j);
+      }
+    }
+  }
+
   int Map::eval_sx(const SXElem** arg, SXElem** res, casadi_int* iw, SXElem* w, void* mem) const {
     return eval_gen(arg, res, iw, w);
   }
 
   int Map::sp_forward(const bvec_t** arg, bvec_t** res,
       casadi_int* iw, bvec_t* w, void* mem) const {
-    return eval_gen(arg, res, iw, w);
+    // Propagate through the Jacobian pattern of f_, computed once, rather
+    // than through n_ copies of its algorithm
+    for (casadi_int oind=0; oind<n_out_; ++oind) {
+      if (!res[oind]) continue;
+      casadi_int nnz_out = f_.nnz_out(oind);
+      fill_n(res[oind], reduce_out_[oind] ? nnz_out : n_*nnz_out, 0);
+      for (casadi_int iind=0; iind<n_in_; ++iind) {
+        if (!arg[iind]) continue;
+        casadi_int nnz_in = f_.nnz_in(iind);
+        Sparsity sp = f_.sparsity_jac(iind, oind, true, false);
+        const casadi_int* colind = sp.colind();
+        const casadi_int* row = sp.row();
+        for (casadi_int k=0; k<n_; ++k) {
+          const bvec_t* a = reduce_in_[iind] ? arg[iind] : arg[iind] + k*nnz_in;
+          bvec_t* r = reduce_out_[oind] ? res[oind] : res[oind] + k*nnz_out;
+          for (casadi_int c=0; c<nnz_in; ++c) {
+            for (casadi_int el=colind[c]; el<colind[c+1]; ++el) r[row[el]] |= a[c];
+          }
+        }
+      }
+    }
+    return 0;
   }
 
   int Map::sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const {
-    bvec_t** arg1 = arg+n_in_;
-    copy_n(arg, n_in_, arg1);
-    bvec_t** res1 = res+n_out_;
-    copy_n(res, n_out_, res1);
-    for (casadi_int i=0; i<n_; ++i) {
-      if (f_.rev(arg1, res1, iw, w)) return 1;
-      for (casadi_int j=0; j<n_in_; ++j) {
-        if (arg1[j]) arg1[j] += f_.nnz_in(j);
-      }
-      for (casadi_int j=0; j<n_out_; ++j) {
-        if (res1[j]) res1[j] += f_.nnz_out(j);
+    // Propagate through the Jacobian pattern of f_, as in sp_forward
+    for (casadi_int oind=0; oind<n_out_; ++oind) {
+      if (!res[oind]) continue;
+      casadi_int nnz_out = f_.nnz_out(oind);
+      for (casadi_int iind=0; iind<n_in_; ++iind) {
+        if (!arg[iind]) continue;
+        casadi_int nnz_in = f_.nnz_in(iind);
+        Sparsity sp = f_.sparsity_jac(iind, oind, true, false);
+        const casadi_int* colind = sp.colind();
+        const casadi_int* row = sp.row();
+        for (casadi_int k=0; k<n_; ++k) {
+          bvec_t* a = reduce_in_[iind] ? arg[iind] : arg[iind] + k*nnz_in;
+          const bvec_t* r = reduce_out_[oind] ? res[oind] : res[oind] + k*nnz_out;
+          for (casadi_int c=0; c<nnz_in; ++c) {
+            for (casadi_int el=colind[c]; el<colind[c+1]; ++el) a[c] |= r[row[el]];
+          }
+        }
       }
+      // Seeds are consumed
+      fill_n(res[oind], reduce_out_[oind] ? nnz_out : n_*nnz_out, 0);
     }
     return 0;
   }
 
+  Sparsity Map::getJacSparsity(casadi_int iind, casadi_int oind, bool symmetric) const {
+    // Block of one instance
+    Sparsity sp = f_.sparsity_jac(iind, oind, true, symmetric);
+    if (reduce_out_[oind]) {
+      // Summed output: one block per instance, side by side
+      return reduce_in_[iind] ? sp : repmat(sp, 1, n_);
+    } else {
+      // Stacked blocks for a shared input, block diagonal otherwise
+      return reduce_in_[iind] ? repmat(sp, n_, 1) : Sparsity::kron(Sparsity::diag(n_), sp);
+    }
+  }
+
+  Sparsity Map::get_jacobian_sparsity() const {
+    vector<vector<Sparsity>> blocks(n_out_, vector<Sparsity>(n_in_));
+    for (casadi_int oind=0; oind<n_out_; ++oind) {
+      for (casadi_int iind=0; iind<n_in_; ++iind) {
+        blocks[oind][iind] = sparsity_jac(iind, oind, false, false);
+      }
+    }
+    return Sparsity::blockcat(blocks);
+  }
+
   void Map::codegen_declarations(CodeGenerator& g) const {
     g.add_dependency(f_);
   }
@@ -152,31 +331,59 @@ namespace casadi {
     g << "casadi_int i;\n";
     g << "const casadi_real** arg1;\n";
     g << "casadi_real** res1;\n";
+    if (nnz_red_>0) g << "casadi_real* tmp;\n";
     // Input buffer
     g << "arg1 = arg+" << n_in_ << ";\n"
       << "for (i=0; i<" << n_in_ << "; ++i) arg1[i]=arg[i];\n";
     // Output buffer
     g << "res1 = res+" << n_out_ << ";\n"
-      << "for (i=0; i<" << n_out_ << "; ++i) res1[i]=res[i];\n"
-      << "for (i=0; i<" << n_ << "; ++i) {\n";
+      << "for (i=0; i<" << n_out_ << "; ++i) res1[i]=res[i];\n";
+    // Reduced outputs are summed directly in the output
+    if (nnz_red_>0) {
+      g << "tmp = w; w += " << nnz_red_ << ";\n";
+      casadi_int off = 0;
+      for (casadi_int j=0; j<n_out_; ++j) {
+        if (!reduce_out_[j]) continue;
+        g << "if (res[" << j << "]) {\n"
+          << g.clear("res[" + str(j) + "]", f_.nnz_out(j)) << "\n"
+          << "res1[" << j << "] = tmp+" << off << ";\n"
+          << "}\n";
+        off += f_.nnz_out(j);
+      }
+    }
+    g << "for (i=0; i<" << n_ << "; ++i) {\n";
     // Evaluate
     g << "if (" << g(f_, "arg1", "res1", "iw", "w") << ") return 1;\n";
     // Update input buffers
     for (casadi_int j=0; j<n_in_; ++j) {
+      if (reduce_in_[j]) continue;
       g << "if (arg1[" << j << "]) arg1[" << j << "]+=" << f_.nnz_in(j) << ";\n";
     }
     // Update output buffers
     for (casadi_int j=0; j<n_out_; ++j) {
-      g << "if (res1[" << j << "]) res1[" << j << "]+=" << f_.nnz_out(j) << ";\n";
+      if (reduce_out_[j]) {
+        g << "if (res1[" << j << "]) "
+          << g.axpy(f_.nnz_out(j), "1.", "res1[" + str(j) + "]", "res[" + str(j) + "]") << "\n";
+      } else {
+        g << "if (res1[" << j << "]) res1[" << j << "]+=" << f_.nnz_out(j) << ";\n";
+      }
     }
     g << "}\n";
   }
 
+  Function Map::expand_loops(const std::string& name, const Dict& opts) const {
+    // Expand the body, keeping loops nested inside it
+    Function f = f_.is_a("SXFunction") ? f_ : f_.expand(f_.name(), {{"keep_loops", true}});
+    return create(name, parallelization(), f, n_, reduce_in_, reduce_out_, opts);
+  }
+
   Function Map
   ::get_forward(casadi_int nfwd, const std::string& name,
                 const std::vector<std::string>& inames,
                 const std::vector<std::string>& onames,
                 const Dict& opts) const {
+    if (any_reduce()) return get_forward_reduce(nfwd, name, inames, onames, opts);
+
     // Generate map of derivative
     Function df = f_.forward(nfwd);
     Function dm = df.map(n_, parallelization());
@@ -228,6 +435,8 @@ namespace casadi {
                 const std::vector<std::string>& inames,
                 const std::vector<std::string>& onames,
                 const Dict& opts) const {
+    if (any_reduce()) return get_reverse_reduce(nadj, name, inames, onames, opts);
+
     // Generate map of derivative
     Function df = f_.reverse(nadj);
     Function dm = df.map(n_, parallelization());
@@ -274,14 +483,160 @@ namespace casadi {
     return Function(name, arg, res, inames, onames, opts);
   }
 
+  bool Map::any_reduce() const {
+    for (bool r : reduce_in_) if (r) return true;
+    for (bool r : reduce_out_) if (r) return true;
+    return false;
+  }
+
+  // Columns of nd directions of n instances, direction-major to instance-major
+  static vector<casadi_int> map_perm(casadi_int n, casadi_int nd, casadi_int sz) {
+    vector<casadi_int> ind;
+    for (casadi_int k=0; k<n; ++k) {
+      for (casadi_int d=0; d<nd; ++d) {
+        for (casadi_int j=0; j<sz; ++j) {
+          ind.push_back((d*n + k)*sz + j);
+        }
+      }
+    }
+    return ind;
+  }
+
+  Function Map
+  ::get_forward_reduce(casadi_int nfwd, const std::string& name,
+                       const std::vector<std::string>& inames,
+                       const std::vector<std::string>& onames,
+                       const Dict& opts) const {
+    // Derivative of one instance, recomputing the nominal outputs since the
+    // reduced ones are only available summed
+    vector<MX> x = f_.mx_in();
+    vector<MX> v = x;
+    vector<MX> y = f_(x);
+    v.insert(v.end(), y.begin(), y.end());
+    vector<MX> seed(n_in_);
+    for (casadi_int i=0; i<n_in_; ++i) {
+      seed[i] = MX::sym("fwd_" + name_in_[i], repmat(f_.sparsity_in(i), 1, nfwd));
+    }
+    v.insert(v.end(), seed.begin(), seed.end());
+    vector<MX> sens = f_.forward(nfwd)(v);
+    x.insert(x.end(), seed.begin(), seed.end());
+    Function df(f_.name() + "_fwd", x, sens);
+
+    // Map of the derivative, seeds of shared inputs shared and sensitivities
+    // of summed outputs summed
+    vector<bool> red_in = reduce_in_;
+    red_in.insert(red_in.end(), reduce_in_.begin(), reduce_in_.end());
+    Function dm = Map::create(name + "_map", parallelization(), df, n_, red_in, reduce_out_);
+
+    // Reorder the seeds to instance-major order
+    vector<MX> arg = mx_in(), res = mx_out();
+    vector<MX> fseed(n_in_), dm_arg = arg;
+    for (casadi_int i=0; i<n_in_; ++i) {
+      fseed[i] = MX::sym("fwd_" + name_in_[i], repmat(sparsity_in(i), 1, nfwd));
+      if (reduce_in_[i]) {
+        dm_arg.push_back(fseed[i]);
+      } else {
+        dm_arg.push_back(fseed[i](Slice(), map_perm(n_, nfwd, f_.size2_in(i)))); // NOLINT
+      }
+    }
+    vector<MX> fsens = dm(dm_arg);
+
+    // Reorder the sensitivities to direction-major order
+    for (casadi_int i=0; i<n_out_; ++i) {
+      if (reduce_out_[i]) continue;
+      vector<casadi_int> ind = lookupvector(map_perm(n_, nfwd, f_.size2_out(i)));
+      fsens[i] = fsens[i](Slice(), ind); // NOLINT
+    }
+
+    // Construct return function
+    arg.insert(arg.end(), res.begin(), res.end());
+    arg.insert(arg.end(), fseed.begin(), fseed.end());
+    return Function(name, arg, fsens, inames, onames, opts);
+  }
+
+  Function Map
+  ::get_reverse_reduce(casadi_int nadj, const std::string& name,
+                       const std::vector<std::string>& inames,
+                       const std::vector<std::string>& onames,
+                       const Dict& opts) const {
+    // Derivative of one instance, recomputing the nominal outputs since the
+    // reduced ones are only available summed
+    vector<MX> x = f_.mx_in();
+    vector<MX> v = x;
+    vector<MX> y = f_(x);
+    v.insert(v.end(), y.begin(), y.end());
+    vector<MX> seed(n_out_);
+    for (casadi_int i=0; i<n_out_; ++i) {
+      seed[i] = MX::sym("adj_" + name_out_[i], repmat(f_.sparsity_out(i), 1, nadj));
+    }
+    v.insert(v.end(), seed.begin(), seed.end());
+    vector<MX> sens = f_.reverse(nadj)(v);
+    x.insert(x.end(), seed.begin(), seed.end());
+    Function df(f_.name() + "_rev", x, sens);
+
+    // Map of the derivative, seeds of summed outputs shared and sensitivities
+    // of shared inputs summed
+    vector<bool> red_in = reduce_in_;
+    red_in.insert(red_in.end(), reduce_out_.begin(), reduce_out_.end());
+    Function dm = Map::create(name + "_map", parallelization(), df, n_, red_in, reduce_in_);
+
+    // Reorder the seeds to instance-major order
+    vector<MX> arg = mx_in(), res = mx_out();
+    vector<MX> aseed(n_out_), dm_arg = arg;
+    for (casadi_int i=0; i<n_out_; ++i) {
+      aseed[i] = MX::sym("adj_" + name_out_[i], repmat(sparsity_out(i), 1, nadj));
+      if (reduce_out_[i]) {
+        dm_arg.push_back(aseed[i]);
+      } else {
+        dm_arg.push_back(aseed[i](Slice(), map_perm(n_, nadj, f_.size2_out(i)))); // NOLINT
+      }
+    }
+    vector<MX> asens = dm(dm_arg);
+
+    // Reorder the sensitivities to direction-major order
+    for (casadi_int i=0; i<n_in_; ++i) {
+      if (reduce_in_[i]) continue;
+      vector<casadi_int> ind = lookupvector(map_perm(n_, nadj, f_.size2_in(i)));
+      asens[i] = asens[i](Slice(), ind); // NOLINT
+    }
+
+    // Construct return function
+    arg.insert(arg.end(), res.begin(), res.end());
+    arg.insert(arg.end(), aseed.begin(), aseed.end());
+    return Function(name, arg, asens, inames, onames, opts);
+  }
+
   int Map::eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
     // This checkout/release dance is an optimization.
     // Could also use the thread-safe variant f_(arg1, res1, iw, w)
     // in Map::eval_gen
     scoped_checkout<Function> m(f_);
+    // All instances in one call, if supported
+    if (f_->use_eval_batch() && !any_reduce()) {
+      return f_->eval_batch(n_, arg, res, iw, w, f_.memory(m));
+    }
     return eval_gen(arg, res, iw, w, m);
   }
 
+  // Cache line size in bytes
+  const size_t cache_line = 64;
+
+  // Elements of size el_size per instance, padded to separate cache lines
+  static size_t padded_stride(size_t sz, size_t el_size) {
+    size_t lines = (sz*el_size + cache_line - 1) / cache_line + 1;
+    return lines * cache_line / el_size;
+  }
+
+  void Map::parallel_work(const Function& f, size_t& sz_arg, size_t& sz_res,
+                          size_t& sz_iw, size_t& sz_w, size_t extra_w) {
+    f.sz_work(sz_arg, sz_res, sz_iw, sz_w);
+    sz_w += extra_w;
+    sz_arg = padded_stride(sz_arg, sizeof(const double*));
+    sz_res = padded_stride(sz_res, sizeof(double*));
+    sz_iw = padded_stride(sz_iw, sizeof(casadi_int));
+    sz_w = padded_stride(sz_w, sizeof(double));
+  }
+
   OmpMap::~OmpMap() {
   }
 
@@ -290,34 +645,26 @@ namespace casadi {
     return Map::eval(arg, res, iw, w, mem);
 #else // WITH_OPENMP
     size_t sz_arg, sz_res, sz_iw, sz_w;
-    f_.sz_work(sz_arg, sz_res, sz_iw, sz_w);
+    parallel_work(f_, sz_arg, sz_res, sz_iw, sz_w, 2*nnz_red_);
 
     // Error flag
     casadi_int flag = 0;
 
     // Checkout memory objects
-    std::vector< scoped_checkout<Function> > ind; ind.reserve(n_);
-    for (casadi_int i=0; i<n_; ++i) ind.emplace_back(f_);
+    std::vector< scoped_checkout<Function> > ind; ind.reserve(nw_);
+    for (casadi_int s=0; s<nw_; ++s) ind.emplace_back(f_);
 
-    // Evaluate in parallel
+    // Evaluate in parallel, each worker a contiguous range of instances
 #pragma omp parallel for reduction(||:flag)
-    for (casadi_int i=0; i<n_; ++i) {
-      // Input buffers
-      const double** arg1 = arg + n_in_ + i*sz_arg;
-      for (casadi_int j=0; j<n_in_; ++j) {
-        arg1[j] = arg[j] ? arg[j] + i*f_.nnz_in(j) : 0;
-      }
-
-      // Output buffers
-      double** res1 = res + n_out_ + i*sz_res;
-      for (casadi_int j=0; j<n_out_; ++j) {
-        res1[j] = res[j] ? res[j] + i*f_.nnz_out(j) : 0;
-      }
-
-      // Evaluation
-      flag = f_(arg1, res1, iw + i*sz_iw, w + i*sz_w, ind[i]) || flag;
+    for (casadi_int s=0; s<nw_; ++s) {
+      flag = eval_range(s*n_/nw_, (s+1)*n_/nw_, arg, res,
+                        arg + n_in_ + s*sz_arg, res + n_out_ + s*sz_res,
+                        iw + s*sz_iw, w + s*sz_w, ind[s]) || flag;
     }
 
+    // Sum the reduced outputs
+    if (!flag && nnz_red_>0) reduce_tree(res, w, sz_w);
+
     // Return error flag
     return flag;
 #endif  // WITH_OPENMP
@@ -325,27 +672,73 @@ namespace casadi {
 
   void OmpMap::codegen_body(CodeGenerator& g) const {
     size_t sz_arg, sz_res, sz_iw, sz_w;
-    f_.sz_work(sz_arg, sz_res, sz_iw, sz_w);
-    g << "casadi_int i;\n"
+    parallel_work(f_, sz_arg, sz_res, sz_iw, sz_w, 2*nnz_red_);
+    g << "casadi_int i, s;\n"
       << "const double** arg1;\n"
-      << "double** res1;\n"
-      << "casadi_int flag = 0;\n"
-      << "#pragma omp parallel for private(i,arg1,res1) reduction(||:flag)\n"
-      << "for (i=0; i<" << n_ << "; ++i) {\n"
-      << "arg1 = arg + " << n_in_ << "+i*" << sz_arg << ";\n";
+      << "double** res1;\n";
+    if (nnz_red_>0) {
+      g << "casadi_int d;\n"
+        << "casadi_real *sum, *tmp;\n";
+    }
+    g << "casadi_int flag = 0;\n"
+      << "#pragma omp parallel for private(i,arg1,res1" << (nnz_red_>0 ? ",sum,tmp" : "")
+      << ") reduction(||:flag)\n"
+      << "for (s=0; s<" << nw_ << "; ++s) {\n"
+      << "arg1 = arg + " << n_in_ << "+s*" << sz_arg << ";\n"
+      << "res1 = res + " <<  n_out_ << "+s*" <<  sz_res << ";\n";
+    // Partial sums of the reduced outputs
+    if (nnz_red_>0) {
+      g << "sum = w+s*" << sz_w << ";\n"
+        << "tmp = sum+" << nnz_red_ << ";\n"
+        << g.clear("sum", nnz_red_) << "\n";
+    }
+    g << "for (i=s*" << n_ << "/" << nw_ << "; i<(s+1)*" << n_ << "/" << nw_ << "; ++i) {\n";
     for (casadi_int j=0; j<n_in_; ++j) {
-      g << "arg1[" << j << "] = arg[" << j << "] ? "
-        << "arg[" << j << "]+i*" << f_.nnz_in(j) << ": 0;\n";
+      if (reduce_in_[j]) {
+        g << "arg1[" << j << "] = arg[" << j << "];\n";
+      } else {
+        g << "arg1[" << j << "] = arg[" << j << "] ? "
+          << "arg[" << j << "]+i*" << f_.nnz_in(j) << ": 0;\n";
+      }
     }
-    g << "res1 = res + " <<  n_out_ << "+i*" <<  sz_res << ";\n";
+    casadi_int off = 0;
     for (casadi_int j=0; j<n_out_; ++j) {
-      g << "res1[" << j << "] = res[" << j << "] ?"
-        << "res[" << j << "]+i*" << f_.nnz_out(j) << ": 0;\n";
+      if (reduce_out_[j]) {
+        g << "res1[" << j << "] = res[" << j << "] ? tmp+" << off << ": 0;\n";
+        off += f_.nnz_out(j);
+      } else {
+        g << "res1[" << j << "] = res[" << j << "] ?"
+          << "res[" << j << "]+i*" << f_.nnz_out(j) << ": 0;\n";
+      }
     }
+    std::string w1 = nnz_red_>0 ? "tmp+" + str(nnz_red_) : "w+s*" + str(sz_w);
     g << "flag = "
-      << g(f_, "arg1", "res1", "iw+i*" + str(sz_iw), "w+i*" + str(sz_w)) << " || flag;\n"
+      << g(f_, "arg1", "res1", "iw+s*" + str(sz_iw), w1) << " || flag;\n";
+    off = 0;
+    for (casadi_int j=0; j<n_out_; ++j) {
+      if (!reduce_out_[j]) continue;
+      g << "if (res1[" << j << "]) "
+        << g.axpy(f_.nnz_out(j), "1.", "res1[" + str(j) + "]", "sum+" + str(off)) << "\n";
+      off += f_.nnz_out(j);
+    }
+    g << "}\n"
       << "}\n"
       << "if (flag) return 1;\n";
+    // Pairwise sums in a fixed order, independent of the thread scheduling
+    if (nnz_red_>0) {
+      g << "for (d=1; d<" << nw_ << "; d*=2) {\n"
+        << "for (s=0; s+d<" << nw_ << "; s+=2*d) {\n"
+        << g.axpy(nnz_red_, "1.", "w+(s+d)*" + str(sz_w), "w+s*" + str(sz_w)) << "\n"
+        << "}\n"
+        << "}\n";
+      off = 0;
+      for (casadi_int j=0; j<n_out_; ++j) {
+        if (!reduce_out_[j]) continue;
+        g << "if (res[" << j << "]) "
+          << g.copy("w+" + str(off), f_.nnz_out(j), "res[" + str(j) + "]") << "\n";
+        off += f_.nnz_out(j);
+      }
+    }
   }
 
   void OmpMap::init(const Dict& opts) {
@@ -356,73 +749,63 @@ namespace casadi {
     // Call the initialization method of the base class
     Map::init(opts);
 
+    // With summed outputs, one worker per thread keeps a partial sum
+    if (nnz_red_>0) {
+#ifdef WITH_OPENMP
+      nw_ = min(n_, static_cast<casadi_int>(omp_get_max_threads()));
+#else // WITH_OPENMP
+      nw_ = 1;
+#endif // WITH_OPENMP
+    }
+
     // Allocate memory for holding memory object references
-    alloc_iw(n_, true);
+    alloc_iw(nw_, true);
 
     // Allocate sufficient memory for parallel evaluation
-    alloc_arg(f_.sz_arg() * n_);
-    alloc_res(f_.sz_res() * n_);
-    alloc_w(f_.sz_w() * n_);
-    alloc_iw(f_.sz_iw() * n_);
+    size_t sz_arg, sz_res, sz_iw, sz_w;
+    parallel_work(f_, sz_arg, sz_res, sz_iw, sz_w, 2*nnz_red_);
+    alloc_arg(sz_arg * nw_);
+    alloc_res(sz_res * nw_);
+    alloc_w(sz_w * nw_);
+    alloc_iw(sz_iw * nw_);
   }
 
 
   ThreadMap::~ThreadMap() {
   }
 
-  void ThreadsWork(const Function& f, casadi_int i,
-      const double** arg, double** res,
-      casadi_int* iw, double* w,
-      casadi_int ind, int& ret) {
-
-    // Function dimensions
-    casadi_int n_in = f.n_in();
-    casadi_int n_out = f.n_out();
-
-    // Function work sizes
-    size_t sz_arg, sz_res, sz_iw, sz_w;
-    f.sz_work(sz_arg, sz_res, sz_iw, sz_w);
-
-    // Input buffers
-    const double** arg1 = arg + n_in + i*sz_arg;
-    for (casadi_int j=0; j<n_in; ++j) {
-      arg1[j] = arg[j] ? arg[j] + i*f.nnz_in(j) : nullptr;
-    }
-
-    // Output buffers
-    double** res1 = res + n_out + i*sz_res;
-    for (casadi_int j=0; j<n_out; ++j) {
-      res1[j] = res[j] ? res[j] + i*f.nnz_out(j) : nullptr;
-    }
-
-    ret = f(arg1, res1, iw + i*sz_iw, w + i*sz_w, ind);
-  }
-
   int ThreadMap::eval(const double** arg, double** res, casadi_int* iw, double* w,
       void* mem) const {
+    // All instances in one call, if supported
+    if (f_->use_eval_batch() && !any_reduce()) return Map::eval(arg, res, iw, w, mem);
 
 #ifndef CASADI_WITH_THREAD
     return Map::eval(arg, res, iw, w, mem);
 #else // CASADI_WITH_THREAD
+    size_t sz_arg, sz_res, sz_iw, sz_w;
+    parallel_work(f_, sz_arg, sz_res, sz_iw, sz_w, 2*nnz_red_);
+
     // Checkout memory objects
-    std::vector< scoped_checkout<Function> > ind; ind.reserve(n_);
-    for (casadi_int i=0; i<n_; ++i) ind.emplace_back(f_);
+    std::vector< scoped_checkout<Function> > ind; ind.reserve(nw_);
+    for (casadi_int s=0; s<nw_; ++s) ind.emplace_back(f_);
 
     // Allocate space for return values
-    std::vector<int> ret_values(n_);
+    std::vector<int> ret_values(nw_);
 
-    // Spawn threads
+    // Spawn threads, each evaluating a contiguous range of instances
     std::vector<std::thread> threads;
-    for (casadi_int i=0; i<n_; ++i) {
+    for (casadi_int s=0; s<nw_; ++s) {
       // Why the lambda function?
       // Because it was the first iteration to pass tests on MingGW
       // using mingw-std-threads.
       threads.emplace_back(
-        [i](const Function& f, const double** arg, double** res,
+        [this, s, sz_arg, sz_res, sz_iw, sz_w](const double** arg, double** res,
             casadi_int* iw, double* w, casadi_int ind, int& ret) {
-              ThreadsWork(f, i, arg, res, iw, w, ind, ret);
+              ret = eval_range(s*n_/nw_, (s+1)*n_/nw_, arg, res,
+                               arg + n_in_ + s*sz_arg, res + n_out_ + s*sz_res,
+                               iw + s*sz_iw, w + s*sz_w, ind);
             },
-        std::ref(f_), arg, res, iw, w, casadi_int(ind[i]), std::ref(ret_values[i]));
+        arg, res, iw, w, casadi_int(ind[s]), std::ref(ret_values[s]));
     }
 
     // Join threads
@@ -434,6 +817,9 @@ namespace casadi {
     // Compute aggregate return value
     for (int e : ret_values) ret = ret || e;
 
+    // Sum the reduced outputs
+    if (!ret && nnz_red_>0) reduce_tree(res, w, sz_w);
+
     return ret;
 #endif // CASADI_WITH_THREAD
   }
@@ -450,14 +836,25 @@ namespace casadi {
     // Call the initialization method of the base class
     Map::init(opts);
 
+    // With summed outputs, one worker per thread keeps a partial sum
+    if (nnz_red_>0) {
+#ifdef CASADI_WITH_THREAD
+      nw_ = min(n_, max(casadi_int(1), static_cast<casadi_int>(thread::hardware_concurrency())));
+#else // CASADI_WITH_THREAD
+      nw_ = 1;
+#endif // CASADI_WITH_THREAD
+    }
+
     // Allocate memory for holding memory object references
-    alloc_iw(n_, true);
+    alloc_iw(nw_, true);
 
     // Allocate sufficient memory for parallel evaluation
-    alloc_arg(f_.sz_arg() * n_);
-    alloc_res(f_.sz_res() * n_);
-    alloc_w(f_.sz_w() * n_);
-    alloc_iw(f_.sz_iw() * n_);
+    size_t sz_arg, sz_res, sz_iw, sz_w;
+    parallel_work(f_, sz_arg, sz_res, sz_iw, sz_w, 2*nnz_red_);
+    alloc_arg(sz_arg * nw_);
+    alloc_res(sz_res * nw_);
+    alloc_w(sz_w * nw_);
+    alloc_iw(sz_iw * nw_);
   }
 
 } // namespace casadi
@@ -42,6 +42,12 @@ namespace casadi {
     static Function create(const std::string& parallelization,
                            const Function& f, casadi_int n);
 
+    // Create function with inputs shared by all instances and outputs summed
+    static Function create(const std::string& name, const std::string& parallelization,
+                           const Function& f, casadi_int n,
+                           const std::vector<bool>& reduce_in,
+                           const std::vector<bool>& reduce_out, const Dict& opts=Dict());
+
     /** \brief Destructor */
     ~Map() override;
 
@@ -51,10 +57,10 @@ namespace casadi {
     /// @{
     /** \brief Sparsities of function inputs and outputs */
     Sparsity get_sparsity_in(casadi_int i) override {
-      return repmat(f_.sparsity_in(i), 1, n_);
+      return reduce_in_[i] ? f_.sparsity_in(i) : repmat(f_.sparsity_in(i), 1, n_);
     }
     Sparsity get_sparsity_out(casadi_int i) override {
-      return repmat(f_.sparsity_out(i), 1, n_);
+      return reduce_out_[i] ? f_.sparsity_out(i) : repmat(f_.sparsity_out(i), 1, n_);
     }
     /// @}
 
@@ -77,6 +83,14 @@ namespace casadi {
     template<typename T>
     int eval_gen(const T** arg, T** res, casadi_int* iw, T* w, casadi_int mem=0) const;
 
+    /** \brief Evaluate instances k0 to k1-1, summing the reduced outputs in w */
+    template<typename T>
+    int eval_range(casadi_int k0, casadi_int k1, const T** arg, T** res,
+                   const T** arg1, T** res1, casadi_int* iw, T* w, casadi_int mem) const;
+
+    /** \brief Combine the partial sums of nw_ workers with stride sz_w */
+    void reduce_tree(double** res, double* w, size_t sz_w) const;
+
     /// Evaluate the function numerically
     int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
 
@@ -100,6 +114,12 @@ namespace casadi {
     bool has_sprev() const override { return true;}
     ///@}
 
+    /// Generate the sparsity of a Jacobian block from that of f_
+    Sparsity getJacSparsity(casadi_int iind, casadi_int oind, bool symmetric) const override;
+
+    /** \brief Get Jacobian sparsity */
+    Sparsity get_jacobian_sparsity() const override;
+
     /** \brief Is codegen supported? */
     bool has_codegen() const override { return true;}
 
@@ -133,6 +153,9 @@ namespace casadi {
     /** Obtain information about node */
     Dict info() const override { return {{"f", f_}, {"n", n_}}; }
 
+    /** \brief Same map over an expanded body */
+    Function expand_loops(const std::string& name, const Dict& opts) const override;
+
     /** \brief Serialize an object without type information */
     void serialize_body(SerializingStream &s) const override;
     /** \brief Serialize type information */
@@ -144,18 +167,49 @@ namespace casadi {
     /** \brief Deserialize with type disambiguation */
     static ProtoFunction* deserialize(DeserializingStream& s);
 
+    /** \brief Per-instance work strides for parallel evaluation
+
+        Each stride is padded to whole cache lines, plus one line of separation,
+        so that the work vectors of two threads never share a cache line. */
+    static void parallel_work(const Function& f, size_t& sz_arg, size_t& sz_res,
+                              size_t& sz_iw, size_t& sz_w, size_t extra_w=0);
+
   protected:
     /** \brief Deserializing constructor */
     explicit Map(DeserializingStream& s);
 
     // Constructor (protected, use create function)
-    Map(const std::string& name, const Function& f, casadi_int n);
+    Map(const std::string& name, const Function& f, casadi_int n,
+        const std::vector<bool>& reduce_in=std::vector<bool>(),
+        const std::vector<bool>& reduce_out=std::vector<bool>());
+
+    /// Are any inputs or outputs reduced?
+    bool any_reduce() const;
+
+    /// Generate a function that calculates derivatives of a map with reductions
+    Function get_forward_reduce(casadi_int nfwd, const std::string& name,
+                                const std::vector<std::string>& inames,
+                                const std::vector<std::string>& onames,
+                                const Dict& opts) const;
+    Function get_reverse_reduce(casadi_int nadj, const std::string& name,
+                                const std::vector<std::string>& inames,
+                                const std::vector<std::string>& onames,
+                                const Dict& opts) const;
 
     // The function which is to be evaluated in parallel
     Function f_;
 
     // Number of times to evaluate this function
     casadi_int n_;
+
+    // Inputs shared by all instances, outputs summed over all instances
+    std::vector<bool> reduce_in_, reduce_out_;
+
+    // Nonzeros of the reduced outputs
+    casadi_int nnz_red_;
+
+    // Number of workers, each evaluating a contiguous range of instances
+    casadi_int nw_;
   };
 
   /** A map Evaluate in parallel using OpenMP
@@ -169,7 +223,10 @@ namespace casadi {
     friend class Map;
   public:
     // Constructor (protected, use create function in Map)
-    OmpMap(const std::string& name, const Function& f, casadi_int n) : Map(name, f, n) {}
+    OmpMap(const std::string& name, const Function& f, casadi_int n,
+           const std::vector<bool>& reduce_in=std::vector<bool>(),
+           const std::vector<bool>& reduce_out=std::vector<bool>())
+      : Map(name, f, n, reduce_in, reduce_out) {}
 
     /** \brief  Destructor */
     ~OmpMap() override;
@@ -205,7 +262,10 @@ namespace casadi {
     friend class Map;
   public:
     // Constructor (protected, use create function in Map)
-    ThreadMap(const std::string& name, const Function& f, casadi_int n) : Map(name, f, n) {}
+    ThreadMap(const std::string& name, const Function& f, casadi_int n,
+              const std::vector<bool>& reduce_in=std::vector<bool>(),
+              const std::vector<bool>& reduce_out=std::vector<bool>())
+      : Map(name, f, n, reduce_in, reduce_out) {}
 
     /** \brief  Destructor */
     ~ThreadMap() override;
@@ -0,0 +1,791 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "mapaccum.hpp"
+#include "serializing_stream.hpp"
+
+#include <cmath>
+
+using namespace std;
+
+namespace casadi {
+
+  MapAccum::MapAccum(const std::string& name, const Function& f, casadi_int n,
+                     casadi_int n_accum, casadi_int checkpoints)
+    : FunctionInternal(name), f_(f), n_(n), n_accum_(n_accum), checkpoints_(checkpoints) {
+  }
+
+  void MapAccum::serialize_body(SerializingStream &s) const {
+    FunctionInternal::serialize_body(s);
+    s.version("MapAccum", 1);
+    s.pack("MapAccum::f", f_);
+    s.pack("MapAccum::n", n_);
+    s.pack("MapAccum::n_accum", n_accum_);
+    s.pack("MapAccum::checkpoints", checkpoints_);
+    s.pack("MapAccum::off", off_);
+  }
+
+  void MapAccum::serialize_type(SerializingStream &s) const {
+    FunctionInternal::serialize_type(s);
+    s.pack("MapAccum::class_name", class_name());
+  }
+
+  MapAccum::MapAccum(DeserializingStream& s) : FunctionInternal(s) {
+    s.version("MapAccum", 1);
+    s.unpack("MapAccum::f", f_);
+    s.unpack("MapAccum::n", n_);
+    s.unpack("MapAccum::n_accum", n_accum_);
+    s.unpack("MapAccum::checkpoints", checkpoints_);
+    s.unpack("MapAccum::off", off_);
+  }
+
+  ProtoFunction* MapAccum::deserialize(DeserializingStream& s) {
+    std::string class_name;
+    s.unpack("MapAccum::class_name", class_name);
+    if (class_name=="MapAccum") {
+      return new MapAccum(s);
+    } else {
+      casadi_error("class name '" + class_name + "' unknown.");
+    }
+  }
+
+  MapAccum::~MapAccum() {
+  }
+
+  void MapAccum::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    FunctionInternal::init(opts);
+
+    // Consistency checks
+    casadi_assert(n_>0, "MapAccum: n must be positive");
+    casadi_assert(n_accum_<=min(n_in_, n_out_), "MapAccum: too many accumulators");
+    for (casadi_int i=0; i<n_accum_; ++i) {
+      casadi_assert(f_.sparsity_out(i).is_equal(f_.sparsity_in(i)),
+        "MapAccum: Sparsity of accumulated output " + str(i) + " must match the input");
+    }
+
+    // Offsets of the accumulators in the state buffers
+    off_.resize(n_accum_+1);
+    off_[0] = 0;
+    for (casadi_int i=0; i<n_accum_; ++i) off_[i+1] = off_[i] + f_.nnz_in(i);
+
+    // Allocate memory for the step function and two state buffers
+    alloc_arg(f_.sz_arg());
+    alloc_res(f_.sz_res());
+    alloc_w(f_.sz_w() + 2*off_.back());
+    alloc_iw(f_.sz_iw());
+  }
+
+  template<typename T>
+  int MapAccum::eval_gen(const T** arg, T** res, casadi_int* iw, T* w, casadi_int mem) const {
+    // Current and next state
+    T* x = w; w += off_.back();
+    T* x_next = w; w += off_.back();
+    for (casadi_int i=0; i<n_accum_; ++i) {
+      if (arg[i]) {
+        copy_n(arg[i], f_.nnz_in(i), x + off_[i]);
+      } else {
+        fill_n(x + off_[i], f_.nnz_in(i), T(0));
+      }
+    }
+    const T** arg1 = arg+n_in_;
+    T** res1 = res+n_out_;
+    for (casadi_int k=0; k<n_; ++k) {
+      for (casadi_int i=0; i<n_in_; ++i) {
+        if (i<n_accum_) {
+          arg1[i] = x + off_[i];
+        } else {
+          arg1[i] = arg[i] ? arg[i] + k*f_.nnz_in(i) : nullptr;
+        }
+      }
+      for (casadi_int i=0; i<n_out_; ++i) {
+        if (i<n_accum_) {
+          res1[i] = x_next + off_[i];
+        } else {
+          res1[i] = res[i] ? res[i] + k*f_.nnz_out(i) : nullptr;
+        }
+      }
+      if (f_(arg1, res1, iw, w, mem)) return 1;
+      for (casadi_int i=0; i<n_accum_; ++i) {
+        if (res[i]) copy_n(x_next + off_[i], f_.nnz_out(i), res[i] + k*f_.nnz_out(i));
+      }
+      swap(x, x_next);
+    }
+    return 0;
+  }
+
+  int MapAccum::eval(const double** arg, double** res, casadi_int* iw, double* w,
+                     void* mem) const {
+    scoped_checkout<Function> m(f_);
+    return eval_gen(arg, res, iw, w, m);
+  }
+
+  int MapAccum::eval_sx(const SXElem** arg, SXElem** res, casadi_int* iw, SXElem* w,
+                        void* mem) const {
+    return eval_gen(arg, res, iw, w);
+  }
+
+  int MapAccum::sp_forward(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem) const {
+    return eval_gen(arg, res, iw, w);
+  }
+
+  int MapAccum::sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w,
+                           void* mem) const {
+    // Seeds of the current and the previous state
+    bvec_t* lam = w; w += off_.back();
+    bvec_t* lam_prev = w; w += off_.back();
+    fill_n(lam, off_.back(), 0);
+    bvec_t** arg1 = arg+n_in_;
+    bvec_t** res1 = res+n_out_;
+    for (casadi_int k=n_-1; k>=0; --k) {
+      for (casadi_int i=0; i<n_out_; ++i) {
+        if (i<n_accum_) {
+          // The state x_{k+1} is both an output and the input of the next step
+          casadi_int nnz = f_.nnz_out(i);
+          if (res[i]) {
+            bvec_t* r = res[i] + k*nnz;
+            for (casadi_int j=0; j<nnz; ++j) lam[off_[i]+j] |= r[j];
+            fill_n(r, nnz, 0);
+          }
+          res1[i] = lam + off_[i];
+        } else {
+          res1[i] = res[i] ? res[i] + k*f_.nnz_out(i) : nullptr;
+        }
+      }
+      fill_n(lam_prev, off_.back(), 0);
+      for (casadi_int i=0; i<n_in_; ++i) {
+        if (i<n_accum_) {
+          arg1[i] = lam_prev + off_[i];
+        } else {
+          arg1[i] = arg[i] ? arg[i] + k*f_.nnz_in(i) : nullptr;
+        }
+      }
+      if (f_.rev(arg1, res1, iw, w)) return 1;
+      swap(lam, lam_prev);
+    }
+    for (casadi_int i=0; i<n_accum_; ++i) {
+      if (arg[i]) {
+        for (casadi_int j=0; j<f_.nnz_in(i); ++j) arg[i][j] |= lam[off_[i]+j];
+      }
+    }
+    return 0;
+  }
+
+  void MapAccum::codegen_declarations(CodeGenerator& g) const {
+    g.add_dependency(f_);
+  }
+
+  void MapAccum::codegen_body(CodeGenerator& g) const {
+    g << "casadi_int k;\n";
+    g << "const casadi_real** arg1;\n";
+    g << "casadi_real** res1;\n";
+    g << "casadi_real *x, *x_next, *x_tmp;\n";
+    g << "arg1 = arg+" << n_in_ << ";\n";
+    g << "res1 = res+" << n_out_ << ";\n";
+    // State buffers
+    g << "x = w; w += " << off_.back() << ";\n";
+    g << "x_next = w; w += " << off_.back() << ";\n";
+    for (casadi_int i=0; i<n_accum_; ++i) {
+      std::string xi = "x+" + str(off_[i]);
+      g << "if (arg[" << i << "]) {\n"
+        << g.copy("arg[" + str(i) + "]", f_.nnz_in(i), xi) << "\n"
+        << "} else {\n"
+        << g.clear(xi, f_.nnz_in(i)) << "\n"
+        << "}\n";
+    }
+    g << "for (k=0; k<" << n_ << "; ++k) {\n";
+    // Inputs and outputs of step k
+    for (casadi_int i=0; i<n_in_; ++i) {
+      if (i<n_accum_) {
+        g << "arg1[" << i << "] = x+" << off_[i] << ";\n";
+      } else {
+        g << "arg1[" << i << "] = arg[" << i << "] ? arg[" << i << "]+k*"
+          << f_.nnz_in(i) << " : 0;\n";
+      }
+    }
+    for (casadi_int i=0; i<n_out_; ++i) {
+      if (i<n_accum_) {
+        g << "res1[" << i << "] = x_next+" << off_[i] << ";\n";
+      } else {
+        g << "res1[" << i << "] = res[" << i << "] ? res[" << i << "]+k*"
+          << f_.nnz_out(i) << " : 0;\n";
+      }
+    }
+    // Evaluate
+    g << "if (" << g(f_, "arg1", "res1", "iw", "w") << ") return 1;\n";
+    // Save the state and advance
+    for (casadi_int i=0; i<n_accum_; ++i) {
+      g << "if (res[" << i << "]) "
+        << g.copy("x_next+" + str(off_[i]), f_.nnz_out(i),
+                  "res[" + str(i) + "]+k*" + str(f_.nnz_out(i))) << "\n";
+    }
+    g << "x_tmp = x; x = x_next; x_next = x_tmp;\n";
+    g << "}\n";
+  }
+
+  Function MapAccum::expand_loops(const std::string& name, const Dict& opts) const {
+    // Expand the body, keeping loops nested inside it
+    Function f = f_.is_a("SXFunction") ? f_ : f_.expand(f_.name(), {{"keep_loops", true}});
+    return Function::create(new MapAccum(name, f, n_, n_accum_, checkpoints_), opts);
+  }
+
+  Function MapAccum
+  ::get_forward(casadi_int nfwd, const std::string& name,
+                const std::vector<std::string>& inames,
+                const std::vector<std::string>& onames,
+                const Dict& opts) const {
+    // Forward mode of one step, with the seeds of the accumulators first
+    Function df = f_.forward(1);
+    vector<casadi_int> order_in;
+    for (casadi_int i=0; i<n_accum_; ++i) order_in.push_back(n_in_+n_out_+i);
+    for (casadi_int i=0; i<n_in_+n_out_; ++i) order_in.push_back(i);
+    for (casadi_int i=n_accum_; i<n_in_; ++i) order_in.push_back(n_in_+n_out_+i);
+    df = df.slice(df.name() + "_acc", order_in, range(n_out_));
+
+    // The forward sensitivities satisfy a recurrence of their own
+    Function dm = Function::create(
+      new MapAccum(name_ + "_fwd", df, n_, n_accum_, checkpoints_), Dict());
+
+    // Nondifferentiated inputs and outputs
+    vector<MX> arg = mx_in(), res = mx_out();
+
+    // Arguments of dm, except for the seeds
+    vector<MX> v(n_accum_);
+    for (casadi_int i=0; i<n_in_; ++i) {
+      if (i<n_accum_) {
+        // States at the beginning of each step
+        casadi_int sz = f_.size2_in(i);
+        v.push_back(horzcat(arg[i], res[i](Slice(), Slice(0, (n_-1)*sz)))); // NOLINT
+      } else {
+        v.push_back(arg[i]);
+      }
+    }
+    v.insert(v.end(), res.begin(), res.end());
+    v.resize(n_in_+n_out_+n_in_);
+
+    // Forward seeds, one direction at a time
+    vector<MX> fseed(n_in_);
+    vector<vector<MX>> fseed_split(n_in_);
+    for (casadi_int i=0; i<n_in_; ++i) {
+      fseed[i] = MX::sym("fwd_" + name_in_[i], repmat(sparsity_in(i), 1, nfwd));
+      fseed_split[i] = horzsplit(fseed[i], size2_in(i));
+    }
+    vector<vector<MX>> fsens(n_out_);
+    for (casadi_int d=0; d<nfwd; ++d) {
+      for (casadi_int i=0; i<n_accum_; ++i) v[i] = fseed_split[i][d];
+      for (casadi_int i=n_accum_; i<n_in_; ++i) {
+        v[n_in_+n_out_+i] = fseed_split[i][d];
+      }
+      vector<MX> r = dm(v);
+      for (casadi_int i=0; i<n_out_; ++i) fsens[i].push_back(r[i]);
+    }
+
+    // Construct return function
+    vector<MX> ret_in = arg;
+    ret_in.insert(ret_in.end(), res.begin(), res.end());
+    ret_in.insert(ret_in.end(), fseed.begin(), fseed.end());
+    vector<MX> ret_out(n_out_);
+    for (casadi_int i=0; i<n_out_; ++i) ret_out[i] = horzcat(fsens[i]);
+    return Function(name, ret_in, ret_out, inames, onames, opts);
+  }
+
+  Function MapAccum
+  ::get_reverse(casadi_int nadj, const std::string& name,
+                const std::vector<std::string>& inames,
+                const std::vector<std::string>& onames,
+                const Dict& opts) const {
+    // Backward sweep, recomputing states as needed
+    Function dm = Function::create(
+      new MapAccumRev(name_ + "_rev", f_, n_, n_accum_, checkpoints_), Dict());
+
+    // Nondifferentiated inputs and outputs. With checkpoints, the reverse sweep
+    // does not take the state trajectory, so that it need not be kept
+    vector<MX> arg = mx_in(), res = mx_out();
+    vector<MX> v = arg;
+    if (checkpoints_==0) v.insert(v.end(), res.begin(), res.end());
+    size_t nv = v.size();
+
+    // Adjoint seeds, one direction at a time
+    vector<MX> aseed(n_out_);
+    vector<vector<MX>> aseed_split(n_out_);
+    for (casadi_int i=0; i<n_out_; ++i) {
+      aseed[i] = MX::sym("adj_" + name_out_[i], repmat(sparsity_out(i), 1, nadj));
+      aseed_split[i] = horzsplit(aseed[i], size2_out(i));
+    }
+    vector<vector<MX>> asens(n_in_);
+    for (casadi_int d=0; d<nadj; ++d) {
+      v.resize(nv);
+      for (casadi_int i=0; i<n_out_; ++i) v.push_back(aseed_split[i][d]);
+      vector<MX> r = dm(v);
+      for (casadi_int i=0; i<n_in_; ++i) asens[i].push_back(r[i]);
+    }
+
+    // Construct return function
+    vector<MX> ret_in = arg;
+    ret_in.insert(ret_in.end(), res.begin(), res.end());
+    ret_in.insert(ret_in.end(), aseed.begin(), aseed.end());
+    vector<MX> ret_out(n_in_);
+    for (casadi_int i=0; i<n_in_; ++i) ret_out[i] = horzcat(asens[i]);
+    return Function(name, ret_in, ret_out, inames, onames, opts);
+  }
+
+  MapAccumRev::MapAccumRev(const std::string& name, const Function& f, casadi_int n,
+                           casadi_int n_accum, casadi_int checkpoints)
+    : FunctionInternal(name), f_(f), n_(n), n_accum_(n_accum), checkpoints_(checkpoints) {
+  }
+
+  MapAccumRev::~MapAccumRev() {
+  }
+
+  void MapAccumRev::serialize_body(SerializingStream &s) const {
+    FunctionInternal::serialize_body(s);
+    s.version("MapAccumRev", 1);
+    s.pack("MapAccumRev::f", f_);
+    s.pack("MapAccumRev::f_rev", f_rev_);
+    s.pack("MapAccumRev::n", n_);
+    s.pack("MapAccumRev::n_accum", n_accum_);
+    s.pack("MapAccumRev::checkpoints", checkpoints_);
+    s.pack("MapAccumRev::ns", ns_);
+    s.pack("MapAccumRev::off", off_);
+    s.pack("MapAccumRev::sched", sched_);
+  }
+
+  void MapAccumRev::serialize_type(SerializingStream &s) const {
+    FunctionInternal::serialize_type(s);
+    s.pack("MapAccumRev::class_name", class_name());
+  }
+
+  MapAccumRev::MapAccumRev(DeserializingStream& s) : FunctionInternal(s) {
+    s.version("MapAccumRev", 1);
+    s.unpack("MapAccumRev::f", f_);
+    s.unpack("MapAccumRev::f_rev", f_rev_);
+    s.unpack("MapAccumRev::n", n_);
+    s.unpack("MapAccumRev::n_accum", n_accum_);
+    s.unpack("MapAccumRev::checkpoints", checkpoints_);
+    s.unpack("MapAccumRev::ns", ns_);
+    s.unpack("MapAccumRev::off", off_);
+    s.unpack("MapAccumRev::sched", sched_);
+  }
+
+  ProtoFunction* MapAccumRev::deserialize(DeserializingStream& s) {
+    std::string class_name;
+    s.unpack("MapAccumRev::class_name", class_name);
+    if (class_name=="MapAccumRev") {
+      return new MapAccumRev(s);
+    } else {
+      casadi_error("class name '" + class_name + "' unknown.");
+    }
+  }
+
+  Sparsity MapAccumRev::get_sparsity_in(casadi_int i) {
+    casadi_int n_in = f_.n_in(), n_out = f_.n_out();
+    if (i<n_accum_) {
+      return f_.sparsity_in(i);
+    } else if (i<n_in) {
+      return repmat(f_.sparsity_in(i), 1, n_);
+    } else {
+      // Nondifferentiated outputs if no checkpoints, then adjoint seeds
+      return repmat(f_.sparsity_out((i-n_in) % n_out), 1, n_);
+    }
+  }
+
+  void MapAccumRev::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    FunctionInternal::init(opts);
+
+    // Reverse mode of one step
+    f_rev_ = f_.reverse(1);
+
+    // Offsets of the accumulators in the state buffers
+    off_.resize(n_accum_+1);
+    off_[0] = 0;
+    for (casadi_int i=0; i<n_accum_; ++i) off_[i+1] = off_[i] + f_.nnz_in(i);
+
+    // Number of snapshots, sqrt(n) unless given
+    ns_ = checkpoints_;
+    if (ns_<=0) ns_ = static_cast<casadi_int>(ceil(sqrt(static_cast<double>(n_))));
+    ns_ = min(ns_, n_-1);
+    schedule();
+
+    // Nonzeros of the outputs that are not accumulated
+    casadi_int ny = 0;
+    for (casadi_int i=n_accum_; i<f_.n_out(); ++i) ny += f_.nnz_out(i);
+
+    // Allocate memory
+    alloc(f_);
+    alloc(f_rev_);
+    alloc_w(max(f_.sz_w(), f_rev_.sz_w()) + (4 + ns_)*off_.back() + ny);
+  }
+
+  // Number of steps that can be reversed with s snapshots and t sweeps, (s+t)!/(s!t!)
+  static double revolve_eta(casadi_int s, casadi_int t) {
+    double r = 1;
+    for (casadi_int i=1; i<=s; ++i) r = r*(t+i)/i;
+    return r;
+  }
+
+  void MapAccumRev::schedule() {
+    sched_.clear();
+    // Pending ranges of steps: first step, end, snapshot of the first state
+    // (-1 for the initial state), number of free snapshots
+    vector<casadi_int> stack = {0, n_, -1, ns_};
+    while (!stack.empty()) {
+      casadi_int s = stack.back(); stack.pop_back();
+      casadi_int slot = stack.back(); stack.pop_back();
+      casadi_int k1 = stack.back(); stack.pop_back();
+      casadi_int k0 = stack.back(); stack.pop_back();
+      casadi_int l = k1 - k0;
+      if (l==1) {
+        sched_.insert(sched_.end(), {RESTORE, k0, slot, ADJOINT, k0, -1});
+      } else if (s==0) {
+        // No snapshots left, recompute from the first state for each step
+        for (casadi_int k=k1-1; k>=k0; --k) {
+          sched_.insert(sched_.end(), {RESTORE, k0, slot, ADVANCE, k, -1, ADJOINT, k, -1});
+        }
+      } else {
+        // Smallest number of sweeps for the range, split so that both parts
+        // can be reversed with that number of sweeps
+        casadi_int t = 1;
+        while (revolve_eta(s, t) < l) t++;
+        casadi_int m = k0 + max(casadi_int(1), l - static_cast<casadi_int>(revolve_eta(s-1, t)));
+        casadi_int slot_m = ns_ - s;
+        sched_.insert(sched_.end(), {RESTORE, k0, slot, ADVANCE, m, -1, TAKESHOT, m, slot_m});
+        // Reverse [m, k1) first, then [k0, m)
+        stack.insert(stack.end(), {k0, m, slot, s});
+        stack.insert(stack.end(), {m, k1, slot_m, s-1});
+      }
+    }
+  }
+
+  int MapAccumRev::eval(const double** arg, double** res, casadi_int* iw, double* w,
+                        void* mem) const {
+    casadi_int n_in = f_.n_in(), n_out = f_.n_out(), nacc = off_.back();
+    // Nondifferentiated outputs, only without checkpoints, and adjoint seeds
+    const double** nom = checkpoints_==0 ? arg + n_in : nullptr;
+    const double** seed = arg + n_in + (nom ? n_out : 0);
+    const double** arg1 = arg + n_in_;
+    double** res1 = res + n_out_;
+    // Work vectors
+    double* x = w; w += nacc;
+    double* x_next = w; w += nacc;
+    double* lam = w; w += nacc;
+    double* lam_prev = w; w += nacc;
+    double* snap = w; w += ns_*nacc;
+    double* y = w;
+    for (casadi_int i=n_accum_; i<n_out; ++i) w += f_.nnz_out(i);
+    // Memory objects
+    scoped_checkout<Function> m(f_), m_rev(f_rev_);
+    // Use the state trajectory if available
+    bool traj = nom!=nullptr;
+    for (casadi_int i=0; traj && i<n_out; ++i) if (!nom[i]) traj = false;
+    // Step k of the recurrence, nominal outputs in x_next and y
+    auto step = [&](casadi_int k) -> int {
+      for (casadi_int i=0; i<n_in; ++i) {
+        if (i<n_accum_) {
+          arg1[i] = x + off_[i];
+        } else {
+          arg1[i] = arg[i] ? arg[i] + k*f_.nnz_in(i) : nullptr;
+        }
+      }
+      double* yi = y;
+      for (casadi_int i=0; i<n_out; ++i) {
+        if (i<n_accum_) {
+          res1[i] = x_next + off_[i];
+        } else {
+          res1[i] = yi;
+          yi += f_.nnz_out(i);
+        }
+      }
+      return f_(arg1, res1, iw, w, m);
+    };
+    // Adjoint of step k, state in x
+    auto adjoint = [&](casadi_int k) -> int {
+      if (traj) {
+        for (casadi_int i=0; i<n_in; ++i) {
+          if (i<n_accum_) {
+            arg1[i] = x + off_[i];
+          } else {
+            arg1[i] = arg[i] ? arg[i] + k*f_.nnz_in(i) : nullptr;
+          }
+        }
+        for (casadi_int i=0; i<n_out; ++i) arg1[n_in+i] = nom[i] + k*f_.nnz_out(i);
+      } else {
+        if (step(k)) return 1;
+        for (casadi_int i=0; i<n_out; ++i) arg1[n_in+i] = res1[i];
+      }
+      // The seed of x_{k+1} is the sum of the output seed and the propagated one
+      for (casadi_int i=0; i<n_out; ++i) {
+        casadi_int nnz = f_.nnz_out(i);
+        if (i<n_accum_) {
+          if (seed[i]) {
+            const double* s = seed[i] + k*nnz;
+            for (casadi_int j=0; j<nnz; ++j) lam[off_[i]+j] += s[j];
+          }
+          arg1[n_in+n_out+i] = lam + off_[i];
+        } else {
+          arg1[n_in+n_out+i] = seed[i] ? seed[i] + k*nnz : nullptr;
+        }
+      }
+      for (casadi_int i=0; i<n_in; ++i) {
+        if (i<n_accum_) {
+          res1[i] = lam_prev + off_[i];
+        } else {
+          res1[i] = res[i] ? res[i] + k*f_.nnz_in(i) : nullptr;
+        }
+      }
+      if (f_rev_(arg1, res1, iw, w, m_rev)) return 1;
+      swap(lam, lam_prev);
+      return 0;
+    };
+    // Initial state
+    auto restore_x0 = [&]() {
+      for (casadi_int i=0; i<n_accum_; ++i) {
+        if (arg[i]) {
+          copy_n(arg[i], f_.nnz_in(i), x + off_[i]);
+        } else {
+          fill_n(x + off_[i], f_.nnz_in(i), 0);
+        }
+      }
+    };
+    fill_n(lam, nacc, 0);
+    if (traj) {
+      // Backward sweep over the state trajectory
+      for (casadi_int k=n_-1; k>=0; --k) {
+        if (k==0) {
+          restore_x0();
+        } else {
+          for (casadi_int i=0; i<n_accum_; ++i) {
+            copy_n(nom[i] + (k-1)*f_.nnz_out(i), f_.nnz_out(i), x + off_[i]);
+          }
+        }
+        if (adjoint(k)) return 1;
+      }
+    } else {
+      // Checkpointing schedule
+      casadi_int kc = 0;
+      for (casadi_int a=0; a<sched_.size(); a+=3) {
+        casadi_int k = sched_[a+1], slot = sched_[a+2];
+        switch (sched_[a]) {
+          case RESTORE:
+            if (slot<0) {
+              restore_x0();
+            } else {
+              copy_n(snap + slot*nacc, nacc, x);
+            }
+            kc = k;
+            break;
+          case ADVANCE:
+            for (; kc<k; ++kc) {
+              if (step(kc)) return 1;
+              copy_n(x_next, nacc, x);
+            }
+            break;
+          case TAKESHOT:
+            copy_n(x, nacc, snap + slot*nacc);
+            break;
+          case ADJOINT:
+            if (adjoint(k)) return 1;
+            break;
+        }
+      }
+    }
+    // Adjoint sensitivities of the initial states
+    for (casadi_int i=0; i<n_accum_; ++i) {
+      if (res[i]) copy_n(lam + off_[i], f_.nnz_in(i), res[i]);
+    }
+    return 0;
+  }
+
+  void MapAccumRev::codegen_declarations(CodeGenerator& g) const {
+    g.add_dependency(f_);
+    g.add_dependency(f_rev_);
+  }
+
+  void MapAccumRev::codegen_adjoint(CodeGenerator& g, bool traj) const {
+    casadi_int n_in = f_.n_in(), n_out = f_.n_out();
+    if (traj) {
+      for (casadi_int i=0; i<n_in; ++i) {
+        if (i<n_accum_) {
+          g << "arg1[" << i << "] = x+" << off_[i] << ";\n";
+        } else {
+          g << "arg1[" << i << "] = arg[" << i << "] ? arg[" << i << "]+k*"
+            << f_.nnz_in(i) << " : 0;\n";
+        }
+      }
+      for (casadi_int i=0; i<n_out; ++i) {
+        g << "arg1[" << n_in+i << "] = arg[" << n_in+i << "]+k*" << f_.nnz_out(i) << ";\n";
+      }
+    } else {
+      g << "if (" << g(f_, "arg1", "res1", "iw", "w") << ") return 1;\n";
+      for (casadi_int i=0; i<n_out; ++i) {
+        g << "arg1[" << n_in+i << "] = res1[" << i << "];\n";
+      }
+    }
+    // Seeds
+    for (casadi_int i=0; i<n_out; ++i) {
+      std::string s = "arg[" + str(n_in+(checkpoints_==0 ? n_out : 0)+i) + "]";
+      casadi_int nnz = f_.nnz_out(i);
+      if (i<n_accum_) {
+        g << "if (" << s << ") "
+          << g.axpy(nnz, "1.", s + "+k*" + str(nnz), "lam+" + str(off_[i])) << "\n";
+        g << "arg1[" << n_in+n_out+i << "] = lam+" << off_[i] << ";\n";
+      } else {
+        g << "arg1[" << n_in+n_out+i << "] = " << s << " ? " << s << "+k*" << nnz << " : 0;\n";
+      }
+    }
+    // Sensitivities
+    for (casadi_int i=0; i<n_in; ++i) {
+      if (i<n_accum_) {
+        g << "res1[" << i << "] = lam_prev+" << off_[i] << ";\n";
+      } else {
+        g << "res1[" << i << "] = res[" << i << "] ? res[" << i << "]+k*"
+          << f_.nnz_in(i) << " : 0;\n";
+      }
+    }
+    g << "if (" << g(f_rev_, "arg1", "res1", "iw", "w") << ") return 1;\n";
+    g << "x_tmp = lam; lam = lam_prev; lam_prev = x_tmp;\n";
+  }
+
+  void MapAccumRev::codegen_body(CodeGenerator& g) const {
+    casadi_int n_in = f_.n_in(), n_out = f_.n_out(), nacc = off_.back();
+    g << "casadi_int a, k, kc, slot;\n";
+    g << "const casadi_real** arg1;\n";
+    g << "casadi_real** res1;\n";
+    g << "casadi_real *x, *x_next, *lam, *lam_prev, *snap, *y, *x_tmp;\n";
+    g << "arg1 = arg+" << n_in_ << ";\n";
+    g << "res1 = res+" << n_out_ << ";\n";
+    // Work vectors
+    g << "x = w; w += " << nacc << ";\n";
+    g << "x_next = w; w += " << nacc << ";\n";
+    g << "lam = w; w += " << nacc << ";\n";
+    g << "lam_prev = w; w += " << nacc << ";\n";
+    g << "snap = w; w += " << ns_*nacc << ";\n";
+    casadi_int ny = 0;
+    for (casadi_int i=n_accum_; i<n_out; ++i) ny += f_.nnz_out(i);
+    g << "y = w; w += " << ny << ";\n";
+    g << g.clear("lam", nacc) << "\n";
+    // Initial state
+    std::string restore_x0;
+    for (casadi_int i=0; i<n_accum_; ++i) {
+      std::string xi = "x+" + str(off_[i]);
+      restore_x0 += "if (arg[" + str(i) + "]) {\n"
+        + g.copy("arg[" + str(i) + "]", f_.nnz_in(i), xi) + "\n"
+        + "} else {\n"
+        + g.clear(xi, f_.nnz_in(i)) + "\n"
+        + "}\n";
+    }
+    if (checkpoints_==0) {
+      // Backward sweep over the state trajectory, if available
+      g << "if (1";
+      for (casadi_int i=0; i<n_out; ++i) g << " && arg[" << n_in+i << "]";
+      g << ") {\n";
+      g << "for (k=" << n_-1 << "; k>=0; --k) {\n";
+      g << "if (k==0) {\n" << restore_x0 << "} else {\n";
+      for (casadi_int i=0; i<n_accum_; ++i) {
+        casadi_int nnz = f_.nnz_out(i);
+        g << g.copy("arg[" + str(n_in+i) + "]+(k-1)*" + str(nnz), nnz,
+                    "x+" + str(off_[i])) << "\n";
+      }
+      g << "}\n";
+      codegen_adjoint(g, true);
+      g << "}\n";
+      g << "} else {\n";
+    }
+    // Checkpointing schedule
+    std::string sched = g.constant(sched_);
+    g << "kc = 0;\n";
+    g << "for (a=0; a<" << sched_.size() << "; a+=3) {\n";
+    g << "k = " << sched << "[a+1];\n";
+    g << "slot = " << sched << "[a+2];\n";
+    g << "switch (" << sched << "[a]) {\n";
+    // Restore a snapshot
+    g << "case " << RESTORE << ":\n";
+    g << "if (slot<0) {\n" << restore_x0 << "} else {\n"
+      << g.copy("snap+slot*" + str(nacc), nacc, "x") << "\n"
+      << "}\n";
+    g << "kc = k;\n";
+    g << "break;\n";
+    // Advance to step k
+    g << "case " << ADVANCE << ":\n";
+    g << "for (; kc<k; ++kc) {\n";
+    for (casadi_int i=0; i<n_in; ++i) {
+      if (i<n_accum_) {
+        g << "arg1[" << i << "] = x+" << off_[i] << ";\n";
+      } else {
+        g << "arg1[" << i << "] = arg[" << i << "] ? arg[" << i << "]+kc*"
+          << f_.nnz_in(i) << " : 0;\n";
+      }
+    }
+    casadi_int yi = 0;
+    for (casadi_int i=0; i<n_out; ++i) {
+      if (i<n_accum_) {
+        g << "res1[" << i << "] = x_next+" << off_[i] << ";\n";
+      } else {
+        g << "res1[" << i << "] = y+" << yi << ";\n";
+        yi += f_.nnz_out(i);
+      }
+    }
+    g << "if (" << g(f_, "arg1", "res1", "iw", "w") << ") return 1;\n";
+    g << g.copy("x_next", nacc, "x") << "\n";
+    g << "}\n";
+    g << "break;\n";
+    // Store a snapshot
+    g << "case " << TAKESHOT << ":\n";
+    g << g.copy("x", nacc, "snap+slot*" + str(nacc)) << "\n";
+    g << "break;\n";
+    // Adjoint of step k, recomputing its outputs
+    g << "case " << ADJOINT << ":\n";
+    for (casadi_int i=0; i<n_in; ++i) {
+      if (i<n_accum_) {
+        g << "arg1[" << i << "] = x+" << off_[i] << ";\n";
+      } else {
+        g << "arg1[" << i << "] = arg[" << i << "] ? arg[" << i << "]+k*"
+          << f_.nnz_in(i) << " : 0;\n";
+      }
+    }
+    yi = 0;
+    for (casadi_int i=0; i<n_out; ++i) {
+      if (i<n_accum_) {
+        g << "res1[" << i << "] = x_next+" << off_[i] << ";\n";
+      } else {
+        g << "res1[" << i << "] = y+" << yi << ";\n";
+        yi += f_.nnz_out(i);
+      }
+    }
+    codegen_adjoint(g, false);
+    g << "break;\n";
+    g << "}\n";
+    g << "}\n";
+    if (checkpoints_==0) g << "}\n";
+    // Adjoint sensitivities of the initial states
+    for (casadi_int i=0; i<n_accum_; ++i) {
+      g << "if (res[" << i << "]) "
+        << g.copy("lam+" + str(off_[i]), f_.nnz_in(i), "res[" + str(i) + "]") << "\n";
+    }
+  }
+
+} // namespace casadi
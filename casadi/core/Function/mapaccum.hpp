@@ -0,0 +1,277 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_MAPACCUM_HPP
+#define CASADI_MAPACCUM_HPP
+
+#include "function_internal.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** Evaluate a recurrence in a loop
+
+      Evaluates F: (x0, U) -> (X, Y) for f: (x, u) -> (x_next, y) without
+      unrolling, so that the expression graph does not grow with the horizon.
+      Reverse mode is provided by MapAccumRev.
+  */
+  class CASADI_EXPORT MapAccum : public FunctionInternal {
+  public:
+    // Constructor
+    MapAccum(const std::string& name, const Function& f, casadi_int n,
+             casadi_int n_accum, casadi_int checkpoints=0);
+
+    /** \brief Destructor */
+    ~MapAccum() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "MapAccum";}
+
+    /// @{
+    /** \brief Sparsities of function inputs and outputs */
+    Sparsity get_sparsity_in(casadi_int i) override {
+      return i<n_accum_ ? f_.sparsity_in(i) : repmat(f_.sparsity_in(i), 1, n_);
+    }
+    Sparsity get_sparsity_out(casadi_int i) override {
+      return repmat(f_.sparsity_out(i), 1, n_);
+    }
+    /// @}
+
+    /** \brief Get default input value */
+    double get_default_in(casadi_int ind) const override { return f_.default_in(ind);}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    size_t get_n_in() override { return f_.n_in();}
+    size_t get_n_out() override { return f_.n_out();}
+    ///@}
+
+    ///@{
+    /** \brief Names of function input and outputs */
+    std::string get_name_in(casadi_int i) override { return f_.name_in(i);}
+    std::string get_name_out(casadi_int i) override { return f_.name_out(i);}
+    /// @}
+
+    /** \brief  Evaluate or propagate sparsities */
+    template<typename T>
+    int eval_gen(const T** arg, T** res, casadi_int* iw, T* w, casadi_int mem=0) const;
+
+    /// Evaluate the function numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /** \brief  evaluate symbolically while also propagating directional derivatives */
+    int eval_sx(const SXElem** arg, SXElem** res,
+                casadi_int* iw, SXElem* w, void* mem) const override;
+
+    /** \brief  Propagate sparsity forward */
+    int sp_forward(const bvec_t** arg, bvec_t** res,
+                    casadi_int* iw, bvec_t* w, void* mem) const override;
+
+    /** \brief  Propagate sparsity backwards */
+    int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const override;
+
+    ///@{
+    /// Is the class able to propagate seeds through the algorithm?
+    bool has_spfwd() const override { return true;}
+    bool has_sprev() const override { return true;}
+    ///@}
+
+    /** \brief Is codegen supported? */
+    bool has_codegen() const override { return true;}
+
+    /** \brief Generate code for the declarations of the C function */
+    void codegen_declarations(CodeGenerator& g) const override;
+
+    /** \brief Generate code for the body of the C function */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    ///@{
+    /** \brief Generate a function that calculates \a nfwd forward derivatives */
+    bool has_forward(casadi_int nfwd) const override { return true;}
+    Function get_forward(casadi_int nfwd, const std::string& name,
+                         const std::vector<std::string>& inames,
+                         const std::vector<std::string>& onames,
+                         const Dict& opts) const override;
+    ///@}
+
+    ///@{
+    /** \brief Generate a function that calculates \a nadj adjoint derivatives */
+    bool has_reverse(casadi_int nadj) const override { return true;}
+    Function get_reverse(casadi_int nadj, const std::string& name,
+                         const std::vector<std::string>& inames,
+                         const std::vector<std::string>& onames,
+                         const Dict& opts) const override;
+    ///@}
+
+    /** Obtain information about node */
+    Dict info() const override {
+      return {{"f", f_}, {"n", n_}, {"n_accum", n_accum_}, {"checkpoints", checkpoints_}};
+    }
+
+    /** \brief Same loop over an expanded body */
+    Function expand_loops(const std::string& name, const Dict& opts) const override;
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+    /** \brief Serialize type information */
+    void serialize_type(SerializingStream &s) const override;
+
+    /** \brief String used to identify the immediate FunctionInternal subclass */
+    std::string serialize_base_function() const override { return "MapAccum"; }
+
+    /** \brief Deserialize with type disambiguation */
+    static ProtoFunction* deserialize(DeserializingStream& s);
+
+  protected:
+    /** \brief Deserializing constructor */
+    explicit MapAccum(DeserializingStream& s);
+
+    // The function defining one step of the recurrence
+    Function f_;
+
+    // Number of steps
+    casadi_int n_;
+
+    // Number of accumulated inputs and outputs
+    casadi_int n_accum_;
+
+    // Number of state snapshots in reverse mode, 0 for automatic
+    casadi_int checkpoints_;
+
+    // Offsets of the accumulators in the state buffer
+    std::vector<casadi_int> off_;
+  };
+
+  /** Reverse mode of MapAccum
+
+      Inputs are the inputs of the MapAccum, its (possibly empty) outputs unless
+      checkpoints is set, and the adjoint seeds, outputs are the adjoint
+      sensitivities. The states are swept backwards: when the state trajectory
+      is not available, it is recomputed from a limited number of snapshots
+      following a binomial checkpointing schedule (Griewank & Walther, Revolve).
+  */
+  class CASADI_EXPORT MapAccumRev : public FunctionInternal {
+  public:
+    // Constructor
+    MapAccumRev(const std::string& name, const Function& f, casadi_int n,
+                casadi_int n_accum, casadi_int checkpoints);
+
+    /** \brief Destructor */
+    ~MapAccumRev() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "MapAccumRev";}
+
+    /// @{
+    /** \brief Sparsities of function inputs and outputs */
+    Sparsity get_sparsity_in(casadi_int i) override;
+    Sparsity get_sparsity_out(casadi_int i) override {
+      return i<n_accum_ ? f_.sparsity_in(i) : repmat(f_.sparsity_in(i), 1, n_);
+    }
+    /// @}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    size_t get_n_in() override {
+      return f_.n_in() + (checkpoints_==0 ? 2 : 1)*f_.n_out();
+    }
+    size_t get_n_out() override { return f_.n_in();}
+    ///@}
+
+    /// Evaluate the function numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /** \brief Is codegen supported? */
+    bool has_codegen() const override { return true;}
+
+    /** \brief Generate code for the declarations of the C function */
+    void codegen_declarations(CodeGenerator& g) const override;
+
+    /** \brief Generate code for the body of the C function */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    /** Obtain information about node */
+    Dict info() const override {
+      return {{"f", f_}, {"n", n_}, {"n_accum", n_accum_}, {"snapshots", ns_}};
+    }
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+    /** \brief Serialize type information */
+    void serialize_type(SerializingStream &s) const override;
+
+    /** \brief String used to identify the immediate FunctionInternal subclass */
+    std::string serialize_base_function() const override { return "MapAccumRev"; }
+
+    /** \brief Deserialize with type disambiguation */
+    static ProtoFunction* deserialize(DeserializingStream& s);
+
+    /// Actions of the checkpointing schedule
+    enum Action {RESTORE, ADVANCE, TAKESHOT, ADJOINT};
+
+  protected:
+    /** \brief Deserializing constructor */
+    explicit MapAccumRev(DeserializingStream& s);
+
+    // Generate the checkpointing schedule for ns_ snapshots
+    void schedule();
+
+    // Generate code for the adjoint of step k, state in x
+    void codegen_adjoint(CodeGenerator& g, bool traj) const;
+
+    // The function defining one step of the recurrence and its reverse mode
+    Function f_, f_rev_;
+
+    // Number of steps
+    casadi_int n_;
+
+    // Number of accumulated inputs and outputs
+    casadi_int n_accum_;
+
+    // Number of state snapshots, 0 for automatic
+    casadi_int checkpoints_;
+
+    // Number of state snapshots used
+    casadi_int ns_;
+
+    // Offsets of the accumulators in the state buffer
+    std::vector<casadi_int> off_;
+
+    // Checkpointing schedule, (action, step, snapshot) triples
+    std::vector<casadi_int> sched_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_MAPACCUM_HPP
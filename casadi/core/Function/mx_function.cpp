@@ -51,6 +51,7 @@ namespace casadi {
   }
 
   MXFunction::~MXFunction() {
+    clear_mem();
   }
 
   const Options MXFunction::options_
@@ -60,7 +61,11 @@ namespace casadi {
         "Default input values"}},
       {"live_variables",
        {OT_BOOL,
-        "Reuse variables in the work vector"}}
+        "Reuse variables in the work vector"}},
+      {"profile",
+       {OT_BOOL,
+        "Record the number of calls and time of each instruction, available "
+        "in the stats and printed when the memory is released"}}
      }
   };
 
@@ -68,6 +73,7 @@ namespace casadi {
     Dict opts = FunctionInternal::generate_options(is_temp);
     //opts["default_in"] = default_in_;
     opts["live_variables"] = live_variables_;
+    opts["profile"] = profile_;
     return opts;
   }
 
@@ -109,6 +115,8 @@ namespace casadi {
         default_in_ = op.second;
       } else if (op.first=="live_variables") {
         live_variables_ = op.second;
+      } else if (op.first=="profile") {
+        profile_ = op.second;
       }
     }
 
@@ -403,6 +411,9 @@ namespace casadi {
                    + str(free_vars_) + " are free.");
     }
 
+    // Profile, if requested
+    auto m = static_cast<XFunctionProfile*>(mem);
+
     // Evaluate all of the nodes of the algorithm:
     // should only evaluate nodes that have not yet been calculated!
     for (auto&& e : algorithm_) {
@@ -432,7 +443,15 @@ namespace casadi {
           res1[i] = e.res[i]>=0 ? w+workloc_[e.res[i]] : nullptr;
 
         // Evaluate
-        if (e.data->eval(arg1, res1, iw, w)) return 1;
+        if (m) {
+          unsigned long long t0 = timestamp();
+          if (e.data->eval(arg1, res1, iw, w)) return 1;
+          casadi_int k = &e - algorithm_.data();
+          m->t[k] += timestamp() - t0;
+          m->n_call[k]++;
+        } else {
+          if (e.data->eval(arg1, res1, iw, w)) return 1;
+        }
       }
     }
     return 0;
@@ -671,6 +690,78 @@ namespace casadi {
     }
   }
 
+  Function MXFunction::expand_loops(const std::string& name, const Dict& opts) const {
+    if (verbose_) casadi_message(name_ + "::expand_loops");
+    try {
+      // Any loops in the algorithm?
+      bool has_loops = false;
+
+      // Symbolic work, non-differentiated
+      vector<MX> swork(workloc_.size()-1);
+
+      // Outputs, split analogous to symbolic primitives
+      vector<vector<MX> > res_split(out_.size());
+      for (casadi_int i=0; i<out_.size(); ++i) res_split[i].resize(out_[i].n_primitives());
+
+      vector<MX> arg1, res1;
+
+      // Loop over computational nodes in forward order
+      for (auto it=algorithm_.begin(); it!=algorithm_.end(); ++it) {
+        if (it->op == OP_INPUT) {
+          swork[it->res.front()] = it->data;
+        } else if (it->op==OP_OUTPUT) {
+          res_split.at(it->data->ind()).at(it->data->segment()) = swork[it->arg.front()];
+        } else if (it->op==OP_PARAMETER) {
+          swork[it->res.front()] = it->data;
+        } else {
+          // Arguments of the operation
+          arg1.resize(it->arg.size());
+          for (casadi_int i=0; i<arg1.size(); ++i) {
+            casadi_int el = it->arg[i]; // index of the argument
+            arg1[i] = el<0 ? MX(it->data->dep(i).size()) : swork[el];
+          }
+
+          // Replace calls to loops, expand calls to other MX functions
+          Function f;
+          if (it->op==OP_CALL) {
+            Function fcn = it->data.which_function();
+            f = fcn->expand_loops(fcn.name(), Dict());
+            if (!f.is_null()) {
+              has_loops = true;
+            } else if (fcn.is_a("MXFunction") && !fcn.has_free()) {
+              f = fcn.expand(fcn.name(), {{"keep_loops", true}});
+              if (f.is_a("MXFunction")) has_loops = true;
+            }
+          }
+
+          // Perform the operation
+          res1.resize(it->res.size());
+          if (f.is_null()) {
+            it->data->eval_mx(arg1, res1);
+          } else {
+            res1 = f(arg1);
+          }
+
+          // Get the result
+          for (casadi_int i=0; i<res1.size(); ++i) {
+            casadi_int el = it->res[i]; // index of the output
+            if (el>=0) swork[el] = res1[i];
+          }
+        }
+      }
+
+      // Unroll everything if there are no loops
+      if (!has_loops) return Function();
+
+      // Join split outputs
+      vector<MX> res(out_.size());
+      for (casadi_int i=0; i<res.size(); ++i) res[i] = out_[i].join_primitives(res_split[i]);
+      return Function(name, in_, res, name_in_, name_out_, opts);
+    } catch (std::exception& e) {
+      CASADI_THROW_ERROR("expand_loops", e.what());
+    }
+  }
+
   void MXFunction::ad_forward(const std::vector<std::vector<MX> >& fseed,
                                 std::vector<std::vector<MX> >& fsens) const {
     if (verbose_) casadi_message(name_ + "::ad_forward(" + str(fseed.size())+ ")");
@@ -1668,13 +1759,15 @@ namespace casadi {
       if (e.op==OP_CALL) {
         Function d = e.data.which_function();
         if (d.is_a("conic", true)) {
-          if (!dep.is_null()) return {};
+          if (!dep.is_null()) return stats;
           dep = d;
         }
       }
     }
-    if (dep.is_null()) return {};
-    return dep.stats(1);
+    if (dep.is_null()) return stats;
+    Dict dep_stats = dep.stats(1);
+    stats.insert(dep_stats.begin(), dep_stats.end());
+    return stats;
   }
 
   void MXFunction::serialize_body(SerializingStream &s) const {
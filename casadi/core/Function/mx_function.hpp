@@ -110,6 +110,12 @@ namespace casadi {
     /// Get all statistics
     Dict get_stats(void* mem) const override;
 
+    /// Number of profiled entries, one per instruction
+    casadi_int profile_size() const { return algorithm_.size();}
+
+    /// Description of a profiled instruction
+    std::string profile_label(casadi_int k) const { return print(algorithm_.at(k));}
+
     /// Reconstruct options dict
     Dict generate_options(bool is_temp) const override;
 
@@ -149,6 +155,9 @@ namespace casadi {
     void eval_mx(const MXVector& arg, MXVector& res,
                  bool always_inline, bool never_inline) const override;
 
+    /** \brief Expand called functions, keeping loops over an expanded body */
+    Function expand_loops(const std::string& name, const Dict& opts) const override;
+
     /** \brief Calculate forward mode directional derivatives */
     void ad_forward(const std::vector<std::vector<MX> >& fwdSeed,
                         std::vector<std::vector<MX> >& fwdSens) const;
@@ -26,9 +26,11 @@
 #include "oracle_function.hpp"
 #include "external.hpp"
 #include "serializing_stream.hpp"
+#include "map.hpp"
 
 #include <iomanip>
 #include <iostream>
+#include <exception>
 
 using namespace std;
 
@@ -36,6 +38,8 @@ namespace casadi {
 
   OracleFunction::OracleFunction(const std::string& name, const Function& oracle)
   : FunctionInternal(name), oracle_(oracle) {
+    max_concurrent_ = 1;
+    call_sz_arg_ = call_sz_res_ = call_sz_iw_ = call_sz_w_ = 0;
   }
 
   OracleFunction::~OracleFunction() {
@@ -58,7 +62,11 @@ namespace casadi {
       {"specific_options",
        {OT_DICT,
         "Options for specific auto-generated functions,"
-        " overwriting the defaults from common_options. Nested dictionary."}}
+        " overwriting the defaults from common_options. Nested dictionary."}},
+      {"max_concurrent",
+       {OT_INT,
+        "Maximum number of independent oracle calls evaluated concurrently,"
+        " requires CasADi to be compiled with WITH_THREAD=ON [1]"}}
     }
   };
 
@@ -89,6 +97,8 @@ namespace casadi {
         monitor_ = op.second;
       } else if (op.first=="show_eval_warnings") {
         show_eval_warnings_ = op.second;
+      } else if (op.first=="max_concurrent") {
+        max_concurrent_ = op.second;
       }
     }
 
@@ -160,50 +170,148 @@ namespace casadi {
     r.f = fcn;
     r.jit = jit;
     alloc(fcn);
+
+    // Work for concurrent calls, separated by cache lines
+    size_t sz_arg, sz_res, sz_iw, sz_w;
+    Map::parallel_work(fcn, sz_arg, sz_res, sz_iw, sz_w);
+    call_sz_arg_ = max(call_sz_arg_, sz_arg);
+    call_sz_res_ = max(call_sz_res_, sz_res);
+    call_sz_iw_ = max(call_sz_iw_, sz_iw);
+    call_sz_w_ = max(call_sz_w_, sz_w);
+    alloc_arg(max_concurrent_*call_sz_arg_);
+    alloc_res(max_concurrent_*call_sz_res_);
+    alloc_iw(max_concurrent_*call_sz_iw_);
+    alloc_w(max_concurrent_*call_sz_w_);
   }
 
   int OracleFunction::
   calc_function(OracleMemory* m, const std::string& fcn,
                 const double* const* arg) const {
-    // Is the function monitored?
-    bool monitored = this->monitored(fcn);
-
     // Print progress
-    if (monitored) casadi_message("Calling \"" + fcn + "\"");
+    if (monitored(fcn)) casadi_message("Calling \"" + fcn + "\"");
+
+    // Respond to a possible Crl+C signals
+    InterruptHandler::check();
+
+    // Input buffers
+    if (arg) {
+      casadi_int n_in = get_function(fcn).n_in();
+      fill_n(m->arg, n_in, nullptr);
+      for (casadi_int i=0; i<n_in; ++i) m->arg[i] = *arg++;
+    }
+
+    // Evaluate
+    scoped_checkout<Function> mem(get_function(fcn));
+    return eval_function(fcn, m->arg, m->res, m->iw, m->w, mem, m->fstats.at(fcn));
+  }
 
+  int OracleFunction::
+  calc_functions(OracleMemory* m, const std::vector<OracleCall>& calls) const {
     // Respond to a possible Crl+C signals
     InterruptHandler::check();
 
+    // Number of evaluation slots, monitored calls are printed in order
+    casadi_int nslot = min(max_concurrent_, static_cast<casadi_int>(calls.size()));
+    for (auto&& c : calls) {
+      if (monitored(c.fcn)) nslot = 1;
+    }
+    nslot = m->pool ? min(nslot, m->pool->size()) : 1;
+
+    // Statistics and return flag of each call
+    vector<FStats> fstats(calls.size());
+    vector<int> flag(calls.size(), 0);
+
+    // Exception raised by each slot
+    vector<exception_ptr> ex(nslot);
+
+    // Function memory of each call, checked out before the workers start
+    vector< scoped_checkout<Function> > mem;
+    mem.reserve(calls.size());
+    for (auto&& c : calls) mem.emplace_back(get_function(c.fcn));
+
+    // Calls s, s+nslot, ... are handled by slot s
+    auto run_slot = [&](casadi_int s) {
+      const double** arg = m->arg + s*call_sz_arg_;
+      double** res = m->res + s*call_sz_res_;
+      try {
+        for (casadi_int k=s; k<calls.size(); k+=nslot) {
+          const OracleCall& c = calls[k];
+          if (monitored(c.fcn)) casadi_message("Calling \"" + c.fcn + "\"");
+          const Function& f = get_function(c.fcn);
+          casadi_assert(c.arg.size()<=f.n_in() && c.res.size()<=f.n_out(),
+                        "Too many buffers for \"" + c.fcn + "\"");
+          fill_n(arg, f.n_in(), nullptr);
+          copy(c.arg.begin(), c.arg.end(), arg);
+          fill_n(res, f.n_out(), nullptr);
+          copy(c.res.begin(), c.res.end(), res);
+          flag[k] = eval_function(c.fcn, arg, res, m->iw + s*call_sz_iw_,
+                                  m->w + s*call_sz_w_, mem[k], fstats[k]);
+        }
+      } catch (...) {
+        ex[s] = current_exception();
+      }
+    };
+
+    // Time the batch as a whole, the calls overlap
+    FStats batch;
+    batch.tic();
+    if (nslot>1) {
+      m->pool->run(nslot, run_slot);
+    } else {
+      run_slot(0);
+    }
+    batch.toc();
+
+    // Split the batch time between the calls, in proportion to their own wall time
+    double t_sum = 0;
+    for (auto&& fs : fstats) t_sum += fs.t_wall;
+    for (casadi_int k=0; k<calls.size(); ++k) {
+      double share = t_sum>0 ? fstats[k].t_wall/t_sum : 1./static_cast<double>(calls.size());
+      FStats& fs = m->fstats.at(calls[k].fcn);
+      fs.n_call += fstats[k].n_call;
+      fs.t_wall += share*batch.t_wall;
+      fs.t_proc += share*batch.t_proc;
+    }
+
+    // Propagate the first exception
+    for (auto&& e : ex) {
+      if (e) rethrow_exception(e);
+    }
+
+    // Return the first error flag
+    for (int e : flag) {
+      if (e) return e;
+    }
+    return 0;
+  }
+
+  int OracleFunction::
+  eval_function(const std::string& fcn, const double** arg, double** res,
+                casadi_int* iw, double* w, casadi_int mem, FStats& fstats) const {
+    // Is the function monitored?
+    bool monitored = this->monitored(fcn);
+
     // Get function
     const Function& f = get_function(fcn);
 
-    // Get statistics structure
-    FStats& fstats = m->fstats.at(fcn);
-
     // Number of inputs and outputs
     casadi_int n_in = f.n_in(), n_out = f.n_out();
 
     // Prepare stats, start timer
     fstats.tic();
 
-    // Input buffers
-    if (arg) {
-      fill_n(m->arg, n_in, nullptr);
-      for (casadi_int i=0; i<n_in; ++i) m->arg[i] = *arg++;
-    }
-
     // Print inputs nonzeros
     if (monitored) {
       std::stringstream s;
       s << fcn << " input nonzeros:\n";
       for (casadi_int i=0; i<n_in; ++i) {
         s << " " << i << " (" << f.name_in(i) << "): ";
-        if (m->arg[i]) {
+        if (arg[i]) {
           // Print nonzeros
           s << "[";
           for (casadi_int k=0; k<f.nnz_in(i); ++k) {
             if (k!=0) s << ", ";
-            DM::print_scalar(s, m->arg[i][k]);
+            DM::print_scalar(s, arg[i][k]);
           }
           s << "]\n";
         } else {
@@ -216,7 +324,7 @@ namespace casadi {
 
     // Evaluate memory-less
     try {
-      f(m->arg, m->res, m->iw, m->w);
+      f(arg, res, iw, w, mem);
     } catch(exception& ex) {
       // Fatal error
       if (show_eval_warnings_) {
@@ -231,12 +339,12 @@ namespace casadi {
       s << fcn << " output nonzeros:\n";
       for (casadi_int i=0; i<n_out; ++i) {
         s << " " << i << " (" << f.name_out(i) << "): ";
-        if (m->res[i]) {
+        if (res[i]) {
           // Print nonzeros
           s << "[";
           for (casadi_int k=0; k<f.nnz_out(i); ++k) {
             if (k!=0) s << ", ";
-            DM::print_scalar(s, m->res[i][k]);
+            DM::print_scalar(s, res[i][k]);
           }
           s << "]\n";
         } else {
@@ -249,13 +357,13 @@ namespace casadi {
 
     // Make sure not NaN or Inf
     for (casadi_int i=0; i<n_out; ++i) {
-      if (!m->res[i]) continue;
-      if (!all_of(m->res[i], m->res[i]+f.nnz_out(i), [](double v) { return isfinite(v);})) {
+      if (!res[i]) continue;
+      if (!all_of(res[i], res[i]+f.nnz_out(i), [](double v) { return isfinite(v);})) {
         std::stringstream ss;
 
-        auto it = find_if(m->res[i], m->res[i]+f.nnz_out(i), [](double v) { return !isfinite(v);});
-        casadi_int k = distance(m->res[i], it);
-        bool is_nan = isnan(m->res[i][k]);
+        auto it = find_if(res[i], res[i]+f.nnz_out(i), [](double v) { return !isfinite(v);});
+        casadi_int k = distance(res[i], it);
+        bool is_nan = isnan(res[i][k]);
         ss << name_ << ":" << fcn << " failed: " << (is_nan? "NaN" : "Inf") <<
         " detected for output " << f.name_out(i) << ", at " << f.sparsity_out(i).repr_el(k) << ".";
 
@@ -350,6 +458,9 @@ namespace casadi {
     for (auto&& e : all_functions_) {
       m->fstats[e.first] = FStats();
     }
+
+    // Workers for calc_functions, kept for the lifetime of the memory object
+    if (max_concurrent_>1) m->pool.reset(new ThreadPool(max_concurrent_-1));
     return 0;
   }
 
@@ -395,7 +506,7 @@ namespace casadi {
   void OracleFunction::serialize_body(SerializingStream &s) const {
     FunctionInternal::serialize_body(s);
 
-    s.version("OracleFunction", 1);
+    s.version("OracleFunction", 2);
     s.pack("OracleFunction::oracle", oracle_);
     s.pack("OracleFunction::common_options", common_options_);
     s.pack("OracleFunction::specific_options", specific_options_);
@@ -408,11 +519,16 @@ namespace casadi {
       s.pack("OracleFunction::all_functions::value::monitored", e.second.monitored);
     }
     s.pack("OracleFunction::monitor", monitor_);
+    s.pack("OracleFunction::max_concurrent", max_concurrent_);
+    s.pack("OracleFunction::call_sz_arg", call_sz_arg_);
+    s.pack("OracleFunction::call_sz_res", call_sz_res_);
+    s.pack("OracleFunction::call_sz_iw", call_sz_iw_);
+    s.pack("OracleFunction::call_sz_w", call_sz_w_);
   }
 
   OracleFunction::OracleFunction(DeserializingStream& s) : FunctionInternal(s) {
 
-    s.version("OracleFunction", 1);
+    s.version("OracleFunction", 2);
     s.unpack("OracleFunction::oracle", oracle_);
     s.unpack("OracleFunction::common_options", common_options_);
     s.unpack("OracleFunction::specific_options", specific_options_);
@@ -430,6 +546,11 @@ namespace casadi {
       all_functions_[key] = r;
     }
     s.unpack("OracleFunction::monitor", monitor_);
+    s.unpack("OracleFunction::max_concurrent", max_concurrent_);
+    s.unpack("OracleFunction::call_sz_arg", call_sz_arg_);
+    s.unpack("OracleFunction::call_sz_res", call_sz_res_);
+    s.unpack("OracleFunction::call_sz_iw", call_sz_iw_);
+    s.unpack("OracleFunction::call_sz_w", call_sz_w_);
   }
 
 } // namespace casadi
@@ -28,6 +28,9 @@
 
 #include "function_internal.hpp"
 #include "timing.hpp"
+#include "thread_pool.hpp"
+
+#include <memory>
 
 /// \cond INTERNAL
 namespace casadi {
@@ -43,6 +46,9 @@ namespace casadi {
     // Function specific statistics
     std::map<std::string, FStats> fstats;
 
+    // Workers for concurrent oracle calls
+    std::unique_ptr<ThreadPool> pool;
+
     // Add a statistic
     void add_stat(const std::string& s) {
       bool added = fstats.insert(std::make_pair(s, FStats())).second;
@@ -50,6 +56,15 @@ namespace casadi {
     }
   };
 
+  /** \brief One oracle call in a set of independent calls */
+  struct CASADI_EXPORT OracleCall {
+    // Name of the oracle function
+    std::string fcn;
+    // Input and output buffers, null entries for all-zero or ignored
+    std::vector<const double*> arg;
+    std::vector<double*> res;
+  };
+
   /** \brief Base class for functions that perform calculation with an oracle
       \author Joel Andersson
       \date 2016
@@ -79,6 +94,12 @@ namespace casadi {
     // Active monitors
     std::vector<std::string> monitor_;
 
+    // Maximum number of concurrent oracle calls in calc_functions
+    casadi_int max_concurrent_;
+
+    // Work per concurrent oracle call
+    size_t call_sz_arg_, call_sz_res_, call_sz_iw_, call_sz_w_;
+
   public:
     /** \brief  Constructor */
     OracleFunction(const std::string& name, const Function& oracle);
@@ -121,6 +142,14 @@ namespace casadi {
     int calc_function(OracleMemory* m, const std::string& fcn,
                       const double* const* arg=nullptr) const;
 
+    /** \brief Calculate a set of independent oracle functions
+
+        With max_concurrent > 1, the calls are evaluated concurrently on the
+        workers of the memory object, each with its own work vectors and
+        function memory. The wall and proc time of the batch is measured once
+        and split between the calls. */
+    int calc_functions(OracleMemory* m, const std::vector<OracleCall>& calls) const;
+
     /** \brief Get list of dependency functions
      * -1 Indicates irregularity
     */
@@ -167,6 +196,10 @@ namespace casadi {
     /** \brief Deserializing constructor */
     explicit OracleFunction(DeserializingStream& s);
 
+    // Evaluate with given buffers and function memory, timing into fstats
+    int eval_function(const std::string& fcn, const double** arg, double** res,
+                      casadi_int* iw, double* w, casadi_int mem, FStats& fstats) const;
+
   };
 
 } // namespace casadi
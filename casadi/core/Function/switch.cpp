@@ -155,7 +155,11 @@ namespace casadi {
     // Get the function to be evaluated
     casadi_int k = arg[0] ? static_cast<casadi_int>(*arg[0]) : 0;
     const Function& fk = k>=0 && k<f_.size() ? f_[k] : f_def_;
+    return eval_case(fk, arg, res, iw, w);
+  }
 
+  int Switch::eval_case(const Function& fk, const double** arg, double** res,
+                        casadi_int* iw, double* w) const {
     // Project arguments with different sparsity
     const double** arg1;
     if (project_in_) {
@@ -210,6 +214,122 @@ namespace casadi {
     return 0;
   }
 
+  SwitchMap::~SwitchMap() {
+  }
+
+  void SwitchMap::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    Map::init(opts);
+
+    // Reduced outputs are handled by Map
+    if (any_reduce()) return;
+    const Switch* s = static_cast<const Switch*>(f_.get());
+
+    // Instances sorted by case, start of each case
+    alloc_iw(n_ + s->f_.size() + 2 + f_.sz_iw());
+
+    // Gathered inputs and outputs of a batched case
+    size_t sz_w = 0;
+    bool batch = batch_case(s->f_def_);
+    for (const Function& fk : s->f_) batch = batch || batch_case(fk);
+    if (batch) {
+      for (casadi_int j=1; j<n_in_; ++j) sz_w += n_*f_.nnz_in(j);
+      for (casadi_int j=0; j<n_out_; ++j) sz_w += n_*f_.nnz_out(j);
+    }
+    alloc_w(sz_w + f_.sz_w());
+  }
+
+  bool SwitchMap::batch_case(const Function& fk) const {
+    const Switch* s = static_cast<const Switch*>(f_.get());
+    return !s->project_in_ && !s->project_out_ && !fk.is_null() && fk->has_eval_batch();
+  }
+
+  int SwitchMap::eval(const double** arg, double** res,
+                      casadi_int* iw, double* w, void* mem) const {
+    if (any_reduce()) return Map::eval(arg, res, iw, w, mem);
+    const Switch* s = static_cast<const Switch*>(f_.get());
+    casadi_int n_case = s->f_.size();
+
+    // Case of instance i, default case last
+    auto get_case = [&](casadi_int i) {
+      casadi_int k = arg[0] ? static_cast<casadi_int>(arg[0][i]) : 0;
+      return k<0 || k>=n_case ? n_case : k;
+    };
+
+    // Counting sort of the instances by case
+    casadi_int* start = iw; iw += n_case + 2;
+    casadi_int* ind = iw; iw += n_;
+    fill_n(start, n_case + 2, 0);
+    for (casadi_int i=0; i<n_; ++i) start[get_case(i) + 2]++;
+    for (casadi_int k=2; k<n_case + 2; ++k) start[k] += start[k-1];
+    for (casadi_int i=0; i<n_; ++i) ind[start[get_case(i) + 1]++] = i;
+
+    const double** arg1 = arg + n_in_;
+    double** res1 = res + n_out_;
+    for (casadi_int k=0; k<=n_case; ++k) {
+      // Instances ind[i0], ..., ind[i1-1] select case k
+      casadi_int i0 = start[k], i1 = start[k+1], m = i1 - i0;
+      if (m==0) continue;
+      const Function& fk = k<n_case ? s->f_[k] : s->f_def_;
+      if (m>1 && batch_case(fk) && fk->use_eval_batch()) {
+        // Gather the inputs, unless the instances are already contiguous
+        bool contiguous = ind[i1-1] - ind[i0] == m - 1;
+        double* wg = w;
+        for (casadi_int j=1; j<n_in_; ++j) {
+          casadi_int nnz = f_.nnz_in(j);
+          if (!arg[j]) {
+            arg1[j] = nullptr;
+          } else if (contiguous) {
+            arg1[j] = arg[j] + ind[i0]*nnz;
+          } else {
+            for (casadi_int r=0; r<m; ++r) {
+              casadi_copy(arg[j] + ind[i0+r]*nnz, nnz, wg + r*nnz);
+            }
+            arg1[j] = wg;
+            wg += m*nnz;
+          }
+        }
+        for (casadi_int j=0; j<n_out_; ++j) {
+          casadi_int nnz = f_.nnz_out(j);
+          if (!res[j]) {
+            res1[j] = nullptr;
+          } else if (contiguous) {
+            res1[j] = res[j] + ind[i0]*nnz;
+          } else {
+            res1[j] = wg;
+            wg += m*nnz;
+          }
+        }
+        // The whole group in one call, skipping the case index input
+        scoped_checkout<Function> mem_k(fk);
+        if (fk->eval_batch(m, arg1 + 1, res1, iw, wg, fk.memory(mem_k))) return 1;
+        // Scatter the outputs
+        if (!contiguous) {
+          for (casadi_int j=0; j<n_out_; ++j) {
+            if (!res[j]) continue;
+            casadi_int nnz = f_.nnz_out(j);
+            for (casadi_int r=0; r<m; ++r) {
+              casadi_copy(res1[j] + r*nnz, nnz, res[j] + ind[i0+r]*nnz);
+            }
+          }
+        }
+      } else {
+        // Run the case over its instances
+        for (casadi_int r=i0; r<i1; ++r) {
+          casadi_int i = ind[r];
+          for (casadi_int j=0; j<n_in_; ++j) {
+            arg1[j] = arg[j] ? arg[j] + i*f_.nnz_in(j) : nullptr;
+          }
+          for (casadi_int j=0; j<n_out_; ++j) {
+            res1[j] = res[j] ? res[j] + i*f_.nnz_out(j) : nullptr;
+          }
+          if (s->eval_case(fk, arg1, res1, iw, w)) return 1;
+        }
+      }
+    }
+    return 0;
+  }
+
   Function Switch
   ::get_forward(casadi_int nfwd, const std::string& name,
                 const std::vector<std::string>& inames,
@@ -27,6 +27,7 @@
 #define CASADI_SWITCH_HPP
 
 #include "function_internal.hpp"
+#include "map.hpp"
 
 /// \cond INTERNAL
 
@@ -67,6 +68,10 @@ namespace casadi {
     /** \brief  Evaluate numerically, work vectors given */
     int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
 
+    /** \brief  Evaluate a given case numerically, work vectors given */
+    int eval_case(const Function& fk, const double** arg, double** res,
+                  casadi_int* iw, double* w) const;
+
     /** \brief  evaluate symbolically while also propagating directional derivatives */
     int eval_sx(const SXElem** arg, SXElem** res,
                 casadi_int* iw, SXElem* w, void* mem) const override;
@@ -124,6 +129,41 @@ namespace casadi {
     explicit Switch(DeserializingStream& s);
   };
 
+  /** Serial map of a Switch
+      The instances are sorted by case, so that each case is run once over
+      all instances selecting it: as one batch call over gathered inputs if
+      the case supports it, otherwise instance by instance.
+  */
+  class CASADI_EXPORT SwitchMap : public Map {
+    friend class Map;
+  public:
+    // Constructor (protected, use create function in Map)
+    SwitchMap(const std::string& name, const Function& f, casadi_int n,
+              const std::vector<bool>& reduce_in = std::vector<bool>(),
+              const std::vector<bool>& reduce_out = std::vector<bool>())
+      : Map(name, f, n, reduce_in, reduce_out) {}
+
+    /** \brief  Destructor */
+    ~SwitchMap() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "SwitchMap";}
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    /// Evaluate the function numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+  protected:
+    /** \brief Deserializing constructor */
+    explicit SwitchMap(DeserializingStream& s) : Map(s) {}
+
+  private:
+    /** \brief Can case k be evaluated in one batch call over gathered instances? */
+    bool batch_case(const Function& fk) const;
+  };
+
 } // namespace casadi
 /// \endcond
 
@@ -61,6 +61,7 @@ namespace casadi {
   }
 
   SXFunction::~SXFunction() {
+    clear_mem();
   }
 
   int SXFunction::eval(const double** arg, double** res,
@@ -79,6 +80,26 @@ namespace casadi {
     // class structure can cause large performance losses. For this reason,
     // the preprocessor macros are used below
 
+    // Profiled evaluation, kept separate to leave the loop below untouched
+    if (mem) {
+      auto m = static_cast<XFunctionProfile*>(mem);
+      for (auto&& e : algorithm_) {
+        unsigned long long t0 = timestamp();
+        switch (e.op) {
+          CASADI_MATH_FUN_BUILTIN(w[e.i1], w[e.i2], w[e.i0])
+
+        case OP_CONST: w[e.i0] = e.d; break;
+        case OP_INPUT: w[e.i0] = arg[e.i1]==nullptr ? 0 : arg[e.i1][e.i2]; break;
+        case OP_OUTPUT: if (res[e.i0]!=nullptr) res[e.i0][e.i2] = w[e.i1]; break;
+        default:
+          casadi_error("Unknown operation" + str(e.op));
+        }
+        m->t[e.op] += timestamp() - t0;
+        m->n_call[e.op]++;
+      }
+      return 0;
+    }
+
     // Evaluate the algorithm
     for (auto&& e : algorithm_) {
       switch (e.op) {
@@ -196,7 +217,12 @@ namespace casadi {
         "Just-in-time compilation for numeric evaluation using OpenCL (experimental)"}},
       {"live_variables",
        {OT_BOOL,
-        "Reuse variables in the work vector"}}
+        "Reuse variables in the work vector"}},
+      {"profile",
+       {OT_BOOL,
+        "Record the number of calls and time of each operation type, available "
+        "in the stats and printed when the memory is released. "
+        "The times include the overhead of the timer"}}
      }
   };
 
@@ -206,6 +232,7 @@ namespace casadi {
     opts["live_variables"] = live_variables_;
     opts["just_in_time_sparsity"] = just_in_time_sparsity_;
     opts["just_in_time_opencl"] = just_in_time_opencl_;
+    opts["profile"] = profile_;
     return opts;
   }
 
@@ -227,6 +254,8 @@ namespace casadi {
         just_in_time_opencl_ = op.second;
       } else if (op.first=="just_in_time_sparsity") {
         just_in_time_sparsity_ = op.second;
+      } else if (op.first=="profile") {
+        profile_ = op.second;
       }
     }
 
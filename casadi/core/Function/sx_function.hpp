@@ -197,6 +197,12 @@ class CASADI_EXPORT SXFunction :
   /// Reconstruct options dict
   Dict generate_options(bool is_temp) const override;
 
+  /// Number of profiled entries, one per operation type
+  casadi_int profile_size() const { return NUM_BUILT_IN_OPS;}
+
+  /// Description of a profiled operation type
+  std::string profile_label(casadi_int k) const { return casadi_math<double>::name(k);}
+
   /** \brief  Initialize */
   void init(const Dict& opts) override;
 
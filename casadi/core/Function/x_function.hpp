@@ -32,9 +32,11 @@
 #define CASADI_X_FUNCTION_HPP
 
 #include <stack>
+#include <algorithm>
 #include "function_internal.hpp"
 #include "factory.hpp"
 #include "serializing_stream.hpp"
+#include "timing.hpp"
 
 // To reuse variables we need to be able to sort by sparsity pattern
 #include <unordered_map>
@@ -44,6 +46,14 @@
 
 namespace casadi {
 
+  /** \brief Memory of a profiled SXFunction or MXFunction */
+  struct CASADI_EXPORT XFunctionProfile {
+    // Number of calls of each instruction (MX) or operation (SX)
+    std::vector<casadi_int> n_call;
+    // Accumulated time of each, in timestamp ticks
+    std::vector<unsigned long long> t;
+  };
+
   /** \brief  Internal node class for the base class of SXFunction and MXFunction
       (lacks a public counterpart)
       The design of the class uses the curiously recurring template pattern (CRTP) idiom
@@ -67,6 +77,21 @@ namespace casadi {
     /** \brief  Initialize */
     void init(const Dict& opts) override;
 
+    /** \brief Create memory block, only needed when profiling */
+    void* alloc_mem() const override { return profile_ ? new XFunctionProfile() : nullptr;}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block, printing the profile */
+    void free_mem(void *mem) const override;
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+    /** \brief Print the profile, most time consuming first */
+    void print_profile(const XFunctionProfile* m) const;
+
     ///@{
     /// Is the class able to propagate seeds through the algorithm?
     bool has_spfwd() const override { return true;}
@@ -214,6 +239,13 @@ namespace casadi {
 
     /** \brief  Outputs of the function (needed for symbolic calculations) */
     std::vector<MatType> out_;
+
+    /** \brief Record the number of calls and time of each instruction */
+    bool profile_;
+
+  protected:
+    /** \brief Profiled instructions sorted by decreasing time */
+    std::vector<casadi_int> profile_order(const XFunctionProfile* m) const;
   };
 
   // Template implementations
@@ -225,7 +257,7 @@ namespace casadi {
             const std::vector<MatType>& ex_out,
             const std::vector<std::string>& name_in,
             const std::vector<std::string>& name_out)
-    : FunctionInternal(name), in_(ex_in),  out_(ex_out) {
+    : FunctionInternal(name), in_(ex_in),  out_(ex_out), profile_(false) {
     // Names of inputs
     if (!name_in.empty()) {
       casadi_assert(ex_in.size()==name_in.size(),
@@ -242,7 +274,7 @@ namespace casadi {
 
   template<typename DerivedType, typename MatType, typename NodeType>
   XFunction<DerivedType, MatType, NodeType>::
-  XFunction(DeserializingStream& s) : FunctionInternal(s) {
+  XFunction(DeserializingStream& s) : FunctionInternal(s), profile_(false) {
     s.version("XFunction", 1);
     s.unpack("XFunction::in", in_);
     // 'out' member needs to be delayed
@@ -1185,6 +1217,77 @@ namespace casadi {
     return ret;
   }
 
+  template<typename DerivedType, typename MatType, typename NodeType>
+  int XFunction<DerivedType, MatType, NodeType>::init_mem(void* mem) const {
+    if (FunctionInternal::init_mem(mem)) return 1;
+    auto m = static_cast<XFunctionProfile*>(mem);
+    if (m) {
+      casadi_int n = static_cast<const DerivedType*>(this)->profile_size();
+      m->n_call.assign(n, 0);
+      m->t.assign(n, 0);
+    }
+    return 0;
+  }
+
+  template<typename DerivedType, typename MatType, typename NodeType>
+  void XFunction<DerivedType, MatType, NodeType>::free_mem(void *mem) const {
+    auto m = static_cast<XFunctionProfile*>(mem);
+    if (m) print_profile(m);
+    delete m;
+  }
+
+  template<typename DerivedType, typename MatType, typename NodeType>
+  std::vector<casadi_int> XFunction<DerivedType, MatType, NodeType>::
+  profile_order(const XFunctionProfile* m) const {
+    std::vector<casadi_int> order;
+    for (casadi_int k=0; k<m->n_call.size(); ++k) {
+      if (m->n_call[k]>0) order.push_back(k);
+    }
+    std::stable_sort(order.begin(), order.end(),
+      [m](casadi_int a, casadi_int b) { return m->t[a]>m->t[b];});
+    return order;
+  }
+
+  template<typename DerivedType, typename MatType, typename NodeType>
+  Dict XFunction<DerivedType, MatType, NodeType>::get_stats(void* mem) const {
+    Dict stats = FunctionInternal::get_stats(mem);
+    auto m = static_cast<const XFunctionProfile*>(mem);
+    if (m) {
+      std::vector<casadi_int> order = profile_order(m);
+      std::vector<std::string> label;
+      std::vector<casadi_int> n_call;
+      std::vector<double> t_wall;
+      for (casadi_int k : order) {
+        label.push_back(static_cast<const DerivedType*>(this)->profile_label(k));
+        n_call.push_back(m->n_call[k]);
+        t_wall.push_back(static_cast<double>(m->t[k])*timestamp_period());
+      }
+      stats["profile"] = Dict{{"instruction", order}, {"label", label},
+                              {"n_call", n_call}, {"t_wall", t_wall}};
+    }
+    return stats;
+  }
+
+  template<typename DerivedType, typename MatType, typename NodeType>
+  void XFunction<DerivedType, MatType, NodeType>::
+  print_profile(const XFunctionProfile* m) const {
+    std::vector<casadi_int> order = profile_order(m);
+    if (order.empty()) return;
+    // Total time
+    unsigned long long t_tot = 0;
+    for (casadi_int k : order) t_tot += m->t[k];
+    // Print header
+    print("Profile of %s:\n", name_.c_str());
+    print("%12s %9s %6s  %s\n", "t_wall [s]", "n_call", "share", "instruction");
+    // Print instructions, most time consuming first
+    for (casadi_int k : order) {
+      print("%12.3g %9d %5.1f%%  %s\n", static_cast<double>(m->t[k])*timestamp_period(),
+            static_cast<int>(m->n_call[k]),
+            t_tot==0 ? 0. : 100.*static_cast<double>(m->t[k])/static_cast<double>(t_tot),
+            static_cast<const DerivedType*>(this)->profile_label(k).c_str());
+    }
+  }
+
 } // namespace casadi
 /// \endcond
 #undef CASADI_THROW_ERROR
@@ -48,16 +48,49 @@ namespace casadi {
             casadi_int m,
             const std::vector<casadi_int>& lookup_mode) :
           knots_(knots), offset_(offset), degree_(degree),
-          m_(m), lookup_mode_(lookup_mode) {
+          m_(m), lookup_mode_(lookup_mode), batch_x_(1) {
     prepare(m_, offset_, degree_, coeffs_size_, coeffs_dims_, strides_);
+    n_basis_ = get_n_basis(degree_);
+    casadi_int dummy_size;
+    std::vector<casadi_int> dummy_dims;
+    prepare(1, offset_, degree_, dummy_size, dummy_dims, basis_strides_);
+  }
+
+  void BSplineCommon::init_points(const MX& x, bool cache_basis) {
+    casadi_int n_dims = degree_.size();
+    casadi_assert(x.numel()==n_dims || x.size1()==n_dims,
+      "Expected x with " + str(n_dims) + " rows, got " + x.dim() + ".");
+    batch_x_ = x.numel()==n_dims ? 1 : x.size2();
+
+    // Coefficient updates only require a sparse product with the cached basis
+    if (cache_basis && x.is_constant()) {
+      std::vector<double> xv = densify(static_cast<DM>(x)).nonzeros();
+      std::vector<double> w(n_w(degree_));
+      std::vector<casadi_int> iw(n_iw(degree_));
+      basis_val_.resize(n_basis_*batch_x_);
+      basis_nz_.resize(n_basis_*batch_x_);
+      casadi_nd_boor_basis(get_ptr(basis_val_), get_ptr(basis_nz_), n_dims, get_ptr(knots_),
+        get_ptr(offset_), get_ptr(degree_), get_ptr(basis_strides_), get_ptr(xv),
+        get_ptr(lookup_mode_), batch_x_, n_basis_, get_ptr(iw), get_ptr(w));
+    }
   }
 
   size_t BSplineCommon::sz_iw() const {
-    return n_iw(degree_);
+    size_t sz = n_iw(degree_);
+    if (batch_x_>1 && basis_nz_.empty()) sz += n_basis_*batch_x_; // nz
+    return sz;
   }
 
   size_t BSplineCommon::sz_w() const {
-    return n_w(degree_);
+    size_t sz = n_w(degree_);
+    if (batch_x_>1 && basis_nz_.empty()) sz += n_basis_*batch_x_; // val
+    return sz;
+  }
+
+  casadi_int BSplineCommon::get_n_basis(const std::vector<casadi_int>& degree) {
+    casadi_int ret = 1;
+    for (casadi_int d : degree) ret *= d+1;
+    return ret;
   }
 
   size_t BSplineCommon::n_iw(const std::vector<casadi_int>& degree) {
@@ -116,8 +149,48 @@ namespace casadi {
     s.pack("BSpline::type", 'p');
   }
 
+  int BSplineCommon::
+  sp_forward(const bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const {
+    // Symbolic coefficients may reach every output
+    bvec_t c = 0;
+    if (n_dep()>1) {
+      for (casadi_int i=0; i<dep(1).nnz(); ++i) c |= arg[1][i];
+    }
+    // Point of each nonzero of x
+    std::vector<casadi_int> col = dep(0).sparsity().get_col();
+    std::fill_n(res[0], m_*batch_x_, c);
+    for (casadi_int i=0; i<col.size(); ++i) {
+      casadi_int k = batch_x_==1 ? 0 : col[i];
+      for (casadi_int j=0; j<m_; ++j) res[0][k*m_+j] |= arg[0][i];
+    }
+    return 0;
+  }
+
+  int BSplineCommon::
+  sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const {
+    // Seeds per point, cleared in res
+    std::vector<bvec_t> s(batch_x_, 0);
+    bvec_t c = 0;
+    for (casadi_int k=0; k<batch_x_; ++k) {
+      for (casadi_int j=0; j<m_; ++j) {
+        s[k] |= res[0][k*m_+j];
+        res[0][k*m_+j] = 0;
+      }
+      c |= s[k];
+    }
+    std::vector<casadi_int> col = dep(0).sparsity().get_col();
+    for (casadi_int i=0; i<col.size(); ++i) {
+      arg[0][i] |= s[batch_x_==1 ? 0 : col[i]];
+    }
+    if (n_dep()>1) {
+      for (casadi_int i=0; i<dep(1).nnz(); ++i) arg[1][i] |= c;
+    }
+    return 0;
+  }
+
   void BSplineCommon::serialize_body(SerializingStream& s) const {
     MXNode::serialize_body(s);
+    s.version("BSplineCommon", 2);
     s.pack("BSplineCommon::knots", knots_);
     s.pack("BSplineCommon::offset", offset_);
     s.pack("BSplineCommon::degree", degree_);
@@ -127,9 +200,13 @@ namespace casadi {
     s.pack("BSplineCommon::coeffs_dims", coeffs_dims_);
     s.pack("BSplineCommon::coeffs_size", coeffs_size_);
     s.pack("BSplineCommon::jac_cache_", jac_cache_);
+    s.pack("BSplineCommon::batch_x", batch_x_);
+    s.pack("BSplineCommon::basis_val", basis_val_);
+    s.pack("BSplineCommon::basis_nz", basis_nz_);
   }
 
   BSplineCommon::BSplineCommon(DeserializingStream& s) : MXNode(s) {
+    s.version("BSplineCommon", 2);
     s.unpack("BSplineCommon::knots", knots_);
     s.unpack("BSplineCommon::offset", offset_);
     s.unpack("BSplineCommon::degree", degree_);
@@ -139,6 +216,13 @@ namespace casadi {
     s.unpack("BSplineCommon::coeffs_dims", coeffs_dims_);
     s.unpack("BSplineCommon::coeffs_size", coeffs_size_);
     s.unpack("BSplineCommon::jac_cache_", jac_cache_);
+    s.unpack("BSplineCommon::batch_x", batch_x_);
+    s.unpack("BSplineCommon::basis_val", basis_val_);
+    s.unpack("BSplineCommon::basis_nz", basis_nz_);
+    n_basis_ = get_n_basis(degree_);
+    casadi_int dummy_size;
+    std::vector<casadi_int> dummy_dims;
+    prepare(1, offset_, degree_, dummy_size, dummy_dims, basis_strides_);
   }
 
   void BSpline::serialize_body(SerializingStream& s) const {
@@ -157,9 +241,9 @@ namespace casadi {
           casadi_int m,
           const std::vector<casadi_int>& lookup_mode) :
           BSplineCommon(knots, offset, degree, m, lookup_mode), coeffs_(coeffs) {
-    casadi_assert_dev(x.numel()==degree.size());
+    init_points(x, false);
     set_dep(x);
-    set_sparsity(Sparsity::dense(m, 1));
+    set_sparsity(Sparsity::dense(m, batch_x_));
   }
 
   BSplineParametric::BSplineParametric(const MX& x,
@@ -170,9 +254,9 @@ namespace casadi {
           casadi_int m,
           const std::vector<casadi_int>& lookup_mode) :
           BSplineCommon(knots, offset, degree, m, lookup_mode) {
-    casadi_assert_dev(x.numel()==degree.size());
+    init_points(x, true);
     set_dep(x, coeffs);
-    set_sparsity(Sparsity::dense(m, 1));
+    set_sparsity(Sparsity::dense(m, batch_x_));
   }
 
   MX BSpline::create(const MX& x, const std::vector< std::vector<double> >& knots,
@@ -225,7 +309,7 @@ namespace casadi {
   }
 
   void BSplineParametric::eval_mx(const std::vector<MX>& arg, std::vector<MX>& res) const {
-    res[0] = arg[0]->get_bspline(arg[0], knots_, offset_, degree_, m_, lookup_mode_);
+    res[0] = arg[0]->get_bspline(arg[1], knots_, offset_, degree_, m_, lookup_mode_);
   }
 
   MX BSpline::jac_cached() const {
@@ -246,36 +330,75 @@ namespace casadi {
                           std::vector<std::vector<MX> >& fsens) const {
     MX J = jac_cached();
 
+    if (batch_x_==1) {
+      for (casadi_int d=0; d<fsens.size(); ++d) {
+        fsens[d][0] = mtimes(J, fseed[d][0]);
+      }
+      return;
+    }
+
+    // Each point only depends on its own column of x
+    std::vector<MX> J_k = horzsplit(J, batch_x_);
     for (casadi_int d=0; d<fsens.size(); ++d) {
-      fsens[d][0] = mtimes(J, fseed[d][0]);
+      MX seed = reshape(fseed[d][0], J_k.size(), batch_x_);
+      fsens[d][0] = MX::zeros(size());
+      for (casadi_int k=0; k<J_k.size(); ++k) {
+        fsens[d][0] += J_k[k]*repmat(seed(k, Slice()), m_, 1);
+      }
     }
   }
 
   void BSplineCommon::ad_reverse(const std::vector<std::vector<MX> >& aseed,
                           std::vector<std::vector<MX> >& asens) const {
-    MX JT = jac_cached().T();
+    if (batch_x_==1) {
+      MX JT = jac_cached().T();
+      for (casadi_int d=0; d<aseed.size(); ++d) {
+        asens[d][0] += mtimes(JT, aseed[d][0]);
+      }
+      return;
+    }
+
+    // Each point only depends on its own column of x
+    std::vector<MX> J_k = horzsplit(jac_cached(), batch_x_);
     for (casadi_int d=0; d<aseed.size(); ++d) {
-      asens[d][0] += mtimes(JT, aseed[d][0]);
+      std::vector<MX> rows;
+      for (casadi_int k=0; k<J_k.size(); ++k) {
+        rows.push_back(sum1(J_k[k]*aseed[d][0]));
+      }
+      asens[d][0] += reshape(vertcat(rows), dep(0).size());
+    }
+  }
+
+  void BSplineCommon::eval_coeffs(const double* x, const double* c, double* r,
+                                  casadi_int* iw, double* w) const {
+    casadi_clear(r, m_*batch_x_);
+    if (!basis_nz_.empty()) {
+      // Cached basis
+      casadi_nd_boor_basis_eval(r, m_, get_ptr(basis_val_), get_ptr(basis_nz_), n_basis_,
+        c, batch_x_);
+    } else if (batch_x_==1) {
+      casadi_nd_boor_eval(r, degree_.size(), get_ptr(knots_), get_ptr(offset_),
+        get_ptr(degree_), get_ptr(strides_), c, m_, x, get_ptr(lookup_mode_), iw, w);
+    } else {
+      // Basis at all points first, then a sparse product with the coefficients
+      double* val = w; w += n_basis_*batch_x_;
+      casadi_int* nz = iw; iw += n_basis_*batch_x_;
+      casadi_nd_boor_basis(val, nz, degree_.size(), get_ptr(knots_), get_ptr(offset_),
+        get_ptr(degree_), get_ptr(basis_strides_), x, get_ptr(lookup_mode_), batch_x_,
+        n_basis_, iw, w);
+      casadi_nd_boor_basis_eval(r, m_, val, nz, n_basis_, c, batch_x_);
     }
   }
 
   int BSpline::eval(const double** arg, double** res, casadi_int* iw, double* w) const {
     if (!res[0]) return 0;
-
-    casadi_clear(res[0], m_);
-    casadi_nd_boor_eval(res[0], degree_.size(), get_ptr(knots_), get_ptr(offset_),
-      get_ptr(degree_), get_ptr(strides_), get_ptr(coeffs_), m_, arg[0], get_ptr(lookup_mode_),
-      iw, w);
+    eval_coeffs(arg[0], get_ptr(coeffs_), res[0], iw, w);
     return 0;
   }
 
   int BSplineParametric::eval(const double** arg, double** res, casadi_int* iw, double* w) const {
     if (!res[0]) return 0;
-
-    casadi_clear(res[0], m_);
-    casadi_nd_boor_eval(res[0], degree_.size(), get_ptr(knots_), get_ptr(offset_),
-      get_ptr(degree_), get_ptr(strides_), arg[1], m_, arg[0], get_ptr(lookup_mode_),
-      iw, w);
+    eval_coeffs(arg[0], arg[1], res[0], iw, w);
     return 0;
   }
 
@@ -283,16 +406,35 @@ namespace casadi {
                       const std::vector<casadi_int>& arg,
                       const std::vector<casadi_int>& res) const {
     casadi_int n_dims = offset_.size()-1;
+    casadi_int n_res = m_*batch_x_;
 
-    g.add_auxiliary(CodeGenerator::AUX_ND_BOOR_EVAL);
     g.add_auxiliary(CodeGenerator::AUX_FILL);
-    g << g.fill(g.work(res[0], m_), m_, "0.0") << "\n";
-
-    // Input and output buffers
-    g << "CASADI_PREFIX(nd_boor_eval)(" << g.work(res[0], m_) << "," << n_dims << ","
-      << g.constant(knots_) << "," << g.constant(offset_) << "," <<  g.constant(degree_)
-      << "," << g.constant(strides_) << "," << generate(g, arg) << "," << m_  << ","
-      << g.work(arg[0], n_dims) << "," <<  g.constant(lookup_mode_) << ", iw, w);\n";
+    g << g.fill(g.work(res[0], n_res), n_res, "0.0") << "\n";
+
+    if (!basis_nz_.empty()) {
+      // Cached basis
+      g.add_auxiliary(CodeGenerator::AUX_ND_BOOR_BASIS);
+      g << "casadi_nd_boor_basis_eval(" << g.work(res[0], n_res) << "," << m_ << ","
+        << g.constant(basis_val_) << "," << g.constant(basis_nz_) << "," << n_basis_ << ","
+        << generate(g, arg) << "," << batch_x_ << ");\n";
+    } else if (batch_x_==1) {
+      g.add_auxiliary(CodeGenerator::AUX_ND_BOOR_EVAL);
+      // Input and output buffers
+      g << "CASADI_PREFIX(nd_boor_eval)(" << g.work(res[0], m_) << "," << n_dims << ","
+        << g.constant(knots_) << "," << g.constant(offset_) << "," <<  g.constant(degree_)
+        << "," << g.constant(strides_) << "," << generate(g, arg) << "," << m_  << ","
+        << g.work(arg[0], n_dims) << "," <<  g.constant(lookup_mode_) << ", iw, w);\n";
+    } else {
+      g.add_auxiliary(CodeGenerator::AUX_ND_BOOR_BASIS);
+      casadi_int sz = n_basis_*batch_x_;
+      g << "casadi_nd_boor_basis(w, iw, " << n_dims << ","
+        << g.constant(knots_) << "," << g.constant(offset_) << "," << g.constant(degree_)
+        << "," << g.constant(basis_strides_) << "," << g.work(arg[0], n_dims*batch_x_) << ","
+        << g.constant(lookup_mode_) << "," << batch_x_ << "," << n_basis_ << ", iw+" << sz
+        << ", w+" << sz << ");\n";
+      g << "casadi_nd_boor_basis_eval(" << g.work(res[0], n_res) << "," << m_
+        << ", w, iw, " << n_basis_ << "," << generate(g, arg) << "," << batch_x_ << ");\n";
+    }
   }
 
   std::string BSpline::generate(CodeGenerator& g, const std::vector<casadi_int>& arg) const {
@@ -68,6 +68,26 @@ namespace casadi {
     std::vector<casadi_int> coeffs_dims_;
     casadi_int coeffs_size_;
 
+    // Number of points evaluated at once (columns of x)
+    casadi_int batch_x_;
+
+    // Number of basis functions that are nonzero at a point
+    casadi_int n_basis_;
+
+    // Strides for a single output, as used by the basis routines
+    std::vector<casadi_int> basis_strides_;
+
+    // Basis values and coefficient indices, cached when x is constant
+    std::vector<double> basis_val_;
+    std::vector<casadi_int> basis_nz_;
+
+    /// Set batch_x_ from the shape of x and cache the basis if x is constant
+    void init_points(const MX& x, bool cache_basis);
+
+    /// Evaluate numerically for given coefficients
+    void eval_coeffs(const double* x, const double* c, double* r,
+                     casadi_int* iw, double* w) const;
+
     /** \brief Jacobian
      * 
      * Derivatives are computed by transforming the coefficient matrix
@@ -89,9 +109,18 @@ namespace casadi {
     /** \brief Get required length of w field */
     size_t sz_w() const override;
 
+    /** \brief Get number of basis functions that are nonzero at a point */
+    static casadi_int get_n_basis(const std::vector<casadi_int>& degree);
+
     /** \brief Get the operation */
     casadi_int op() const override { return OP_BSPLINE;}
 
+    /** \brief  Propagate sparsity forward, point k of x only reaches column k */
+    int sp_forward(const bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const override;
+
+    /** \brief  Propagate sparsity backwards */
+    int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const override;
+
     /** \brief Calculate forward mode directional derivatives */
     void ad_forward(const std::vector<std::vector<MX> >& fseed,
                          std::vector<std::vector<MX> >& fsens) const override;
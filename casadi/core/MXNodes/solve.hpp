@@ -89,6 +89,9 @@ namespace casadi {
                   const std::vector<casadi_int>& arg,
                   const std::vector<casadi_int>& res) const override;
 
+    /** \brief Get required length of iw field */
+    size_t sz_iw() const override;
+
     /** \brief Get required length of w field */
     size_t sz_w() const override;
 
@@ -241,9 +241,18 @@ namespace casadi {
     return 0;
   }
 
+  template<bool Tr>
+  size_t Solve<Tr>::sz_iw() const {
+    size_t sz_iw, sz_w;
+    linsol_->codegen_work(dep(0).size2(), sz_iw, sz_w);
+    return sz_iw;
+  }
+
   template<bool Tr>
   size_t Solve<Tr>::sz_w() const {
-    return sparsity().size1();
+    size_t sz_iw, sz_w;
+    linsol_->codegen_work(dep(0).size2(), sz_iw, sz_w);
+    return std::max(sz_w, static_cast<size_t>(sparsity().size1()));
   }
 
   template<bool Tr>
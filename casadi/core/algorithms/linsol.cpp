@@ -75,10 +75,10 @@ namespace casadi {
       "Linsol::solve: Dimension mismatch. A and b must have matching row count. "
       "Got " + A.dim() + " and " + B.dim() + ".");
 
-    // Symbolic factorization
-    if (sfact(A.ptr())) casadi_error("Linsol::solve: 'sfact' failed");
+    if (A.sparsity()!=sparsity()) return solve(project(A, sparsity()), B, tr);
 
-    // Numeric factorization
+    // Numeric factorization. A has been projected to the fixed pattern of the
+    // instance, so the symbolic factorization of an earlier call is reused
     if (nfact(A.ptr())) casadi_error("Linsol::solve: 'nfact' failed");
 
     // Solve
@@ -120,7 +120,9 @@ namespace casadi {
     if (A==nullptr) return 1;
     auto m = static_cast<LinsolMemory*>((*this)->memory(mem));
 
-    // Perform pivoting, if required
+    // Perform pivoting, if required. The pattern never changes, so an existing
+    // symbolic factorization is kept. A plugin whose pivoting in sfact depends
+    // on the numerical values opts out by clearing is_sfact in its nfact
     if (!m->is_sfact) {
       if (sfact(A, mem)) return 1;
     }
@@ -26,10 +26,19 @@
 #include "rootfinder_impl.hpp"
 #include "mx_node.hpp"
 #include <iterator>
+#include <set>
 #include "linsol.hpp"
 
 #include "global_options.hpp"
 
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.thread.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <thread>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif // CASADI_WITH_THREAD
+
 using namespace std;
 namespace casadi {
 
@@ -151,6 +160,14 @@ namespace casadi {
     iin_ = 0;
     iout_ = 0;
     error_on_fail_ = true;
+    blt_ = false;
+    blt_parallel_ = true;
+    blt_max_iter_ = 50;
+    blt_abstol_ = 1e-12;
+    blt_abstol_step_ = 1e-12;
+    blt_jac_reuse_ = 0;
+    blt_theta_max_ = 0.5;
+    blt_broyden_max_ = 0;
   }
 
   Rootfinder::~Rootfinder() {
@@ -179,7 +196,38 @@ namespace casadi {
         "Function object for calculating the Jacobian (autogenerated by default)"}},
       {"error_on_fail",
        {OT_BOOL,
-        "When the numerical process returns unsuccessfully, raise an error (default false)."}}
+        "When the numerical process returns unsuccessfully, raise an error (default false)."}},
+      {"blt",
+       {OT_BOOL,
+        "Bring the Jacobian to block-triangular form and solve the diagonal blocks "
+        "in sequence, each with a small Newton iteration, instead of calling the plugin "
+        "on the full system (default false)."}},
+      {"blt_parallel",
+       {OT_BOOL,
+        "Evaluate the independent blocks of a level concurrently, with max_concurrent "
+        "threads, one per block up to the hardware concurrency if not set. Requires an "
+        "SX oracle and CasADi compiled with WITH_THREAD=ON (default true)."}},
+      {"blt_max_iter",
+       {OT_INT,
+        "Maximum number of Newton iterations per block (default 50)."}},
+      {"blt_abstol",
+       {OT_DOUBLE,
+        "Stopping criterion on the block residual, infinity norm (default 1e-12)."}},
+      {"blt_abstol_step",
+       {OT_DOUBLE,
+        "Stopping criterion on the block step size, infinity norm (default 1e-12)."}},
+      {"blt_jac_reuse",
+       {OT_INT,
+        "Reuse the factorized block Jacobian: 0 refactorize every iteration, "
+        "1 within a solve while the step contracts (default 0)."}},
+      {"blt_theta_max",
+       {OT_DOUBLE,
+        "With blt_jac_reuse, refactorize when the step contraction rate exceeds this "
+        "value (default 0.5)."}},
+      {"blt_broyden_max",
+       {OT_INT,
+        "With blt_jac_reuse, maximum number of Broyden updates of a block "
+        "factorization (default 0)."}}
      }
   };
 
@@ -206,6 +254,22 @@ namespace casadi {
         u_c_ = op.second;
       } else if (op.first=="error_on_fail") {
         error_on_fail_ = op.second;
+      } else if (op.first=="blt") {
+        blt_ = op.second;
+      } else if (op.first=="blt_parallel") {
+        blt_parallel_ = op.second;
+      } else if (op.first=="blt_max_iter") {
+        blt_max_iter_ = op.second;
+      } else if (op.first=="blt_abstol") {
+        blt_abstol_ = op.second;
+      } else if (op.first=="blt_abstol_step") {
+        blt_abstol_step_ = op.second;
+      } else if (op.first=="blt_jac_reuse") {
+        blt_jac_reuse_ = op.second;
+      } else if (op.first=="blt_theta_max") {
+        blt_theta_max_ = op.second;
+      } else if (op.first=="blt_broyden_max") {
+        blt_broyden_max_ = op.second;
       }
     }
 
@@ -246,6 +310,20 @@ namespace casadi {
       "Constraint vector if supplied, must be of length n, but got "
       + str(u_c_.size()) + " and n = " + str(n_));
 
+    // Block-triangular decomposition
+    if (blt_) {
+      casadi_assert(u_c_.empty(), "Option 'constraints' is not supported with 'blt'");
+      // Reuse across solves would need a persistent factorization per block
+      casadi_assert(blt_jac_reuse_==0 || blt_jac_reuse_==1,
+        "Option 'blt_jac_reuse' must be 0 or 1");
+      casadi_assert(blt_broyden_max_>=0, "Option 'blt_broyden_max' must be nonnegative");
+      if (oracle_.is_a("SXFunction")) {
+        init_blt<SX>();
+      } else {
+        init_blt<MX>();
+      }
+    }
+
     // Allocate sufficiently large work vectors
     alloc(oracle_);
     size_t sz_w = oracle_.sz_w();
@@ -253,6 +331,122 @@ namespace casadi {
       sz_w = max(sz_w, jac.sz_w());
     }
     alloc_w(sz_w + 2*static_cast<size_t>(n_));
+    if (blt_) {
+      // Unknowns and Newton memory follow the work of the block evaluations
+      alloc_w(max_concurrent_*call_sz_w_ + n_ + max(blt_sz_w_, oracle_.sz_w()));
+    }
+  }
+
+  template<typename M>
+  void Rootfinder::init_blt() {
+    // Block-triangular form of the Jacobian
+    vector<casadi_int> rowblock, colblock, coarse_rowblock, coarse_colblock;
+    casadi_int nb = sp_jac_.btf(blt_rowperm_, blt_colperm_, rowblock, colblock,
+                                coarse_rowblock, coarse_colblock);
+    casadi_assert_dev(rowblock==colblock);
+    blt_offset_ = colblock;
+
+    // Block of each equation and unknown
+    vector<casadi_int> eq_block(n_), var_block(n_);
+    for (casadi_int k=0; k<nb; ++k) {
+      for (casadi_int i=blt_offset_[k]; i<blt_offset_[k+1]; ++i) {
+        eq_block[blt_rowperm_[i]] = k;
+        var_block[blt_colperm_[i]] = k;
+      }
+    }
+
+    // Dependencies between the blocks through off-diagonal Jacobian entries
+    const casadi_int *colind = sp_jac_.colind(), *row = sp_jac_.row();
+    vector<vector<casadi_int> > dependents(nb);
+    vector<casadi_int> ndep(nb, 0);
+    for (casadi_int c=0; c<n_; ++c) {
+      for (casadi_int el=colind[c]; el<colind[c+1]; ++el) {
+        casadi_int kr = eq_block[row[el]], kc = var_block[c];
+        if (kr!=kc) {
+          dependents[kc].push_back(kr);
+          ndep[kr]++;
+        }
+      }
+    }
+
+    // Group the blocks into levels (topological sort)
+    blt_order_.clear();
+    blt_level_ = {0};
+    for (casadi_int k=0; k<nb; ++k) if (ndep[k]==0) blt_order_.push_back(k);
+    for (casadi_int begin=0; begin<blt_order_.size(); ) {
+      casadi_int end = blt_order_.size();
+      blt_level_.push_back(end);
+      for (casadi_int i=begin; i<end; ++i) {
+        for (casadi_int kr : dependents[blt_order_[i]]) {
+          if (--ndep[kr]==0) blt_order_.push_back(kr);
+        }
+      }
+      begin = end;
+    }
+    casadi_assert_dev(blt_order_.size()==nb);
+
+    // Number of concurrent block evaluations
+#ifdef CASADI_WITH_THREAD
+    // MX block functions may share the memory of embedded function calls
+    if (blt_parallel_ && is_same<M, SX>::value) {
+      if (max_concurrent_==1) {
+        casadi_int width = 0;
+        for (casadi_int l=0; l+1<blt_level_.size(); ++l) {
+          width = max(width, blt_level_[l+1]-blt_level_[l]);
+        }
+        casadi_int nthread = thread::hardware_concurrency();
+        max_concurrent_ = max(casadi_int(1), min(width, nthread));
+      }
+    } else {
+      max_concurrent_ = 1;
+    }
+#else // CASADI_WITH_THREAD
+    max_concurrent_ = 1;
+#endif // CASADI_WITH_THREAD
+
+    // Residual and Jacobian of each block, with respect to the block unknowns.
+    // The oracle is inlined, so that each block function only contains the
+    // operations its residual depends on
+    vector<M> arg = M::get_input(oracle_), res;
+    oracle_.call(arg, res, true);
+    M g = res.at(iout_), x = arg.at(iin_);
+    blt_fcn_.resize(nb);
+    blt_sp_v_.resize(nb);
+    blt_sp_r_.resize(nb);
+    blt_prinv_.resize(nb);
+    blt_pc_.resize(nb);
+    // Newton memory of each block
+    vector<size_t> sz_w(nb);
+    for (casadi_int k=0; k<nb; ++k) {
+      vector<casadi_int> rows(blt_rowperm_.begin()+blt_offset_[k],
+                              blt_rowperm_.begin()+blt_offset_[k+1]);
+      vector<casadi_int> cols(blt_colperm_.begin()+blt_offset_[k],
+                              blt_colperm_.begin()+blt_offset_[k+1]);
+      M g_k = g(IM(rows));
+      M J_k = jacobian(g_k, x)(Slice(), IM(cols));
+      blt_fcn_[k] = Function(name_ + "_blt_" + str(k), arg, {g_k, J_k},
+                             oracle_.name_in(), {"g", "jac_g_x"});
+      J_k.sparsity().qr_sparse(blt_sp_v_[k], blt_sp_r_[k], blt_prinv_[k], blt_pc_[k]);
+      // Evaluated with calc_functions
+      set_function(blt_fcn_[k]);
+      size_t nk = rows.size();
+      sz_w[k] = 3*nk + J_k.nnz() + blt_sp_v_[k].nnz() + blt_sp_r_[k].nnz()
+                + max(static_cast<size_t>(blt_sp_v_[k].size1()), nk)
+                + (blt_broyden_max_>0 ? 2*nk*(blt_broyden_max_+1) : 0);
+    }
+
+    // The blocks of a level are iterated together
+    blt_sz_w_ = 0;
+    for (casadi_int l=0; l+1<blt_level_.size(); ++l) {
+      size_t sz_w_l = 0;
+      for (casadi_int i=blt_level_[l]; i<blt_level_[l+1]; ++i) sz_w_l += sz_w[blt_order_[i]];
+      blt_sz_w_ = max(blt_sz_w_, sz_w_l);
+    }
+
+    if (verbose_) {
+      casadi_message("Rootfinder BLT: " + str(nb) + " blocks in "
+                     + str(blt_level_.size()-1) + " levels");
+    }
   }
 
   int Rootfinder::init_mem(void* mem) const {
@@ -273,7 +467,7 @@ namespace casadi {
     setup(mem, arg, res, iw, w);
 
     // Solve the NLP
-    int ret = solve(mem);
+    int ret = blt_ ? solve_blt(mem) : solve(mem);
     auto m = static_cast<RootfinderMemory*>(mem);
     if (error_on_fail_ && !m->success)
       casadi_error("rootfinder process failed. "
@@ -282,6 +476,176 @@ namespace casadi {
     return ret;
   }
 
+  int Rootfinder::solve_blt(void* mem) const {
+    auto m = static_cast<RootfinderMemory*>(mem);
+
+    // Unknowns, initialized with the guess, after the work of the block evaluations
+    double* x = m->w + max_concurrent_*call_sz_w_;
+    casadi_copy(m->iarg[iin_], n_, x);
+
+    // Inputs of the block functions
+    vector<const double*> arg(m->iarg, m->iarg+n_in_);
+    arg[iin_] = x;
+
+    // Solve the blocks level by level, blocks in a level are independent
+    bool success = true;
+    vector<casadi_newton_mem<double> > nm;
+    vector<casadi_int> active;
+    vector<OracleCall> calls;
+    for (casadi_int l=0; success && l+1<blt_level_.size(); ++l) {
+      casadi_int begin = blt_level_[l], end = blt_level_[l+1];
+      nm.resize(end-begin);
+      double* w = x + n_;
+      for (casadi_int i=begin; i<end; ++i) {
+        w = blt_newton_init(blt_order_[i], nm[i-begin], x, w);
+      }
+      active.resize(end-begin);
+      for (casadi_int i=0; i<active.size(); ++i) active[i] = i;
+
+      // Newton iterations, the blocks that have not converged are evaluated together
+      for (casadi_int iter=0; !active.empty(); ++iter) {
+        if (iter==blt_max_iter_) {
+          success = false;
+          break;
+        }
+
+        // Residuals, Jacobians only of the blocks that are refactorized
+        calls.resize(active.size());
+        for (casadi_int j=0; j<active.size(); ++j) {
+          casadi_newton_mem<double>& M = nm[active[j]];
+          calls[j].fcn = blt_fcn_[blt_order_[begin+active[j]]].name();
+          calls[j].arg = arg;
+          calls[j].res = {M.g, M.refresh ? M.jac_g_x : nullptr};
+        }
+        if (calc_functions(m, calls)) {
+          success = false;
+          break;
+        }
+
+        // Newton steps, keep the blocks that have not converged
+        casadi_int nactive = 0;
+        for (casadi_int i : active) {
+          casadi_newton_mem<double>& M = nm[i];
+          casadi_int k = blt_order_[begin+i];
+          const casadi_int* cols = get_ptr(blt_colperm_) + blt_offset_[k];
+          int flag = casadi_newton(&M);
+          for (casadi_int j=0; j<M.n; ++j) x[cols[j]] = M.x[j];
+          if (!flag) active[nactive++] = i;
+        }
+        active.resize(nactive);
+      }
+    }
+
+    // Get the solution
+    if (m->ires[iout_]) casadi_copy(x, n_, m->ires[iout_]);
+
+    // Evaluate auxiliary outputs
+    if (n_out_>1) {
+      copy(arg.begin(), arg.end(), m->arg);
+      double** res1 = m->res;
+      copy(m->ires, m->ires+n_out_, res1);
+      res1[iout_] = nullptr;
+      if (oracle_(m->arg, res1, m->iw, x + n_)) success = false;
+    }
+
+    m->success = success;
+    m->unified_return_status = success ? SOLVER_RET_SUCCESS : SOLVER_RET_LIMITED;
+    return 0;
+  }
+
+  double* Rootfinder::blt_newton_init(casadi_int k, casadi_newton_mem<double>& M,
+                                      const double* x, double* w) const {
+    const Function& f = blt_fcn_[k];
+    casadi_int nk = blt_offset_[k+1] - blt_offset_[k];
+    const casadi_int* cols = get_ptr(blt_colperm_) + blt_offset_[k];
+    const Sparsity &sp_v = blt_sp_v_[k], &sp_r = blt_sp_r_[k];
+
+    // Newton memory, working on a contiguous copy of the block unknowns
+    casadi_newton_init(&M);
+    M.n = nk;
+    M.abstol = blt_abstol_;
+    M.abstol_step = blt_abstol_step_;
+    M.x = w; w += nk;
+    M.g = w; w += nk;
+    M.jac_g_x = w; w += f.nnz_out(1);
+    M.sp_a = f.sparsity_out(1);
+    M.sp_v = sp_v;
+    M.sp_r = sp_r;
+    M.prinv = get_ptr(blt_prinv_[k]);
+    M.pc = get_ptr(blt_pc_[k]);
+    M.lin_v = w; w += sp_v.nnz();
+    M.lin_r = w; w += sp_r.nnz();
+    M.lin_beta = w; w += nk;
+    M.lin_w = w; w += max(sp_v.size1(), nk);
+    M.jac_reuse = blt_jac_reuse_;
+    M.theta_max = blt_theta_max_;
+    M.broyden_max = blt_broyden_max_;
+    if (blt_broyden_max_>0) {
+      M.g_prev = w; w += nk;
+      M.s_prev = w; w += nk;
+      M.broyden_u = w; w += nk*blt_broyden_max_;
+      M.broyden_s = w; w += nk*blt_broyden_max_;
+    }
+    casadi_newton_reset(&M);
+    for (casadi_int i=0; i<nk; ++i) M.x[i] = x[cols[i]];
+    return w;
+  }
+
+  MX Rootfinder::blt_solve(const MX& J, const MX& B, bool tr) const {
+    casadi_int nb = blt_offset_.size()-1;
+
+    // Equations and unknowns of each block
+    vector<IM> rows(nb), cols(nb);
+    vector<casadi_int> eq_block(n_), var_block(n_);
+    for (casadi_int k=0; k<nb; ++k) {
+      vector<casadi_int> r(blt_rowperm_.begin()+blt_offset_[k],
+                           blt_rowperm_.begin()+blt_offset_[k+1]);
+      vector<casadi_int> c(blt_colperm_.begin()+blt_offset_[k],
+                           blt_colperm_.begin()+blt_offset_[k+1]);
+      for (casadi_int i : r) eq_block[i] = k;
+      for (casadi_int i : c) var_block[i] = k;
+      rows[k] = IM(r);
+      cols[k] = IM(c);
+    }
+
+    // Off-diagonal coupling: equations of block kr depend on unknowns of block kc
+    vector<set<casadi_int> > deps(nb), dependents(nb);
+    const casadi_int *colind = sp_jac_.colind(), *row = sp_jac_.row();
+    for (casadi_int c=0; c<n_; ++c) {
+      for (casadi_int el=colind[c]; el<colind[c+1]; ++el) {
+        casadi_int kr = eq_block[row[el]], kc = var_block[c];
+        if (kr!=kc) {
+          deps[kr].insert(kc);
+          dependents[kc].insert(kr);
+        }
+      }
+    }
+
+    // Block substitution, only the diagonal blocks are factorized
+    vector<MX> xb(nb);
+    string lsolver = linsol_.plugin_name();
+    if (!tr) {
+      for (casadi_int k : blt_order_) {
+        MX r = B(rows[k], Slice());
+        for (casadi_int j : deps[k]) r -= mtimes(J(rows[k], cols[j]), xb[j]);
+        xb[k] = MX::solve(J(rows[k], cols[k]), r, lsolver);
+      }
+    } else {
+      for (auto it=blt_order_.rbegin(); it!=blt_order_.rend(); ++it) {
+        casadi_int k = *it;
+        MX r = B(cols[k], Slice());
+        for (casadi_int j : dependents[k]) r -= mtimes(J(rows[j], cols[k]).T(), xb[j]);
+        xb[k] = MX::solve(J(rows[k], cols[k]).T(), r, lsolver);
+      }
+    }
+
+    // Undo the permutation
+    const vector<casadi_int>& perm = tr ? blt_rowperm_ : blt_colperm_;
+    vector<casadi_int> iperm(n_);
+    for (casadi_int i=0; i<n_; ++i) iperm[perm[i]] = i;
+    return vertcat(xb)(IM(iperm), Slice());
+  }
+
   void Rootfinder::set_work(void* mem, const double**& arg, double**& res,
                         casadi_int*& iw, double*& w) const {
     auto m = static_cast<RootfinderMemory*>(mem);
@@ -454,7 +818,11 @@ namespace casadi {
     // Solve for all the forward derivatives at once
     vector<MX> rhs(nfwd);
     for (casadi_int d=0; d<nfwd; ++d) rhs[d] = vec(fsens[d][iout_]);
-    rhs = horzsplit(J->get_solve(-horzcat(rhs), false, linsol_));
+    if (blt_) {
+      rhs = horzsplit(blt_solve(J, -horzcat(rhs), false));
+    } else {
+      rhs = horzsplit(J->get_solve(-horzcat(rhs), false, linsol_));
+    }
     for (casadi_int d=0; d<nfwd; ++d) fsens[d][iout_] = reshape(rhs[d], size_in(iin_));
 
     // Propagate to auxiliary outputs
@@ -505,7 +873,11 @@ namespace casadi {
     }
 
     // Solve for all the adjoint seeds at once
-    rhs = horzsplit(J->get_solve(-horzcat(rhs), true, linsol_));
+    if (blt_) {
+      rhs = horzsplit(blt_solve(J, -horzcat(rhs), true));
+    } else {
+      rhs = horzsplit(J->get_solve(-horzcat(rhs), true, linsol_));
+    }
     for (casadi_int d=0; d<nadj; ++d) {
       for (casadi_int i=0; i<n_out_; ++i) {
         if (i==iout_) {
@@ -551,7 +923,7 @@ namespace casadi {
   void Rootfinder::serialize_body(SerializingStream &s) const {
     OracleFunction::serialize_body(s);
 
-    s.version("Rootfinder", 1);
+    s.version("Rootfinder", 2);
     s.pack("Rootfinder::n", n_);
     s.pack("Rootfinder::linsol", linsol_);
     s.pack("Rootfinder::sp_jac", sp_jac_);
@@ -559,6 +931,27 @@ namespace casadi {
     s.pack("Rootfinder::iin", iin_);
     s.pack("Rootfinder::iout", iout_);
     s.pack("Rootfinder::error_on_fail", error_on_fail_);
+    s.pack("Rootfinder::blt", blt_);
+    if (blt_) {
+      s.pack("Rootfinder::blt_parallel", blt_parallel_);
+      s.pack("Rootfinder::blt_max_iter", blt_max_iter_);
+      s.pack("Rootfinder::blt_abstol", blt_abstol_);
+      s.pack("Rootfinder::blt_abstol_step", blt_abstol_step_);
+      s.pack("Rootfinder::blt_jac_reuse", blt_jac_reuse_);
+      s.pack("Rootfinder::blt_theta_max", blt_theta_max_);
+      s.pack("Rootfinder::blt_broyden_max", blt_broyden_max_);
+      s.pack("Rootfinder::blt_rowperm", blt_rowperm_);
+      s.pack("Rootfinder::blt_colperm", blt_colperm_);
+      s.pack("Rootfinder::blt_offset", blt_offset_);
+      s.pack("Rootfinder::blt_order", blt_order_);
+      s.pack("Rootfinder::blt_level", blt_level_);
+      s.pack("Rootfinder::blt_fcn", blt_fcn_);
+      s.pack("Rootfinder::blt_sp_v", blt_sp_v_);
+      s.pack("Rootfinder::blt_sp_r", blt_sp_r_);
+      s.pack("Rootfinder::blt_prinv", blt_prinv_);
+      s.pack("Rootfinder::blt_pc", blt_pc_);
+      s.pack("Rootfinder::blt_sz_w", blt_sz_w_);
+    }
   }
 
   void Rootfinder::serialize_type(SerializingStream &s) const {
@@ -571,7 +964,7 @@ namespace casadi {
   }
 
   Rootfinder::Rootfinder(DeserializingStream & s) : OracleFunction(s) {
-    s.version("Rootfinder", 1);
+    s.version("Rootfinder", 2);
     s.unpack("Rootfinder::n", n_);
     s.unpack("Rootfinder::linsol", linsol_);
     s.unpack("Rootfinder::sp_jac", sp_jac_);
@@ -579,6 +972,27 @@ namespace casadi {
     s.unpack("Rootfinder::iin", iin_);
     s.unpack("Rootfinder::iout", iout_);
     s.unpack("Rootfinder::error_on_fail", error_on_fail_);
+    s.unpack("Rootfinder::blt", blt_);
+    if (blt_) {
+      s.unpack("Rootfinder::blt_parallel", blt_parallel_);
+      s.unpack("Rootfinder::blt_max_iter", blt_max_iter_);
+      s.unpack("Rootfinder::blt_abstol", blt_abstol_);
+      s.unpack("Rootfinder::blt_abstol_step", blt_abstol_step_);
+      s.unpack("Rootfinder::blt_jac_reuse", blt_jac_reuse_);
+      s.unpack("Rootfinder::blt_theta_max", blt_theta_max_);
+      s.unpack("Rootfinder::blt_broyden_max", blt_broyden_max_);
+      s.unpack("Rootfinder::blt_rowperm", blt_rowperm_);
+      s.unpack("Rootfinder::blt_colperm", blt_colperm_);
+      s.unpack("Rootfinder::blt_offset", blt_offset_);
+      s.unpack("Rootfinder::blt_order", blt_order_);
+      s.unpack("Rootfinder::blt_level", blt_level_);
+      s.unpack("Rootfinder::blt_fcn", blt_fcn_);
+      s.unpack("Rootfinder::blt_sp_v", blt_sp_v_);
+      s.unpack("Rootfinder::blt_sp_r", blt_sp_r_);
+      s.unpack("Rootfinder::blt_prinv", blt_prinv_);
+      s.unpack("Rootfinder::blt_pc", blt_pc_);
+      s.unpack("Rootfinder::blt_sz_w", blt_sz_w_);
+    }
   }
 
 } // namespace casadi
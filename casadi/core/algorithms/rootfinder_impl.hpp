@@ -101,6 +101,16 @@ namespace casadi {
     // Solve the NLP
     virtual int solve(void* mem) const = 0;
 
+    /// Solve block by block, using the block-triangular form of the Jacobian
+    int solve_blt(void* mem) const;
+
+    /// Newton memory for one diagonal block, returns the remaining work
+    double* blt_newton_init(casadi_int k, casadi_newton_mem<double>& M,
+                            const double* x, double* w) const;
+
+    /// Solve J*X = B (J'*X = B if tr) by substitution over the diagonal blocks
+    MX blt_solve(const MX& J, const MX& B, bool tr) const;
+
     /// Get all statistics
     Dict get_stats(void* mem) const override;
 
@@ -166,6 +176,28 @@ namespace casadi {
     /// Throw an exception on failure?
     bool error_on_fail_;
 
+    ///@{
+    /// Block-triangular decomposition of the Jacobian
+    bool blt_, blt_parallel_;
+    casadi_int blt_max_iter_, blt_jac_reuse_, blt_broyden_max_;
+    double blt_abstol_, blt_abstol_step_, blt_theta_max_;
+    // Permuted equations and unknowns, offsets of the diagonal blocks
+    std::vector<casadi_int> blt_rowperm_, blt_colperm_, blt_offset_;
+    // Blocks grouped into levels, blocks in the same level are independent
+    std::vector<casadi_int> blt_order_, blt_level_;
+    // Residual and Jacobian of each block
+    std::vector<Function> blt_fcn_;
+    // Symbolic QR factorization of each block Jacobian
+    std::vector<Sparsity> blt_sp_v_, blt_sp_r_;
+    std::vector<std::vector<casadi_int> > blt_prinv_, blt_pc_;
+    // Newton memory of the blocks in a level
+    size_t blt_sz_w_;
+    ///@}
+
+    /// Construct the block functions
+    template<typename M>
+    void init_blt();
+
     // Creator function for internal class
     typedef Rootfinder* (*Creator)(const std::string& name, const Function& oracle);
 
@@ -126,6 +126,8 @@ namespace casadi {
     casadi_int* sz_iw, casadi_int* sz_w);
   typedef int (*eval_t)(const double** arg, double** res,
                         casadi_int* iw, double* w, void* mem);
+  typedef int (*eval_batch_t)(casadi_int n, const double** arg, double** res,
+                              casadi_int* iw, double* w, void* mem);
   ///@}
 
   /// String representation, any type
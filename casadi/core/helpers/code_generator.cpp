@@ -44,6 +44,7 @@ namespace casadi {
     this->codegen_scalars = false;
     this->with_header = false;
     this->with_mem = false;
+    this->with_eval_batch = false;
     this->with_export = true;
     this->with_import = false;
     this->include_math = true;
@@ -76,6 +77,8 @@ namespace casadi {
         this->with_header = e.second;
       } else if (e.first=="with_mem") {
         this->with_mem = e.second;
+      } else if (e.first=="with_eval_batch") {
+        this->with_eval_batch = e.second;
       } else if (e.first=="with_export") {
         this->with_export = e.second;
       } else if (e.first=="with_import") {
@@ -205,6 +208,33 @@ namespace casadi {
           << "return " << codegen_name <<  "(arg, res, iw, w, mem);\n"
           << "}\n\n";
 
+    // Evaluate n instances, input/output k of instance i at arg[k]/res[k] + i*nnz
+    if (this->with_eval_batch) {
+      *this << declare("int " + f.name() + "_eval_batch(casadi_int n, const casadi_real** arg, "
+                       "casadi_real** res, casadi_int* iw, casadi_real* w, void* mem)") << " {\n"
+            << "casadi_int i;\n"
+            << "int flag = 0;\n"
+            << "for (i=0; i<n; ++i) {\n"
+            << "flag = " << codegen_name << "(arg, res, iw, w, mem);\n"
+            << "if (flag) break;\n";
+      for (casadi_int k=0; k<f.n_in(); ++k) {
+        *this << "if (arg[" << k << "]) arg[" << k << "] += " << f.nnz_in(k) << ";\n";
+      }
+      for (casadi_int k=0; k<f.n_out(); ++k) {
+        *this << "if (res[" << k << "]) res[" << k << "] += " << f.nnz_out(k) << ";\n";
+      }
+      *this << "}\n";
+      // Restore the pointers
+      for (casadi_int k=0; k<f.n_in(); ++k) {
+        *this << "if (arg[" << k << "]) arg[" << k << "] -= i*" << f.nnz_in(k) << ";\n";
+      }
+      for (casadi_int k=0; k<f.n_out(); ++k) {
+        *this << "if (res[" << k << "]) res[" << k << "] -= i*" << f.nnz_out(k) << ";\n";
+      }
+      *this << "return flag;\n"
+            << "}\n\n";
+    }
+
     // Generate meta information
     f->codegen_meta(*this);
 
@@ -735,6 +765,13 @@ namespace casadi {
       add_auxiliary(AUX_CLEAR, {"casadi_int"});
       this->auxiliaries << sanitize_source(casadi_interpn_str, inst);
       break;
+    case AUX_INTERPN_BATCH:
+      add_auxiliary(AUX_LOW);
+      add_auxiliary(AUX_FLIP, {});
+      add_auxiliary(AUX_CLEAR);
+      add_auxiliary(AUX_CLEAR, {"casadi_int"});
+      this->auxiliaries << sanitize_source(casadi_interpn_batch_str, inst);
+      break;
     case AUX_INTERPN_GRAD:
       add_auxiliary(AUX_INTERPN);
       this->auxiliaries << sanitize_source(casadi_interpn_grad_str, inst);
@@ -751,6 +788,19 @@ namespace casadi {
       add_auxiliary(AUX_LOW);
       this->auxiliaries << sanitize_source(casadi_nd_boor_eval_str, inst);
       break;
+    case AUX_ND_BOOR_DUAL_EVAL:
+      add_auxiliary(AUX_DE_BOOR);
+      add_auxiliary(AUX_FILL);
+      add_auxiliary(AUX_CLEAR);
+      add_auxiliary(AUX_CLEAR, {"casadi_int"});
+      add_auxiliary(AUX_LOW);
+      this->auxiliaries << sanitize_source(casadi_nd_boor_dual_eval_str, inst);
+      break;
+    case AUX_ND_BOOR_BASIS:
+      add_auxiliary(AUX_ND_BOOR_DUAL_EVAL);
+      add_auxiliary(AUX_CLEAR);
+      this->auxiliaries << sanitize_source(casadi_nd_boor_basis_str, inst);
+      break;
     case AUX_FLIP:
       this->auxiliaries << sanitize_source(casadi_flip_str, inst);
       break;
@@ -845,6 +895,27 @@ namespace casadi {
       add_auxiliary(AUX_SIGN);
       this->auxiliaries << sanitize_source(casadi_lsqr_str, inst);
       break;
+    case AUX_KRYLOV:
+      add_auxiliary(AUX_COPY);
+      add_auxiliary(AUX_CLEAR);
+      add_auxiliary(AUX_SCAL);
+      add_auxiliary(AUX_AXPY);
+      add_auxiliary(AUX_DOT);
+      add_auxiliary(AUX_NORM_2);
+      add_auxiliary(AUX_MV);
+      add_auxiliary(AUX_FABS);
+      add_include("math.h");
+      this->auxiliaries << sanitize_source(casadi_krylov_str, inst);
+      break;
+    case AUX_EXPM:
+      add_auxiliary(AUX_COPY);
+      add_auxiliary(AUX_CLEAR);
+      add_auxiliary(AUX_SCAL);
+      add_auxiliary(AUX_AXPY);
+      add_auxiliary(AUX_FABS);
+      add_include("math.h");
+      this->auxiliaries << sanitize_source(casadi_expm_str, inst);
+      break;
     case AUX_QP:
       add_auxiliary(AUX_COPY);
       add_auxiliary(AUX_QR);
@@ -864,20 +935,62 @@ namespace casadi {
 
       this->auxiliaries << sanitize_source(casadi_qp_str, inst);
       break;
+    case AUX_IPQP:
+      add_auxiliary(AUX_COPY);
+      add_auxiliary(AUX_QR);
+      add_auxiliary(AUX_FMIN);
+      add_auxiliary(AUX_FMAX);
+      add_auxiliary(AUX_TRANS);
+      add_auxiliary(AUX_AXPY);
+      add_auxiliary(AUX_DOT);
+      add_auxiliary(AUX_MV);
+      add_auxiliary(AUX_BILIN);
+      add_auxiliary(AUX_INF);
+      add_auxiliary(AUX_MAX);
+      add_auxiliary(AUX_CLEAR);
+      add_include("stdio.h");
+      add_include("math.h");
+
+      this->auxiliaries << sanitize_source(casadi_ipqp_str, inst);
+      break;
     case AUX_NLP:
       this->auxiliaries << sanitize_source(casadi_nlp_str, inst);
       break;
     case AUX_SQPMETHOD:
       add_auxiliary(AUX_QP);
       add_auxiliary(AUX_NLP);
+      add_auxiliary(AUX_BFGS);
+      add_auxiliary(AUX_LBFGS);
       this->auxiliaries << sanitize_source(casadi_sqpmethod_str, inst);
       break;
+    case AUX_BFGS:
+      add_auxiliary(AUX_IF_ELSE);
+      add_auxiliary(AUX_COPY);
+      add_auxiliary(AUX_AXPY);
+      add_auxiliary(AUX_CLEAR);
+      add_auxiliary(AUX_MV);
+      add_auxiliary(AUX_DOT);
+      add_auxiliary(AUX_SCAL);
+      add_auxiliary(AUX_RANK1);
+      this->auxiliaries << sanitize_source(casadi_bfgs_str, inst);
+      break;
+    case AUX_LBFGS:
+      add_auxiliary(AUX_COPY);
+      add_auxiliary(AUX_AXPY);
+      add_auxiliary(AUX_CLEAR);
+      add_auxiliary(AUX_DOT);
+      add_auxiliary(AUX_SCAL);
+      add_auxiliary(AUX_FABS);
+      add_include("math.h");
+      this->auxiliaries << sanitize_source(casadi_lbfgs_str, inst);
+      break;
     case AUX_LDL:
       this->auxiliaries << sanitize_source(casadi_ldl_str, inst);
       break;
     case AUX_NEWTON:
       add_auxiliary(AUX_COPY);
       add_auxiliary(AUX_AXPY);
+      add_auxiliary(AUX_DOT);
       add_auxiliary(AUX_NORM_INF);
       add_auxiliary(AUX_QR);
       this->auxiliaries << sanitize_source(casadi_newton_str, inst);
@@ -1152,24 +1265,42 @@ namespace casadi {
   string CodeGenerator::interpn(const std::string& res, casadi_int ndim, const string& grid,
                                    const string& offset,
                                    const string& values, const string& x,
-                                   const string& lookup_mode, casadi_int m,
+                                   const string& lookup_mode, const string& lookup_index,
+                                   const string& lookup_offset, casadi_int m,
                                    const string& iw, const string& w) {
     add_auxiliary(AUX_INTERPN);
     stringstream s;
     s << "casadi_interpn(" << res << ", " << ndim << ", " << grid << ", "  << offset << ", "
-      << values << ", " << x << ", " << lookup_mode << ", " << m << ", " << iw << ", " << w << ");";
+      << values << ", " << x << ", " << lookup_mode << ", " << lookup_index << ", "
+      << lookup_offset << ", " << m << ", " << iw << ", " << w << ");";
+    return s.str();
+  }
+
+  string CodeGenerator::interpn_batch(const string& res, casadi_int ndim, const string& grid,
+                                      const string& offset,
+                                      const string& values, const string& x,
+                                      const string& lookup_mode, const string& lookup_index,
+                                      const string& lookup_offset, casadi_int m,
+                                      casadi_int npoints, const string& iw, const string& w) {
+    add_auxiliary(AUX_INTERPN_BATCH);
+    stringstream s;
+    s << "casadi_interpn_batch(" << res << ", " << ndim << ", " << grid << ", "  << offset << ", "
+      << values << ", " << x << ", " << lookup_mode << ", " << lookup_index << ", "
+      << lookup_offset << ", " << m << ", " << npoints << ", " << iw << ", " << w << ");";
     return s.str();
   }
 
   string CodeGenerator::interpn_grad(const string& grad,
                                    casadi_int ndim, const string& grid, const string& offset,
                                    const string& values, const string& x,
-                                   const string& lookup_mode, casadi_int m,
+                                   const string& lookup_mode, const string& lookup_index,
+                                   const string& lookup_offset, casadi_int m,
                                    const string& iw, const string& w) {
     add_auxiliary(AUX_INTERPN_GRAD);
     stringstream s;
     s << "casadi_interpn_grad(" << grad << ", " << ndim << ", " << grid << ", " << offset << ", "
-      << values << ", " << x << ", " << lookup_mode << "," << m << ", " << iw << ", " << w << ");";
+      << values << ", " << x << ", " << lookup_mode << ", " << lookup_index << ", "
+      << lookup_offset << ", " << m << ", " << iw << ", " << w << ");";
     return s.str();
   }
 
@@ -1527,8 +1658,13 @@ namespace casadi {
            const string& sp_v, const string& v,
            const string& sp_r, const string& r,
            const string& beta, const string& prinv,
-           const string& pc, const string& w) {
+           const string& pc, const string& w, casadi_int nb) {
     add_auxiliary(CodeGenerator::AUX_QR);
+    if (nb>1 && nrhs>1) {
+      return "casadi_qr_solve_blk(" + x + ", " + str(nrhs) + ", " + (tr ? "1" : "0") + ", "
+             + sp_v + ", " + v + ", " + sp_r + ", " + r + ", "
+             + beta + ", " + prinv + ", " + pc + ", " + w + ", " + str(nb) + ");";
+    }
     return "casadi_qr_solve(" + x + ", " + str(nrhs) + ", " + (tr ? "1" : "0") + ", "
            + sp_v + ", " + v + ", " + sp_r + ", " + r + ", "
            + beta + ", " + prinv + ", " + pc + ", " + w + ");";
@@ -1551,11 +1687,31 @@ namespace casadi {
            + d + ", " + p + ", " + w + ");";
   }
 
+  std::string CodeGenerator::
+  ldl_super(const std::string& sp_a, const std::string& a,
+            const std::string& sp_lt, const std::string& lt, const std::string& d,
+            const std::string& p, const std::string& sp_sn, const std::string& sn,
+            const std::string& iw, const std::string& w) {
+    add_auxiliary(CodeGenerator::AUX_LDL);
+    return "casadi_ldl_super(" + sp_a + ", " + a + ", " + sp_lt + ", " + lt + ", "
+           + d + ", " + p + ", " + sp_sn + ", " + sn + ", " + iw + ", " + w + ");";
+  }
+
+  void CodeGenerator::
+  ldl_super_work(const Sparsity& sp_sn, const std::vector<casadi_int>& sn,
+                 casadi_int& sz_iw, casadi_int& sz_w) {
+    casadi_ldl_super_work(sp_sn, get_ptr(sn), &sz_iw, &sz_w);
+  }
+
   std::string CodeGenerator::
   ldl_solve(const std::string& x, casadi_int nrhs,
     const std::string& sp_lt, const std::string& lt, const std::string& d,
-    const std::string& p, const std::string& w) {
+    const std::string& p, const std::string& w, casadi_int nb) {
     add_auxiliary(CodeGenerator::AUX_LDL);
+    if (nb>1 && nrhs>1) {
+      return "casadi_ldl_solve_blk(" + x + ", " + str(nrhs) + ", " + sp_lt + ", "
+             + lt + ", " + d + ", " + p + ", " + w + ", " + str(nb) + ");";
+    }
     return "casadi_ldl_solve(" + x + ", " + str(nrhs) + ", " + sp_lt + ", "
            + lt + ", " + d + ", " + p + ", " + w + ");";
   }
@@ -184,15 +184,25 @@ namespace casadi {
     std::string interpn(const std::string& res, casadi_int ndim, const std::string& grid,
                         const std::string& offset,
                         const std::string& values, const std::string& x,
-                        const std::string& lookup_mode, casadi_int m,
+                        const std::string& lookup_mode, const std::string& lookup_index,
+                        const std::string& lookup_offset, casadi_int m,
                         const std::string& iw, const std::string& w);
 
+    /** \brief Multilinear interpolation at npoints points */
+    std::string interpn_batch(const std::string& res, casadi_int ndim, const std::string& grid,
+                              const std::string& offset,
+                              const std::string& values, const std::string& x,
+                              const std::string& lookup_mode, const std::string& lookup_index,
+                              const std::string& lookup_offset, casadi_int m,
+                              casadi_int npoints, const std::string& iw, const std::string& w);
+
     /** \brief Multilinear interpolation - calculate gradient */
     std::string interpn_grad(const std::string& grad,
       casadi_int ndim, const std::string& grid,
       const std::string& offset,
       const std::string& values, const std::string& x,
-      const std::string& lookup_mode, casadi_int m,
+      const std::string& lookup_mode, const std::string& lookup_index,
+      const std::string& lookup_offset, casadi_int m,
       const std::string& iw, const std::string& w);
 
     /** \brief Transpose */
@@ -206,12 +216,16 @@ namespace casadi {
                    const std::string& r, const std::string& beta,
                    const std::string& prinv, const std::string& pc);
 
-    /** \brief QR solve */
+    /** \brief QR solve
+     * With nb>1 and nrhs>1, right-hand-sides are solved in blocks of nb,
+     * requiring len[w] >= nb*(max(ncol, nrow_ext)+1). A linear solver
+     * reserves this in the caller's w by overriding codegen_work
+     */
     std::string qr_solve(const std::string& x, casadi_int nrhs, bool tr,
                          const std::string& sp_v, const std::string& v,
                          const std::string& sp_r, const std::string& r,
                          const std::string& beta, const std::string& prinv,
-                         const std::string& pc, const std::string& w);
+                         const std::string& pc, const std::string& w, casadi_int nb=1);
 
     /** \\brief LSQR solve */
     std::string lsqr_solve(const std::string& A, const std::string&x,
@@ -223,11 +237,30 @@ namespace casadi {
                    const std::string& d, const std::string& p,
                    const std::string& w);
 
-    /** \brief LDL solve */
+    /** \brief Supernodal LDL factorization
+     * Same output as ldl. The supernode partition sp_sn, sn is given by
+     * Sparsity::ldl_super of the factor pattern, the sizes of iw and w
+     * by ldl_super_work
+     */
+    std::string ldl_super(const std::string& sp_a, const std::string& a,
+                          const std::string& sp_lt, const std::string& lt,
+                          const std::string& d, const std::string& p,
+                          const std::string& sp_sn, const std::string& sn,
+                          const std::string& iw, const std::string& w);
+
+    /** \brief Work vector sizes for ldl_super */
+    static void ldl_super_work(const Sparsity& sp_sn, const std::vector<casadi_int>& sn,
+                               casadi_int& sz_iw, casadi_int& sz_w);
+
+    /** \brief LDL solve
+     * With nb>1 and nrhs>1, right-hand-sides are solved in blocks of nb,
+     * requiring len[w] >= nb*n. A linear solver reserves this in the
+     * caller's w by overriding codegen_work
+     */
     std::string ldl_solve(const std::string& x, casadi_int nrhs,
                          const std::string& sp_lt, const std::string& lt,
                          const std::string& d, const std::string& p,
-                         const std::string& w);
+                         const std::string& w, casadi_int nb=1);
 
     /** \brief fmax */
     std::string fmax(const std::string& x, const std::string& y);
@@ -302,17 +335,23 @@ namespace casadi {
       AUX_FROM_MEX,
       AUX_INTERPN,
       AUX_INTERPN_GRAD,
+      AUX_INTERPN_BATCH,
       AUX_FLIP,
       AUX_INTERPN_WEIGHTS,
       AUX_LOW,
       AUX_INTERPN_INTERPOLATE,
       AUX_DE_BOOR,
       AUX_ND_BOOR_EVAL,
+      AUX_ND_BOOR_DUAL_EVAL,
+      AUX_ND_BOOR_BASIS,
       AUX_FINITE_DIFF,
       AUX_QR,
       AUX_QP,
+      AUX_IPQP,
       AUX_NLP,
       AUX_SQPMETHOD,
+      AUX_BFGS,
+      AUX_LBFGS,
       AUX_LDL,
       AUX_NEWTON,
       AUX_TO_DOUBLE,
@@ -335,7 +374,9 @@ namespace casadi {
       AUX_REAL_MIN,
       AUX_ISINF,
       AUX_BOUNDS_CONSISTENCY,
-      AUX_LSQR
+      AUX_LSQR,
+      AUX_KRYLOV,
+      AUX_EXPM
     };
 
     /** \brief Add a built-in auxiliary function */
@@ -451,6 +492,9 @@ namespace casadi {
     // Should we create a memory entry point?
     bool with_mem;
 
+    // Should we create a <name>_eval_batch entry point?
+    bool with_eval_batch;
+
     // Generate header file?
     bool with_header;
 
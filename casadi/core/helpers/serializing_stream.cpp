@@ -310,6 +310,16 @@ namespace casadi {
       " but can only read in version " + str(v) + ".");
   }
 
+  int DeserializingStream::version(const std::string& name, int min, int max) {
+    int load_version;
+    unpack(name+"::serialization::version", load_version);
+    casadi_assert(load_version>=min && load_version<=max,
+      "DeSerialization of " + name + " failed. "
+      "Object written in version " + str(load_version) +
+      " but can only read in versions " + str(min) + " to " + str(max) + ".");
+    return load_version;
+  }
+
   void SerializingStream::version(const std::string& name, int v) {
     pack(name+"::serialization::version", v);
   }
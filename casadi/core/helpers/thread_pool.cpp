@@ -0,0 +1,131 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "thread_pool.hpp"
+#include "exception.hpp"
+
+namespace casadi {
+
+#ifdef CASADI_WITH_THREAD
+
+  ThreadPool::ThreadPool(casadi_int nworker)
+    : nworker_(nworker), task_(nullptr), ntask_(0), pending_(0), generation_(0),
+      stop_(false) {
+  }
+
+  ThreadPool::~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      stop_ = true;
+    }
+    cv_task_.notify_all();
+    for (auto&& th : threads_) th.join();
+  }
+
+  casadi_int ThreadPool::size() const {
+    return nworker_ + 1;
+  }
+
+  void ThreadPool::run(casadi_int n, const std::function<void(casadi_int)>& f) {
+    casadi_assert_dev(n<=size());
+    if (n<=1) {
+      if (n==1) f(0);
+      return;
+    }
+    std::unique_lock<std::mutex> lock(mtx_);
+    // Start the workers on first use, before any task is posted
+    if (threads_.empty()) {
+      for (casadi_int s=1; s<=nworker_; ++s) {
+        threads_.emplace_back(&ThreadPool::work, this, s);
+      }
+    }
+    // Post the task
+    task_ = &f;
+    ntask_ = n;
+    pending_ = n-1;
+    error_ = nullptr;
+    generation_++;
+    lock.unlock();
+    cv_task_.notify_all();
+
+    // The calling thread takes slot 0
+    std::exception_ptr error;
+    try {
+      f(0);
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    // Wait for the workers
+    lock.lock();
+    cv_done_.wait(lock, [this]() { return pending_==0;});
+    task_ = nullptr;
+    if (!error) error = error_;
+    lock.unlock();
+    if (error) std::rethrow_exception(error);
+  }
+
+  void ThreadPool::work(casadi_int s) {
+    casadi_int seen = 0;
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (true) {
+      cv_task_.wait(lock, [this, seen]() { return stop_ || generation_!=seen;});
+      if (stop_) return;
+      seen = generation_;
+      if (s>=ntask_) continue;
+      const std::function<void(casadi_int)>& f = *task_;
+      lock.unlock();
+      std::exception_ptr error;
+      try {
+        f(s);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      lock.lock();
+      if (error && !error_) error_ = error;
+      if (--pending_==0) cv_done_.notify_one();
+    }
+  }
+
+#else // CASADI_WITH_THREAD
+
+  ThreadPool::ThreadPool(casadi_int nworker) : nworker_(nworker) {
+  }
+
+  ThreadPool::~ThreadPool() {
+  }
+
+  casadi_int ThreadPool::size() const {
+    return 1;
+  }
+
+  void ThreadPool::run(casadi_int n, const std::function<void(casadi_int)>& f) {
+    casadi_assert_dev(n<=size());
+    if (n==1) f(0);
+  }
+
+#endif // CASADI_WITH_THREAD
+
+} // namespace casadi
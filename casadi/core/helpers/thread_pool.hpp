@@ -0,0 +1,105 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_THREAD_POOL_HPP
+#define CASADI_THREAD_POOL_HPP
+
+#include "casadi_common.hpp"
+
+#include <exception>
+#include <functional>
+#include <vector>
+
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.thread.h>
+#include <mingw.mutex.h>
+#include <mingw.condition_variable.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif // CASADI_WITH_THREAD
+
+namespace casadi {
+
+  /// \cond INTERNAL
+
+  /** \brief Fixed set of worker threads, kept alive between parallel sections
+   *
+   * The workers are started on first use and joined by the destructor, so
+   * that repeated fork-join sections do not pay for creating threads. A pool
+   * serves one caller at a time and is meant to live in a memory object.
+   * Without CASADI_WITH_THREAD, everything runs on the calling thread.
+   */
+  class CASADI_EXPORT ThreadPool {
+  public:
+    /// Create a pool with nworker threads besides the calling thread
+    explicit ThreadPool(casadi_int nworker);
+
+    /// Destructor, joins the workers
+    ~ThreadPool();
+
+    /// Number of slots that can run concurrently, including the calling thread
+    casadi_int size() const;
+
+    /** \brief Call f(0), ..., f(n-1) concurrently and wait for all of them
+     *
+     * Each call runs on its own thread, f(0) on the calling thread.
+     * Requires n <= size(). Exceptions are rethrown on the calling thread.
+     */
+    void run(casadi_int n, const std::function<void(casadi_int)>& f);
+
+  private:
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    // Number of workers
+    casadi_int nworker_;
+
+#ifdef CASADI_WITH_THREAD
+    // Worker loop for slot s
+    void work(casadi_int s);
+
+    std::vector<std::thread> threads_;
+    std::mutex mtx_;
+    std::condition_variable cv_task_, cv_done_;
+    // Current task, number of slots, slots still running
+    const std::function<void(casadi_int)>* task_;
+    casadi_int ntask_, pending_;
+    // Incremented for every task, signals the workers
+    casadi_int generation_;
+    bool stop_;
+    // First exception thrown by a worker
+    std::exception_ptr error_;
+#endif // CASADI_WITH_THREAD
+  };
+
+  /// \endcond
+
+} // namespace casadi
+
+#endif // CASADI_THREAD_POOL_HPP
@@ -1978,12 +1978,19 @@ namespace casadi {
     casadi_assert(r.size()==v.size(), "'r', 'v' dimension mismatch");
     casadi_assert(beta.is_vector() && beta.numel()==ncol, "'beta' has wrong dimension");
     casadi_assert(prinv.size()==r.size1(), "'pinv' has wrong dimension");
-    // Work vector
-    std::vector<Scalar> w(nrow+ncol);
     // Return value
     Matrix<Scalar> x = densify(b);
-    casadi_qr_solve(x.ptr(), nrhs, tr, v.sparsity(), v.ptr(), r.sparsity(), r.ptr(),
-                    beta.ptr(), get_ptr(prinv), get_ptr(pc), get_ptr(w));
+    if (nrhs>1) {
+      // Sweep the factors once per block of right-hand-sides
+      casadi_int nb = std::min(nrhs, casadi_int(8));
+      std::vector<Scalar> w(nb*(std::max(v.size1(), ncol)+1));
+      casadi_qr_solve_blk(x.ptr(), nrhs, tr, v.sparsity(), v.ptr(), r.sparsity(), r.ptr(),
+                          beta.ptr(), get_ptr(prinv), get_ptr(pc), get_ptr(w), nb);
+    } else {
+      std::vector<Scalar> w(nrow+ncol);
+      casadi_qr_solve(x.ptr(), nrhs, tr, v.sparsity(), v.ptr(), r.sparsity(), r.ptr(),
+                      beta.ptr(), get_ptr(prinv), get_ptr(pc), get_ptr(w));
+    }
     return x;
   }
 
@@ -2033,13 +2040,21 @@ namespace casadi {
     // Symbolic factorization
     Sparsity Lt_sp = A.sparsity().ldl(p, amd);
 
+    // Supernodal partition
+    std::vector<casadi_int> sn;
+    Sparsity sn_sp = Lt_sp.ldl_super(sn);
+
     // Get dimension
     casadi_int n=A.size1();
 
     // Calculate entries in L and D
-    vector<Scalar> D_nz(n), L_nz(Lt_sp.nnz()), w(n);
-    casadi_ldl(A.sparsity(), get_ptr(A.nonzeros()), Lt_sp,
-              get_ptr(L_nz), get_ptr(D_nz), get_ptr(p), get_ptr(w));
+    casadi_int sz_iw, sz_w;
+    casadi_ldl_super_work(sn_sp, get_ptr(sn), &sz_iw, &sz_w);
+    vector<Scalar> D_nz(n), L_nz(Lt_sp.nnz()), w(sz_w);
+    vector<casadi_int> iw(sz_iw);
+    casadi_ldl_super(A.sparsity(), get_ptr(A.nonzeros()), Lt_sp,
+                     get_ptr(L_nz), get_ptr(D_nz), get_ptr(p), sn_sp, get_ptr(sn),
+                     get_ptr(iw), get_ptr(w));
 
     // Assemble L and D
     LT = Matrix<Scalar>(Lt_sp, L_nz);
@@ -2057,8 +2072,16 @@ namespace casadi {
     casadi_assert(D.is_vector() && D.numel()==n, "'D' has wrong dimension");
     // Solve for all right-hand-sides
     Matrix<Scalar> x = densify(b);
-    std::vector<Scalar> w(n);
-    casadi_ldl_solve(x.ptr(), nrhs, LT.sparsity(), LT.ptr(), D.ptr(), get_ptr(p), get_ptr(w));
+    if (nrhs>1) {
+      // Sweep the factor once per block of right-hand-sides
+      casadi_int nb = std::min(nrhs, casadi_int(8));
+      std::vector<Scalar> w(nb*n);
+      casadi_ldl_solve_blk(x.ptr(), nrhs, LT.sparsity(), LT.ptr(), D.ptr(), get_ptr(p),
+                           get_ptr(w), nb);
+    } else {
+      std::vector<Scalar> w(n);
+      casadi_ldl_solve(x.ptr(), nrhs, LT.sparsity(), LT.ptr(), D.ptr(), get_ptr(p), get_ptr(w));
+    }
     return x;
   }
 
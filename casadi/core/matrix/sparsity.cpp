@@ -30,6 +30,14 @@
 #include "sparse_storage_impl.hpp"
 #include "serializing_stream.hpp"
 #include <climits>
+#include <deque>
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif //CASADI_WITH_THREAD
 
 #define CASADI_THROW_ERROR(FNAME, WHAT) \
 throw CasadiException("Error in Sparsity::" FNAME " at " + CASADI_WHERE + ":\n"\
@@ -594,18 +602,111 @@ namespace casadi {
     return parent;
   }
 
+  namespace {
+    // Predicted number of nonzeros in L for a symmetric permutation
+    casadi_int ldl_fill(const Sparsity& A, const std::vector<casadi_int>& p) {
+      casadi_int n = A.size1();
+      std::vector<casadi_int> tmp;
+      Sparsity Aperm = A.sub(p, p, tmp);
+      std::vector<casadi_int> parent(n), l_colind(n+1), w(n);
+      SparsityInternal::ldl_colind(Aperm, get_ptr(parent), get_ptr(l_colind), get_ptr(w));
+      return l_colind.back();
+    }
+
+    // Predicted number of nonzeros in V and R for a column permutation
+    casadi_int qr_fill(const Sparsity& A, const std::vector<casadi_int>& pc) {
+      casadi_int size1=A.size1(), size2=A.size2();
+      std::vector<casadi_int> tmp;
+      Sparsity Aperm = A.sub(range(size1), pc, tmp);
+      std::vector<casadi_int> leftmost(size1), parent(size2), prinv(size1 + size2),
+                              iw(size1 + 7*size2 + 1);
+      casadi_int nrow_ext, v_nnz, r_nnz;
+      SparsityInternal::qr_init(Aperm, Aperm.T(),
+                                get_ptr(leftmost), get_ptr(parent), get_ptr(prinv),
+                                &nrow_ext, &v_nnz, &r_nnz, get_ptr(iw));
+      return v_nnz + r_nnz;
+    }
+
+    // Process-wide cache of symbolic factorizations and orderings
+    struct FactCacheEntry {
+      // Pattern, its hash and type of analysis
+      Sparsity sp;
+      std::size_t h;
+      std::string type;
+      // Permutations and patterns of the factors
+      std::vector<casadi_int> p1, p2;
+      Sparsity sp1, sp2;
+    };
+
+    // Oldest entry first, bounded by fact_cache_max
+    typedef std::deque<FactCacheEntry> FactCache;
+    const std::size_t fact_cache_max = 128;
+
+#ifdef CASADI_WITH_THREAD
+    std::mutex fact_cache_mtx;
+#endif // CASADI_WITH_THREAD
+
+    FactCache& fact_cache() {
+      static FactCache ret;
+      return ret;
+    }
+
+    // Look up a cached entry, keyed by Sparsity::hash()
+    bool fact_cache_get(const Sparsity& sp, const std::string& type, FactCacheEntry& e) {
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(fact_cache_mtx);
+#endif // CASADI_WITH_THREAD
+      std::size_t h = sp.hash();
+      for (auto&& c : fact_cache()) {
+        if (c.h==h && c.type==type && c.sp==sp) {
+          e = c;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    // Add an entry to the cache, dropping the oldest one if full
+    void fact_cache_put(FactCacheEntry& e) {
+      e.h = e.sp.hash();
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(fact_cache_mtx);
+#endif // CASADI_WITH_THREAD
+      FactCache& c = fact_cache();
+      c.push_back(e);
+      if (c.size()>fact_cache_max) c.pop_front();
+    }
+  } // namespace
+
   Sparsity Sparsity::ldl(std::vector<casadi_int>& p, bool amd) const {
     casadi_assert(is_symmetric(),
                  "LDL factorization requires a symmetric matrix");
     // Recursive call if AMD
     if (amd) {
-      // Get AMD reordering
-      p = this->amd();
+      // Reuse an existing symbolic factorization of the same pattern
+      FactCacheEntry e;
+      if (fact_cache_get(*this, "ldl", e)) {
+        p = e.p1;
+        return e.sp1;
+      }
+      // Get fill-reducing reordering
+      p = fill_reducing_order(false);
       // Permute sparsity pattern
       std::vector<casadi_int> tmp;
       Sparsity Aperm = sub(p, p, tmp);
+      // Postorder the elimination tree, making supernodes contiguous
+      std::vector<casadi_int> parent = Aperm.etree(), post(size1()), w(3*size1());
+      SparsityInternal::postorder(get_ptr(parent), size1(), get_ptr(post), get_ptr(w));
+      for (casadi_int& k : post) k = p[k];
+      p = post;
+      Aperm = sub(p, p, tmp);
       // Call recursively
-      return Aperm.ldl(tmp, false);
+      e.sp = *this;
+      e.type = "ldl";
+      e.p1 = p;
+      e.sp1 = Aperm.ldl(tmp, false);
+      fact_cache_put(e);
+      return e.sp1;
     }
     // Dimension
     casadi_int n=size1();
@@ -626,6 +727,34 @@ namespace casadi {
     return Sparsity(n, n, L_colind, L_row, true).T();
   }
 
+  Sparsity Sparsity::ldl_super(std::vector<casadi_int>& sn) const {
+    casadi_assert(is_square() && is_triu(), "Expecting the L^T pattern returned by ldl");
+    // Dimension
+    casadi_int n=size2();
+    // Sparsity pattern of L (strictly lower entries only)
+    Sparsity L = T();
+    const casadi_int *l_colind = L.colind(), *l_row = L.row();
+    // Merge column c with column c-1 if parent(c-1)==c and the patterns coincide
+    sn.clear();
+    if (n>0) sn.push_back(0);
+    for (casadi_int c=1; c<n; ++c) {
+      casadi_int k = l_colind[c-1];
+      if (k==l_colind[c] || l_row[k]!=c
+          || l_colind[c]-k != l_colind[c+1]-l_colind[c]+1) sn.push_back(c);
+    }
+    sn.push_back(n);
+    // Rows of each supernode: the diagonal block followed by the rows of its last column
+    casadi_int nsn = sn.size()-1;
+    std::vector<casadi_int> sn_colind(1, 0), sn_row;
+    for (casadi_int s=0; s<nsn; ++s) {
+      for (casadi_int c=sn[s]; c<sn[s+1]; ++c) sn_row.push_back(c);
+      casadi_int c = sn[s+1]-1;
+      for (casadi_int k=l_colind[c]; k<l_colind[c+1]; ++k) sn_row.push_back(l_row[k]);
+      sn_colind.push_back(sn_row.size());
+    }
+    return Sparsity(n, nsn, sn_colind, sn_row, true);
+  }
+
   void Sparsity::
   qr_sparse(Sparsity& V, Sparsity& R, std::vector<casadi_int>& prinv,
             std::vector<casadi_int>& pc, bool amd) const {
@@ -634,13 +763,30 @@ namespace casadi {
 
     // Recursive call if AMD
     if (amd) {
-      // Get AMD reordering
-      pc = mtimes(T(), *this).amd();
+      // Reuse an existing symbolic factorization of the same pattern
+      FactCacheEntry e;
+      if (fact_cache_get(*this, "qr", e)) {
+        pc = e.p1;
+        prinv = e.p2;
+        V = e.sp1;
+        R = e.sp2;
+        return;
+      }
+      // Get fill-reducing reordering
+      pc = fill_reducing_order(true);
       // Permute sparsity pattern
       std::vector<casadi_int> tmp;
       Sparsity Aperm = sub(range(size1), pc, tmp);
       // Call recursively
-      return Aperm.qr_sparse(V, R, prinv, tmp, false);
+      Aperm.qr_sparse(V, R, prinv, tmp, false);
+      e.sp = *this;
+      e.type = "qr";
+      e.p1 = pc;
+      e.p2 = prinv;
+      e.sp1 = V;
+      e.sp2 = R;
+      fact_cache_put(e);
+      return;
     }
 
     // No column permutation
@@ -684,6 +830,53 @@ namespace casadi {
     return (*this)->amd();
   }
 
+  std::vector<casadi_int> Sparsity::nested_dissection() const {
+    return (*this)->nested_dissection();
+  }
+
+  std::vector<casadi_int> Sparsity::fill_reducing_order(bool qr) const {
+    // Look for a cached ordering
+    FactCacheEntry e;
+    e.type = qr ? "qr_order" : "ldl_order";
+    if (fact_cache_get(*this, e.type, e)) return e.p1;
+    // Candidate orderings, natural ordering first
+    std::vector<std::vector<casadi_int> > cand(1, range(qr ? size2() : size1()));
+    if (qr) {
+      // Column orderings from the pattern of A'*A
+      Sparsity AtA = mtimes(T(), *this);
+      cand.push_back(AtA.amd());
+      cand.push_back(AtA.nested_dissection());
+      // COLAMD-style: drop dense rows of A before forming A'*A
+      casadi_int dense = std::max(casadi_int(16),
+        static_cast<casadi_int>(10*sqrt(static_cast<double>(size2()))));
+      std::vector<casadi_int> row_count(size1(), 0), keep;
+      for (casadi_int k=0; k<nnz(); ++k) row_count[row()[k]]++;
+      for (casadi_int r=0; r<size1(); ++r) if (row_count[r]<=dense) keep.push_back(r);
+      if (static_cast<casadi_int>(keep.size())<size1()) {
+        std::vector<casadi_int> tmp;
+        Sparsity A_sparse = sub(keep, range(size2()), tmp);
+        cand.push_back(mtimes(A_sparse.T(), A_sparse).amd());
+      }
+    } else {
+      cand.push_back(amd());
+      cand.push_back(nested_dissection());
+    }
+    // Pick the candidate with the least predicted fill
+    casadi_int best = 0, best_fill = -1;
+    for (casadi_int i=0; i<static_cast<casadi_int>(cand.size()); ++i) {
+      casadi_int fill = qr ? qr_fill(*this, cand[i]) : ldl_fill(*this, cand[i]);
+      if (best_fill<0 || fill<best_fill) {
+        best = i;
+        best_fill = fill;
+      }
+    }
+    // Cache the result
+    e.sp = *this;
+    e.p1 = cand[best];
+    fact_cache_put(e);
+    return e.p1;
+  }
+
   casadi_int Sparsity::btf(std::vector<casadi_int>& rowperm, std::vector<casadi_int>& colperm,
                             std::vector<casadi_int>& rowblock, std::vector<casadi_int>& colblock,
                             std::vector<casadi_int>& coarse_rowblock,
@@ -657,6 +657,7 @@ namespace casadi {
 
     /** \brief Symbolic LDL factorization
         Returns the sparsity pattern of L^T
+        With amd=true, the result is kept in a bounded process-wide cache
 
         The implementation is a modified version of LDL
         Copyright(c) Timothy A. Davis, 2005-2013
@@ -664,9 +665,19 @@ namespace casadi {
     */
     Sparsity ldl(std::vector<casadi_int>& SWIG_OUTPUT(p), bool amd=true) const;
 
+    /** \brief Supernodal partition of a symbolic LDL factorization
+        Called on the pattern of L^T returned by ldl. Consecutive columns of L
+        with nested row patterns are grouped into supernodes: supernode s
+        consists of the columns sn[s] <= c < sn[s+1]. Returns an n-by-nsn
+        pattern whose column s holds the rows shared by the supernode,
+        diagonal block included.
+    */
+    Sparsity ldl_super(std::vector<casadi_int>& SWIG_OUTPUT(sn)) const;
+
     /** \brief Symbolic QR factorization
         Returns the sparsity pattern of V (compact representation of Q) and R
         as well as vectors needed for the numerical factorization and solution.
+        With amd=true, the result is kept in a bounded process-wide cache
         The implementation is a modified version of CSparse
         Copyright(c) Timothy A. Davis, 2006-2009
         Licensed as a derivative work under the GNU LGPL
@@ -744,6 +755,20 @@ namespace casadi {
     */
     std::vector<casadi_int> amd() const;
 
+    /** \brief Nested dissection preordering
+      Fill-reducing ordering by recursive bisection with level-structure
+      separators. The system must be symmetric, cf. amd.
+    */
+    std::vector<casadi_int> nested_dissection() const;
+
+    /** \brief Fill-reducing ordering for a sparse factorization
+      Evaluates the natural, AMD, COLAMD-style (QR only) and nested dissection
+      orderings and returns the one with the least fill predicted from the
+      symbolic factorization. With qr=false, a symmetric permutation for LDL,
+      otherwise a column permutation for QR. Results are cached by hash().
+    */
+    std::vector<casadi_int> fill_reducing_order(bool qr) const;
+
     /** \brief Propagate sparsity through a linear solve
      */
     void spsolve(bvec_t* X, const bvec_t* B, bool tr) const;
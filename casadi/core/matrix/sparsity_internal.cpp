@@ -965,6 +965,103 @@ namespace casadi {
     #undef FLIP
   }
 
+  std::vector<casadi_int> SparsityInternal::nested_dissection() const {
+    casadi_assert(is_symmetric(), "Nested dissection requires a symmetric matrix");
+    // Get sparsity
+    casadi_int n=size2();
+    const casadi_int *colind=this->colind(), *row=this->row();
+    // Subgraphs up to this size are not dissected further
+    const casadi_int leaf_size = 16;
+    // Permutation, filled from the back since separators are eliminated last
+    vector<casadi_int> p(n);
+    casadi_int p_end = n;
+    // Subgraph index of each node (-1 if ordered), level in breadth-first search
+    vector<casadi_int> sub(n, 0), level(n), queue(n);
+    casadi_int nsub = 1;
+    // Subgraphs remaining to be ordered
+    vector<vector<casadi_int> > stack;
+    if (n>0) stack.push_back(range(n));
+    while (!stack.empty()) {
+      vector<casadi_int> s = stack.back();
+      stack.pop_back();
+      casadi_int sid = sub[s[0]];
+      // Breadth-first search within the subgraph
+      auto bfs = [&](casadi_int root) {
+        for (casadi_int i : s) level[i] = -1;
+        casadi_int nq = 0;
+        level[root] = 0;
+        queue[nq++] = root;
+        for (casadi_int k=0; k<nq; ++k) {
+          casadi_int i = queue[k];
+          for (casadi_int el=colind[i]; el<colind[i+1]; ++el) {
+            casadi_int j = row[el];
+            if (sub[j]==sid && level[j]<0) {
+              level[j] = level[i] + 1;
+              queue[nq++] = j;
+            }
+          }
+        }
+        return nq;
+      };
+      // Small subgraphs are ordered directly
+      if (s.size()<=leaf_size) {
+        p_end -= s.size();
+        copy(s.begin(), s.end(), p.begin()+p_end);
+        for (casadi_int i : s) sub[i] = -1;
+        continue;
+      }
+      // Find a pseudo-peripheral node with repeated searches
+      casadi_int root = s[0], nq = 0, ecc = -1;
+      for (casadi_int it=0; it<3; ++it) {
+        nq = bfs(root);
+        if (level[queue[nq-1]]<=ecc) break;
+        ecc = level[queue[nq-1]];
+        root = queue[nq-1];
+      }
+      // Nodes not reachable from the root form a new subgraph
+      vector<casadi_int> rest, a, b, sep;
+      for (casadi_int i : s) if (level[i]<0) rest.push_back(i);
+      if (ecc<2) {
+        // Too few levels for a useful separator, order the component directly
+        sep.assign(queue.begin(), queue.begin()+nq);
+      } else {
+        // Separator: the middle level, minus nodes without neighbors beyond it
+        casadi_int mid = (ecc+1)/2;
+        for (casadi_int k=0; k<nq; ++k) {
+          casadi_int i = queue[k];
+          if (level[i]<mid) {
+            a.push_back(i);
+          } else if (level[i]>mid) {
+            b.push_back(i);
+          } else {
+            bool cut = false;
+            for (casadi_int el=colind[i]; el<colind[i+1] && !cut; ++el) {
+              casadi_int j = row[el];
+              cut = sub[j]==sid && level[j]==mid+1;
+            }
+            if (cut) {
+              sep.push_back(i);
+            } else {
+              a.push_back(i);
+            }
+          }
+        }
+      }
+      // Order the separator last
+      p_end -= sep.size();
+      copy(sep.begin(), sep.end(), p.begin()+p_end);
+      for (casadi_int i : sep) sub[i] = -1;
+      // Dissect the remaining parts recursively
+      for (vector<casadi_int>* part : {&a, &b, &rest}) {
+        if (part->empty()) continue;
+        for (casadi_int i : *part) sub[i] = nsub;
+        nsub++;
+        stack.push_back(*part);
+      }
+    }
+    return p;
+  }
+
   void SparsityInternal::bfs(casadi_int n, std::vector<casadi_int>& wi, std::vector<casadi_int>& wj,
                               std::vector<casadi_int>& queue, const std::vector<casadi_int>& imatch,
                               const std::vector<casadi_int>& jmatch, casadi_int mark) const {
@@ -124,6 +124,11 @@ namespace casadi {
       */
     std::vector<casadi_int> amd() const;
 
+    /** \brief Nested dissection preordering
+      * Recursive bisection with level-structure separators, for a symmetric pattern
+      */
+    std::vector<casadi_int> nested_dissection() const;
+
     /** \brief Calculate the elimination tree for a matrix
       * len[w] >= ata ? ncol + nrow : ncol
       * len[parent] == ncol
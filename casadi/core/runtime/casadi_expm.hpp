@@ -0,0 +1,257 @@
+// NOLINT(legal/copyright)
+// SYMBOL "expm_densify"
+// Dense, symmetrically permuted copy of a sparse square matrix,
+// ad[iperm[r] + iperm[c]*n] = a[k] for each nonzero (r, c)
+template<typename T1>
+void casadi_expm_densify(const casadi_int* sp_a, const T1* a, const casadi_int* iperm,
+                         T1* ad) {
+  casadi_int n, c, k;
+  const casadi_int *colind, *row;
+  n = sp_a[1];
+  colind = sp_a+2; row = sp_a+n+3;
+  casadi_clear(ad, n*n);
+  for (c=0; c<n; ++c) {
+    for (k=colind[c]; k<colind[c+1]; ++k) ad[iperm[row[k]] + iperm[c]*n] = a[k];
+  }
+}
+
+// SYMBOL "expm_sparsify"
+// Inverse of casadi_expm_densify, restricted to the sparsity pattern sp_e
+template<typename T1>
+void casadi_expm_sparsify(const T1* ed, const casadi_int* iperm, const casadi_int* sp_e,
+                          T1* e) {
+  casadi_int n, c, k;
+  const casadi_int *colind, *row;
+  n = sp_e[1];
+  colind = sp_e+2; row = sp_e+n+3;
+  for (c=0; c<n; ++c) {
+    for (k=colind[c]; k<colind[c+1]; ++k) e[k] = ed[iperm[row[k]] + iperm[c]*n];
+  }
+}
+
+// SYMBOL "expm_mtimes"
+// C = A*B for dense n-by-n matrices (column major) sharing a block structure:
+// nb diagonal blocks with offsets blk, tile (I, J) structurally nonzero iff
+// mask[I+J*nb]. The tiles are processed in cache-sized panels
+template<typename T1>
+void casadi_expm_mtimes(casadi_int n, casadi_int nb, const casadi_int* blk,
+                        const casadi_int* mask, const T1* A, const T1* B, T1* C) {
+  casadi_int I, J, K, i, j, k, i0, i1, k0, k1;
+  T1 b;
+  const T1* a;
+  T1* c;
+  casadi_clear(C, n*n);
+  for (I=0; I<nb; ++I) {
+    for (K=0; K<nb; ++K) {
+      if (!mask[I+K*nb]) continue;
+      // Panels of at most 64 rows and 64 columns of A
+      for (i0=blk[I]; i0<blk[I+1]; i0=i1) {
+        i1 = i0 + 64;
+        if (i1>blk[I+1]) i1 = blk[I+1];
+        for (k0=blk[K]; k0<blk[K+1]; k0=k1) {
+          k1 = k0 + 64;
+          if (k1>blk[K+1]) k1 = blk[K+1];
+          // C_IJ += A_IK*B_KJ for all J
+          for (J=0; J<nb; ++J) {
+            if (!mask[K+J*nb]) continue;
+            for (j=blk[J]; j<blk[J+1]; ++j) {
+              c = C + j*n;
+              for (k=k0; k<k1; ++k) {
+                b = B[k+j*n];
+                a = A + k*n;
+                for (i=i0; i<i1; ++i) c[i] += a[i]*b;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+// SYMBOL "expm_solve"
+// Solve Q*X = B in-place (X overwrites B) for block upper triangular Q with
+// the block structure of casadi_expm_mtimes. The diagonal blocks of Q are
+// overwritten by their LU factors. Returns 1 if Q is singular
+template<typename T1>
+int casadi_expm_solve(casadi_int n, casadi_int nb, const casadi_int* blk,
+                      const casadi_int* mask, T1* Q, T1* B) {
+  casadi_int I, J, K, i, j, k, p, i0, i1;
+  T1 v, piv, *b;
+  for (I=nb-1; I>=0; --I) {
+    i0 = blk[I]; i1 = blk[I+1];
+    // B_IJ -= Q_IK*X_KJ for the blocks K>I already solved for
+    for (K=I+1; K<nb; ++K) {
+      if (!mask[I+K*nb]) continue;
+      for (J=0; J<nb; ++J) {
+        if (!mask[K+J*nb]) continue;
+        for (j=blk[J]; j<blk[J+1]; ++j) {
+          b = B + j*n;
+          for (k=blk[K]; k<blk[K+1]; ++k) {
+            v = b[k];
+            for (i=i0; i<i1; ++i) b[i] -= Q[i+k*n]*v;
+          }
+        }
+      }
+    }
+    // LU factorization of Q_II with partial pivoting, rows swapped in B
+    for (k=i0; k<i1; ++k) {
+      p = k;
+      piv = fabs(Q[k+k*n]);
+      for (i=k+1; i<i1; ++i) {
+        if (fabs(Q[i+k*n])>piv) {
+          p = i;
+          piv = fabs(Q[i+k*n]);
+        }
+      }
+      if (piv==0) return 1;
+      if (p!=k) {
+        for (j=i0; j<i1; ++j) {
+          v = Q[k+j*n]; Q[k+j*n] = Q[p+j*n]; Q[p+j*n] = v;
+        }
+        for (j=0; j<n; ++j) {
+          v = B[k+j*n]; B[k+j*n] = B[p+j*n]; B[p+j*n] = v;
+        }
+      }
+      for (i=k+1; i<i1; ++i) Q[i+k*n] /= Q[k+k*n];
+      for (j=k+1; j<i1; ++j) {
+        v = Q[k+j*n];
+        for (i=k+1; i<i1; ++i) Q[i+j*n] -= Q[i+k*n]*v;
+      }
+    }
+    // Forward and backward substitution
+    for (J=0; J<nb; ++J) {
+      if (!mask[I+J*nb]) continue;
+      for (j=blk[J]; j<blk[J+1]; ++j) {
+        b = B + j*n;
+        for (k=i0; k<i1; ++k) {
+          v = b[k];
+          for (i=k+1; i<i1; ++i) b[i] -= Q[i+k*n]*v;
+        }
+        for (k=i1-1; k>=i0; --k) {
+          b[k] /= Q[k+k*n];
+          v = b[k];
+          for (i=i0; i<k; ++i) b[i] -= Q[i+k*n]*v;
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+// SYMBOL "expm_powers"
+// Powers A^2, A^4, A^6 used by casadi_expm. len[p] = 3*n*n
+template<typename T1>
+void casadi_expm_powers(casadi_int n, casadi_int nb, const casadi_int* blk,
+                        const casadi_int* mask, const T1* A, T1* p) {
+  casadi_expm_mtimes(n, nb, blk, mask, A, A, p);
+  casadi_expm_mtimes(n, nb, blk, mask, p, p, p + n*n);
+  casadi_expm_mtimes(n, nb, blk, mask, p, p + n*n, p + 2*n*n);
+}
+
+// SYMBOL "expm"
+// E = expm(A*t) by scaling and squaring with a [m/m] Pade approximant,
+// m in {3, 5, 7, 9, 13} (Higham, 2005). The powers p of A, from
+// casadi_expm_powers, only depend on A and can be reused for a new t.
+// len[w] = 4*n*n. Returns 1 if the denominator is singular
+template<typename T1>
+int casadi_expm(casadi_int n, casadi_int nb, const casadi_int* blk, const casadi_int* mask,
+                const T1* A, const T1* p, T1 t, T1* E, T1* w) {
+  // Largest norm of A*t for each degree
+  static const T1 theta[] = {1.495585217958292e-2, 2.539398330063230e-1,
+    9.504178996162932e-1, 2.097847961257068e0, 5.371920351148152e0};
+  // Coefficients of the Pade approximants of degree 3, 5, 7, 9, 13
+  static const T1 coeff[] = {120., 60., 12., 1.,
+    30240., 15120., 3360., 420., 30., 1.,
+    17297280., 8648640., 1995840., 277200., 25200., 1512., 56., 1.,
+    17643225600., 8821612800., 2075673600., 302702400., 30270240., 2162160.,
+    110880., 3960., 90., 1.,
+    64764752532480000., 32382376266240000., 7771770303897600., 1187353796428800.,
+    129060195264000., 10559470521600., 670442572800., 33522128640., 1323241920.,
+    40840800., 960960., 16380., 182., 1.};
+  static const casadi_int offset[] = {0, 4, 10, 18, 28};
+  casadi_int i, j, k, s, m, nn, nk;
+  T1 nrm, cs, c, ck;
+  const T1 *b, *Pk;
+  T1 *T, *U, *V, *X8;
+  nn = n*n;
+  T = w; U = w + nn; V = w + 2*nn; X8 = w + 3*nn;
+  // 1-norm of A*t
+  nrm = 0;
+  for (j=0; j<n; ++j) {
+    cs = 0;
+    for (i=0; i<n; ++i) cs += fabs(A[i+j*n]);
+    if (cs>nrm) nrm = cs;
+  }
+  nrm *= fabs(t);
+  // Pick the degree, scale by 2^-s if needed
+  for (m=0; m<4; ++m) {
+    if (nrm<=theta[m]) break;
+  }
+  s = 0;
+  while (nrm>theta[4]) {
+    nrm /= 2;
+    s++;
+  }
+  c = t;
+  for (i=0; i<s; ++i) c /= 2;
+  b = coeff + offset[m];
+  if (m<4) {
+    // T = sum_k b_{2k+1} X^(2k), V = sum_k b_{2k} X^(2k), X = c*A
+    nk = m + 1;
+    if (nk==4) casadi_expm_mtimes(n, nb, blk, mask, p + nn, p + nn, X8);
+    casadi_clear(T, nn);
+    casadi_clear(V, nn);
+    for (i=0; i<n; ++i) {
+      T[i+i*n] = b[1];
+      V[i+i*n] = b[0];
+    }
+    ck = 1;
+    for (k=1; k<=nk; ++k) {
+      ck *= c*c;
+      Pk = k<4 ? p + (k-1)*nn : X8;
+      casadi_axpy(nn, b[2*k+1]*ck, Pk, T);
+      casadi_axpy(nn, b[2*k]*ck, Pk, V);
+    }
+    // U = X*T
+    casadi_expm_mtimes(n, nb, blk, mask, A, T, U);
+    casadi_scal(nn, c, U);
+  } else {
+    // U = X*(X^6*(b13 X^6 + b11 X^4 + b9 X^2) + b7 X^6 + b5 X^4 + b3 X^2 + b1 I)
+    casadi_clear(T, nn);
+    casadi_axpy(nn, b[13]*pow(c, 6), p + 2*nn, T);
+    casadi_axpy(nn, b[11]*pow(c, 4), p + nn, T);
+    casadi_axpy(nn, b[9]*c*c, p, T);
+    casadi_expm_mtimes(n, nb, blk, mask, p + 2*nn, T, V);
+    casadi_scal(nn, pow(c, 6), V);
+    casadi_axpy(nn, b[7]*pow(c, 6), p + 2*nn, V);
+    casadi_axpy(nn, b[5]*pow(c, 4), p + nn, V);
+    casadi_axpy(nn, b[3]*c*c, p, V);
+    for (i=0; i<n; ++i) V[i+i*n] += b[1];
+    casadi_expm_mtimes(n, nb, blk, mask, A, V, U);
+    casadi_scal(nn, c, U);
+    // V = X^6*(b12 X^6 + b10 X^4 + b8 X^2) + b6 X^6 + b4 X^4 + b2 X^2 + b0 I
+    casadi_clear(T, nn);
+    casadi_axpy(nn, b[12]*pow(c, 6), p + 2*nn, T);
+    casadi_axpy(nn, b[10]*pow(c, 4), p + nn, T);
+    casadi_axpy(nn, b[8]*c*c, p, T);
+    casadi_expm_mtimes(n, nb, blk, mask, p + 2*nn, T, V);
+    casadi_scal(nn, pow(c, 6), V);
+    casadi_axpy(nn, b[6]*pow(c, 6), p + 2*nn, V);
+    casadi_axpy(nn, b[4]*pow(c, 4), p + nn, V);
+    casadi_axpy(nn, b[2]*c*c, p, V);
+    for (i=0; i<n; ++i) V[i+i*n] += b[0];
+  }
+  // Solve (V - U)*E = V + U
+  for (i=0; i<nn; ++i) {
+    E[i] = V[i] + U[i];
+    V[i] -= U[i];
+  }
+  if (casadi_expm_solve(n, nb, blk, mask, V, E)) return 1;
+  // Undo the scaling by repeated squaring
+  for (i=0; i<s; ++i) {
+    casadi_expm_mtimes(n, nb, blk, mask, E, E, T);
+    casadi_copy(T, nn, E);
+  }
+  return 0;
+}
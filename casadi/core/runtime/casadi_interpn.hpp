@@ -1,7 +1,7 @@
 // NOLINT(legal/copyright)
 // SYMBOL "interpn"
 template<typename T1>
-void casadi_interpn(T1* res, casadi_int ndim, const T1* grid, const casadi_int* offset, const T1* values, const T1* x, const casadi_int* lookup_mode, casadi_int m, casadi_int* iw, T1* w) { // NOLINT(whitespace/line_length)
+void casadi_interpn(T1* res, casadi_int ndim, const T1* grid, const casadi_int* offset, const T1* values, const T1* x, const casadi_int* lookup_mode, const casadi_int* lookup_index, const casadi_int* lookup_offset, casadi_int m, casadi_int* iw, T1* w) { // NOLINT(whitespace/line_length)
   // Work vectors
   T1* alpha;
   casadi_int *index, *corner;
@@ -9,7 +9,8 @@ void casadi_interpn(T1* res, casadi_int ndim, const T1* grid, const casadi_int*
   index = iw; iw += ndim;
   corner = iw; iw += ndim;
   // Left index and fraction of interval
-  casadi_interpn_weights(ndim, grid, offset, x, alpha, index, lookup_mode);
+  casadi_interpn_weights(ndim, grid, offset, x, alpha, index, lookup_mode, lookup_index,
+    lookup_offset);
   // Loop over all corners, add contribution to output
   casadi_clear_casadi_int(corner, ndim);
   casadi_clear(res, m);
@@ -0,0 +1,68 @@
+// NOLINT(legal/copyright)
+// SYMBOL "interpn_batch"
+// Multilinear interpolation at npoints query points, x is ndim-by-npoints and
+// res is m-by-npoints. Work is organized dimension by dimension and corner by
+// corner, with the innermost loops running over the query points.
+// lookup_index and lookup_offset hold the tables of dimensions with lookup
+// mode 3 (index), both may be null otherwise.
+// len[iw] >= (ndim+1)*npoints+ndim, len[w] >= (ndim+1)*npoints
+template<typename T1>
+void casadi_interpn_batch(T1* res, casadi_int ndim, const T1* grid, const casadi_int* offset, const T1* values, const T1* x, const casadi_int* lookup_mode, const casadi_int* lookup_index, const casadi_int* lookup_offset, casadi_int m, casadi_int npoints, casadi_int* iw, T1* w) { // NOLINT(whitespace/line_length)
+  // Local variables
+  casadi_int i, j, k, l, ng, ld;
+  T1 xi;
+  const T1 *g, *v;
+  T1 *alpha, *a, *c, *r;
+  casadi_int *index, *ind, *pos, *corner;
+  // Work vectors
+  alpha = w; w += ndim*npoints;
+  c = w; w += npoints;
+  index = iw; iw += ndim*npoints;
+  pos = iw; iw += npoints;
+  corner = iw; iw += ndim;
+  // Left index and fraction of interval, stored dimension by dimension
+  for (i=0; i<ndim; ++i) {
+    g = grid + offset[i];
+    ng = offset[i+1]-offset[i];
+    a = alpha + i*npoints;
+    ind = index + i*npoints;
+    for (k=0; k<npoints; ++k) {
+      xi = x ? x[i+k*ndim] : 0;
+      if (lookup_mode[i]==3 && lookup_index) {
+        j = casadi_low_index(xi, g, ng, lookup_index + lookup_offset[i],
+                             lookup_offset[i+1]-lookup_offset[i]);
+      } else {
+        j = casadi_low(xi, g, ng, lookup_mode[i]);
+      }
+      ind[k] = j;
+      a[k] = (xi-g[j])/(g[j+1]-g[j]);
+    }
+  }
+  // Loop over all corners, add contribution to output
+  casadi_clear_casadi_int(corner, ndim);
+  casadi_clear(res, m*npoints);
+  do {
+    // Weight and position of the corner for each point
+    for (k=0; k<npoints; ++k) c[k] = 1;
+    casadi_clear_casadi_int(pos, npoints);
+    ld = 1;
+    for (i=0; i<ndim; ++i) {
+      a = alpha + i*npoints;
+      ind = index + i*npoints;
+      if (corner[i]) {
+        for (k=0; k<npoints; ++k) c[k] *= a[k];
+        for (k=0; k<npoints; ++k) pos[k] += (ind[k]+1)*ld;
+      } else {
+        for (k=0; k<npoints; ++k) c[k] *= 1-a[k];
+        for (k=0; k<npoints; ++k) pos[k] += ind[k]*ld;
+      }
+      ld *= offset[i+1]-offset[i];
+    }
+    // Accumulate
+    for (k=0; k<npoints; ++k) {
+      r = res + k*m;
+      v = values + pos[k]*m;
+      for (l=0; l<m; ++l) r[l] += c[k]*v[l];
+    }
+  } while (casadi_flip(corner, ndim));
+}
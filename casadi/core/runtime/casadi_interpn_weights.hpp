@@ -1,7 +1,9 @@
 // NOLINT(legal/copyright)
 // SYMBOL "interpn_weights"
+// lookup_index and lookup_offset hold the tables of dimensions with lookup
+// mode 3 (index), both may be null otherwise.
 template<typename T1>
-void casadi_interpn_weights(casadi_int ndim, const T1* grid, const casadi_int* offset, const T1* x, T1* alpha, casadi_int* index, const casadi_int* lookup_mode) { // NOLINT(whitespace/line_length)
+void casadi_interpn_weights(casadi_int ndim, const T1* grid, const casadi_int* offset, const T1* x, T1* alpha, casadi_int* index, const casadi_int* lookup_mode, const casadi_int* lookup_index, const casadi_int* lookup_offset) { // NOLINT(whitespace/line_length)
   // Left index and fraction of interval
   casadi_int i;
   for (i=0; i<ndim; ++i) {
@@ -14,7 +16,13 @@ void casadi_interpn_weights(casadi_int ndim, const T1* grid, const casadi_int* o
     g = grid + offset[i];
     ng = offset[i+1]-offset[i];
     // Find left index
-    j = index[i] = casadi_low(xi, g, ng, lookup_mode[i]);
+    if (lookup_mode[i]==3 && lookup_index) {
+      j = casadi_low_index(xi, g, ng, lookup_index + lookup_offset[i],
+                           lookup_offset[i+1]-lookup_offset[i]);
+    } else {
+      j = casadi_low(xi, g, ng, lookup_mode[i]);
+    }
+    index[i] = j;
     // Get interpolation/extrapolation alpha
     alpha[i] = (xi-g[j])/(g[j+1]-g[j]);
   }
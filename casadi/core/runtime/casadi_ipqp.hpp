@@ -0,0 +1,571 @@
+// NOLINT(legal/copyright)
+
+// C-REPLACE "fmin" "casadi_fmin"
+// C-REPLACE "fmax" "casadi_fmax"
+// C-REPLACE "std::numeric_limits<T1>::infinity()" "casadi_inf"
+// C-REPLACE "static_cast<T1*>(0)" "0"
+// C-REPLACE "static_cast<int>" "(int) "
+// SYMBOL "ipqp_prob"
+template<typename T1>
+struct casadi_ipqp_prob {
+  // Sparsity patterns
+  const casadi_int *sp_a, *sp_h, *sp_at, *sp_kkt;
+  // Symbolic QR factorization
+  const casadi_int *prinv, *pc, *sp_v, *sp_r;
+  // Dimensions
+  casadi_int nx, na, nz;
+  // Infinity
+  T1 inf;
+  // Maximum number of iterations
+  casadi_int max_iter;
+  // Primal, dual and complementarity error tolerance
+  T1 constr_viol_tol, dual_inf_tol, compl_tol;
+  // Fraction-to-the-boundary parameter
+  T1 tau;
+  // Initial value for slacks and bound multipliers
+  T1 init;
+};
+// C-REPLACE "casadi_ipqp_prob<T1>" "struct casadi_ipqp_prob"
+
+// SYMBOL "ipqp_setup"
+template<typename T1>
+void casadi_ipqp_setup(casadi_ipqp_prob<T1>* p) {
+  p->na = p->sp_a[0];
+  p->nx = p->sp_a[1];
+  p->nz = p->nx + p->na;
+  p->inf = std::numeric_limits<T1>::infinity();
+  p->max_iter = 100;
+  p->constr_viol_tol = 1e-8;
+  p->dual_inf_tol = 1e-8;
+  p->compl_tol = 1e-8;
+  p->tau = 0.995;
+  p->init = 1.;
+}
+
+// SYMBOL "ipqp_work"
+template<typename T1>
+void casadi_ipqp_work(const casadi_ipqp_prob<T1>* p, casadi_int* sz_iw, casadi_int* sz_w) {
+  // Local variables
+  casadi_int nnz_a, nnz_kkt, nnz_v, nnz_r;
+  // Get matrix number of nonzeros
+  nnz_a = p->sp_a[2+p->sp_a[1]];
+  nnz_kkt = p->sp_kkt[2+p->sp_kkt[1]];
+  nnz_v = p->sp_v[2+p->sp_v[1]];
+  nnz_r = p->sp_r[2+p->sp_r[1]];
+  // Reset sz_w, sz_iw
+  *sz_w = *sz_iw = 0;
+  // Temporary work vectors
+  *sz_w = casadi_max(*sz_w, p->nz); // KKT column
+  *sz_iw = casadi_max(*sz_iw, p->nz); // casadi_trans
+  *sz_w = casadi_max(*sz_w, 2*p->nz); // casadi_qr
+  // Persistent work vectors
+  *sz_w += nnz_kkt; // kkt
+  *sz_w += nnz_v + nnz_r; // v, r
+  *sz_w += p->nz; // beta
+  *sz_w += nnz_a; // trans(a)
+  *sz_w += p->nz; // z=[xk,gk]
+  *sz_w += p->nz; // lbz
+  *sz_w += p->nz; // ubz
+  *sz_w += p->nz; // lam
+  *sz_w += p->nz; // lam_l
+  *sz_w += p->nz; // lam_u
+  *sz_w += p->nz; // s_l
+  *sz_w += p->nz; // s_u
+  *sz_w += p->nz; // dz
+  *sz_w += p->nz; // dlam
+  *sz_w += p->nz; // dlam_l
+  *sz_w += p->nz; // dlam_u
+  *sz_w += p->nz; // ds_l
+  *sz_w += p->nz; // ds_u
+  *sz_w += p->nz; // c_l
+  *sz_w += p->nz; // c_u
+  *sz_w += p->nz; // D
+  *sz_w += p->nx; // rd
+}
+
+// SYMBOL "ipqp_flag_t"
+typedef enum {
+  IPQP_SUCCESS,
+  IPQP_MAX_ITER,
+  IPQP_NO_SEARCH_DIR,
+  IPQP_PRINTING_ERROR
+} casadi_ipqp_flag_t;
+
+// SYMBOL "ipqp_data"
+template<typename T1>
+struct casadi_ipqp_data {
+  // Problem structure
+  const casadi_ipqp_prob<T1>* prob;
+  // Solver status
+  casadi_ipqp_flag_t status;
+  // Cost
+  T1 f;
+  // QP data
+  const T1 *nz_a, *nz_h, *g;
+  // Primal variables, bounds and multipliers
+  T1 *z, *lbz, *ubz, *lam;
+  // Slacks and multipliers for the lower and upper bounds
+  T1 *s_l, *s_u, *lam_l, *lam_u;
+  // Search direction
+  T1 *dz, *dlam, *ds_l, *ds_u, *dlam_l, *dlam_u;
+  // Complementarity right-hand-sides
+  T1 *c_l, *c_u;
+  // Diagonal entries of the KKT matrix
+  T1 *D;
+  // Dual residual
+  T1 *rd;
+  // Work vectors
+  T1 *w;
+  casadi_int *iw;
+  // Numeric QR factorization
+  T1 *nz_at, *nz_kkt, *beta, *nz_v, *nz_r;
+  // Message buffer
+  const char *msg;
+  // Primal, dual and complementarity error, corresponding index
+  T1 pr, du, mu;
+  casadi_int ipr, idu;
+  // Number of inequality bounds
+  casadi_int n_ineq;
+  // Centering parameter and step size
+  T1 sigma, alpha;
+  // Iteration
+  casadi_int iter;
+};
+// C-REPLACE "casadi_ipqp_data<T1>" "struct casadi_ipqp_data"
+
+// SYMBOL "ipqp_init"
+template<typename T1>
+void casadi_ipqp_init(casadi_ipqp_data<T1>* d, casadi_int** iw, T1** w) {
+  // Local variables
+  casadi_int nnz_a, nnz_kkt, nnz_v, nnz_r;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  // Get matrix number of nonzeros
+  nnz_a = p->sp_a[2+p->sp_a[1]];
+  nnz_kkt = p->sp_kkt[2+p->sp_kkt[1]];
+  nnz_v = p->sp_v[2+p->sp_v[1]];
+  nnz_r = p->sp_r[2+p->sp_r[1]];
+  d->nz_kkt = *w; *w += nnz_kkt;
+  d->nz_v = *w; *w += nnz_v + nnz_r;
+  d->nz_r = d->nz_v + nnz_v;
+  d->beta = *w; *w += p->nz;
+  d->nz_at = *w; *w += nnz_a;
+  d->z = *w; *w += p->nz;
+  d->lbz = *w; *w += p->nz;
+  d->ubz = *w; *w += p->nz;
+  d->lam = *w; *w += p->nz;
+  d->lam_l = *w; *w += p->nz;
+  d->lam_u = *w; *w += p->nz;
+  d->s_l = *w; *w += p->nz;
+  d->s_u = *w; *w += p->nz;
+  d->dz = *w; *w += p->nz;
+  d->dlam = *w; *w += p->nz;
+  d->dlam_l = *w; *w += p->nz;
+  d->dlam_u = *w; *w += p->nz;
+  d->ds_l = *w; *w += p->nz;
+  d->ds_u = *w; *w += p->nz;
+  d->c_l = *w; *w += p->nz;
+  d->c_u = *w; *w += p->nz;
+  d->D = *w; *w += p->nz;
+  d->rd = *w; *w += p->nx;
+  d->w = *w;
+  d->iw = *iw;
+}
+
+// SYMBOL "ipqp_reset"
+// Bounds are classified as free (no finite bounds), equality (lbz==ubz) or
+// inequality (all others). Inequality bounds get slacks s_l, s_u and
+// multipliers lam_l, lam_u, with lam = lam_u - lam_l.
+template<typename T1>
+int casadi_ipqp_reset(casadi_ipqp_data<T1>* d) {
+  // Local variables
+  casadi_int i;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  // Reset variables corresponding to previous iteration
+  d->msg = 0;
+  d->sigma = 0.;
+  d->alpha = 0.;
+  d->iter = 0;
+  // Transpose A
+  casadi_trans(d->nz_a, p->sp_a, d->nz_at, p->sp_at, d->iw);
+  // Equality constrained variables are fixed from the start
+  for (i=0; i<p->nx; ++i) if (d->lbz[i]==d->ubz[i]) d->z[i] = d->lbz[i];
+  // Calculate z[nx:]
+  casadi_clear(d->z+p->nx, p->na);
+  casadi_mv(d->nz_a, p->sp_a, d->z, d->z+p->nx, 0);
+  // Initial slacks and multipliers
+  d->n_ineq = 0;
+  for (i=0; i<p->nz; ++i) {
+    // Consistent bounds
+    if (d->lbz[i] > d->ubz[i]) return 1;
+    d->s_l[i] = d->s_u[i] = d->lam_l[i] = d->lam_u[i] = 0.;
+    if (d->lbz[i]==d->ubz[i]) {
+      // Equality constraint, multiplier is unrestricted
+      continue;
+    }
+    // No multiplier for free variables and constraints
+    d->lam[i] = 0.;
+    if (d->lbz[i] > -p->inf) {
+      d->s_l[i] = fmax(p->init, d->z[i] - d->lbz[i]);
+      d->lam_l[i] = p->init;
+      d->n_ineq++;
+    }
+    if (d->ubz[i] < p->inf) {
+      d->s_u[i] = fmax(p->init, d->ubz[i] - d->z[i]);
+      d->lam_u[i] = p->init;
+      d->n_ineq++;
+    }
+    d->lam[i] = d->lam_u[i] - d->lam_l[i];
+  }
+  return 0;
+}
+
+// SYMBOL "ipqp_residual"
+template<typename T1>
+void casadi_ipqp_residual(casadi_ipqp_data<T1>* d) {
+  // Local variables
+  casadi_int i;
+  T1 r;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  // Calculate f
+  d->f = casadi_bilin(d->nz_h, p->sp_h, d->z, d->z)/2.
+       + casadi_dot(p->nx, d->z, d->g);
+  // Calculate z[nx:]
+  casadi_clear(d->z+p->nx, p->na);
+  casadi_mv(d->nz_a, p->sp_a, d->z, d->z+p->nx, 0);
+  // Dual residual: rd = g + H*x + A'*lam_a + lam_x
+  casadi_copy(d->g, p->nx, d->rd);
+  casadi_mv(d->nz_h, p->sp_h, d->z, d->rd, 0);
+  casadi_mv(d->nz_a, p->sp_a, d->lam+p->nx, d->rd, 1);
+  casadi_axpy(p->nx, 1., d->lam, d->rd);
+  // Dual error
+  d->du = 0;
+  d->idu = -1;
+  for (i=0; i<p->nx; ++i) {
+    if (fabs(d->rd[i]) > d->du) {
+      d->du = fabs(d->rd[i]);
+      d->idu = i;
+    }
+  }
+  // Primal error and complementarity
+  d->pr = 0;
+  d->ipr = -1;
+  d->mu = 0;
+  for (i=0; i<p->nz; ++i) {
+    if (d->lbz[i]==d->ubz[i]) {
+      // Equality constraint
+      r = fabs(d->z[i] - d->lbz[i]);
+      if (r > d->pr) {
+        d->pr = r;
+        d->ipr = i;
+      }
+      continue;
+    }
+    if (d->lbz[i] > -p->inf) {
+      r = fabs(d->z[i] - d->lbz[i] - d->s_l[i]);
+      if (r > d->pr) {
+        d->pr = r;
+        d->ipr = i;
+      }
+      d->mu += d->s_l[i] * d->lam_l[i];
+    }
+    if (d->ubz[i] < p->inf) {
+      r = fabs(d->ubz[i] - d->z[i] - d->s_u[i]);
+      if (r > d->pr) {
+        d->pr = r;
+        d->ipr = i;
+      }
+      d->mu += d->s_u[i] * d->lam_u[i];
+    }
+  }
+  if (d->n_ineq > 0) d->mu /= d->n_ineq;
+}
+
+// SYMBOL "ipqp_kkt"
+// Assemble the KKT matrix for the step in [x, lam_a], with pattern [H A'; A I]:
+//   [H + D_x, A'; A, -D_a]
+// Rows corresponding to fixed variables and free constraints are replaced by
+// identity rows.
+template<typename T1>
+void casadi_ipqp_kkt(casadi_ipqp_data<T1>* d) {
+  // Local variables
+  casadi_int i, k, r;
+  const casadi_int *h_colind, *h_row, *a_colind, *a_row, *at_colind, *at_row,
+                   *kkt_colind, *kkt_row;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  // Extract sparsities
+  a_row = (a_colind = p->sp_a+2) + p->nx + 1;
+  at_row = (at_colind = p->sp_at+2) + p->na + 1;
+  h_row = (h_colind = p->sp_h+2) + p->nx + 1;
+  kkt_row = (kkt_colind = p->sp_kkt+2) + p->nz + 1;
+  // Reset w to zero
+  casadi_clear(d->w, p->nz);
+  // Loop over columns of the KKT
+  for (i=0; i<p->nz; ++i) {
+    // Copy column of KKT to w
+    if (i<p->nx) {
+      for (k=h_colind[i]; k<h_colind[i+1]; ++k) d->w[h_row[k]] = d->nz_h[k];
+      for (k=a_colind[i]; k<a_colind[i+1]; ++k) d->w[p->nx+a_row[k]] = d->nz_a[k];
+      d->w[i] += d->D[i];
+    } else {
+      for (k=at_colind[i-p->nx]; k<at_colind[i-p->nx+1]; ++k) {
+        d->w[at_row[k]] = d->nz_at[k];
+      }
+      d->w[i] = -d->D[i];
+    }
+    // Copy column to KKT, zero out w
+    for (k=kkt_colind[i]; k<kkt_colind[i+1]; ++k) {
+      r = kkt_row[k];
+      if (r<p->nx ? d->lbz[r]==d->ubz[r]
+                  : d->lbz[r]==-p->inf && d->ubz[r]==p->inf) {
+        // Identity row
+        d->nz_kkt[k] = r==i ? 1. : 0.;
+      } else {
+        d->nz_kkt[k] = d->w[r];
+      }
+      d->w[r] = 0;
+    }
+  }
+}
+
+// SYMBOL "ipqp_factorize"
+template<typename T1>
+int casadi_ipqp_factorize(casadi_ipqp_data<T1>* d) {
+  // Local variables
+  casadi_int i;
+  T1 D;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  // Diagonal contribution from the eliminated slacks and bound multipliers
+  for (i=0; i<p->nz; ++i) {
+    D = 0;
+    if (d->lbz[i]!=d->ubz[i]) {
+      if (d->lbz[i] > -p->inf) D += d->lam_l[i] / d->s_l[i];
+      if (d->ubz[i] < p->inf) D += d->lam_u[i] / d->s_u[i];
+    }
+    // For the constraints, the inverse enters the KKT matrix
+    if (i>=p->nx) D = D==0 ? 0 : 1./D;
+    d->D[i] = D;
+  }
+  // Construct the KKT matrix
+  casadi_ipqp_kkt(d);
+  // QR factorization
+  casadi_qr(p->sp_kkt, d->nz_kkt, d->w, p->sp_v, d->nz_v, p->sp_r,
+            d->nz_r, d->beta, p->prinv, p->pc);
+  // Check singularity
+  return casadi_qr_singular(static_cast<T1*>(0), 0, d->nz_r, p->sp_r, p->pc, 1e-12) > 0;
+}
+
+// SYMBOL "ipqp_step"
+// Calculate the search direction for given complementarity right-hand-sides
+// c_l = lam_l.*ds_l + s_l.*dlam_l, c_u = lam_u.*ds_u + s_u.*dlam_u
+template<typename T1>
+void casadi_ipqp_step(casadi_ipqp_data<T1>* d) {
+  // Local variables
+  casadi_int i;
+  T1 e;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  // Form the right-hand-side
+  for (i=0; i<p->nz; ++i) {
+    if (d->lbz[i]==d->ubz[i]) {
+      // Equality constraint
+      d->dz[i] = d->lbz[i] - d->z[i];
+      continue;
+    }
+    // Step in lam is e + D*dz, with e from the eliminated variables
+    e = 0;
+    if (d->lbz[i] > -p->inf) {
+      e -= (d->c_l[i] - d->lam_l[i]*(d->z[i] - d->lbz[i] - d->s_l[i])) / d->s_l[i];
+    }
+    if (d->ubz[i] < p->inf) {
+      e += (d->c_u[i] - d->lam_u[i]*(d->ubz[i] - d->z[i] - d->s_u[i])) / d->s_u[i];
+    }
+    if (i<p->nx) {
+      d->dz[i] = -d->rd[i] - e;
+    } else if (d->lbz[i]==-p->inf && d->ubz[i]==p->inf) {
+      // Free constraint
+      d->dz[i] = -d->lam[i];
+    } else {
+      d->dz[i] = -d->D[i] * e;
+    }
+    // Save e for expanding the step
+    d->dlam[i] = e;
+  }
+  // Solve to get step in z[:nx] and lam[nx:]
+  casadi_qr_solve(d->dz, 1, 0, p->sp_v, d->nz_v, p->sp_r, d->nz_r, d->beta,
+                  p->prinv, p->pc, d->w);
+  // Step in lam[:nx]
+  for (i=0; i<p->nx; ++i) {
+    if (d->lbz[i]!=d->ubz[i]) d->dlam[i] += (d->D[i]) * d->dz[i];
+  }
+  // Step in lam[nx:]
+  casadi_copy(d->dz+p->nx, p->na, d->dlam+p->nx);
+  // Step in z[nx:]
+  casadi_clear(d->dz + p->nx, p->na);
+  casadi_mv(d->nz_a, p->sp_a, d->dz, d->dz + p->nx, 0);
+  // Step in lam[:nx] for fixed variables from the dual residual
+  casadi_copy(d->rd, p->nx, d->w);
+  casadi_mv(d->nz_h, p->sp_h, d->dz, d->w, 0);
+  casadi_mv(d->nz_a, p->sp_a, d->dlam+p->nx, d->w, 1);
+  for (i=0; i<p->nx; ++i) {
+    if (d->lbz[i]==d->ubz[i]) d->dlam[i] = -d->w[i];
+  }
+  // Steps in the slacks and bound multipliers
+  for (i=0; i<p->nz; ++i) {
+    d->ds_l[i] = d->ds_u[i] = d->dlam_l[i] = d->dlam_u[i] = 0;
+    if (d->lbz[i]==d->ubz[i]) continue;
+    if (d->lbz[i] > -p->inf) {
+      d->ds_l[i] = d->dz[i] + d->z[i] - d->lbz[i] - d->s_l[i];
+      d->dlam_l[i] = (d->c_l[i] - d->lam_l[i]*d->ds_l[i]) / d->s_l[i];
+    }
+    if (d->ubz[i] < p->inf) {
+      d->ds_u[i] = -d->dz[i] + d->ubz[i] - d->z[i] - d->s_u[i];
+      d->dlam_u[i] = (d->c_u[i] - d->lam_u[i]*d->ds_u[i]) / d->s_u[i];
+    }
+  }
+}
+
+// SYMBOL "ipqp_max_step"
+// Largest step in (0, 1] keeping slacks and bound multipliers positive
+template<typename T1>
+T1 casadi_ipqp_max_step(casadi_ipqp_data<T1>* d, T1 tau) {
+  // Local variables
+  casadi_int i;
+  T1 alpha;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  alpha = 1.;
+  for (i=0; i<p->nz; ++i) {
+    if (d->ds_l[i] < 0) alpha = fmin(alpha, -tau*d->s_l[i]/d->ds_l[i]);
+    if (d->ds_u[i] < 0) alpha = fmin(alpha, -tau*d->s_u[i]/d->ds_u[i]);
+    if (d->dlam_l[i] < 0) alpha = fmin(alpha, -tau*d->lam_l[i]/d->dlam_l[i]);
+    if (d->dlam_u[i] < 0) alpha = fmin(alpha, -tau*d->lam_u[i]/d->dlam_u[i]);
+  }
+  return alpha;
+}
+
+// SYMBOL "ipqp_prepare"
+template<typename T1>
+int casadi_ipqp_prepare(casadi_ipqp_data<T1>* d) {
+  // Local variables
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  // Calculate residuals
+  casadi_ipqp_residual(d);
+  // Termination message
+  if (d->pr <= p->constr_viol_tol && d->du <= p->dual_inf_tol && d->mu <= p->compl_tol) {
+    d->status = IPQP_SUCCESS;
+    d->msg = "Converged";
+    return 1;
+  } else if (d->iter >= p->max_iter) {
+    d->status = IPQP_MAX_ITER;
+    d->msg = "Max iter";
+    return 1;
+  }
+  // Form and factorize the KKT system
+  if (casadi_ipqp_factorize(d)) {
+    d->status = IPQP_NO_SEARCH_DIR;
+    d->msg = "Singular KKT system";
+    return 1;
+  }
+  // Keep iterating
+  return 0;
+}
+
+// SYMBOL "ipqp_iterate"
+// Mehrotra predictor-corrector step
+template<typename T1>
+int casadi_ipqp_iterate(casadi_ipqp_data<T1>* d) {
+  // Local variables
+  casadi_int i;
+  T1 alpha, mu_aff;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  // Reset message flag
+  d->msg = 0;
+  // Start a new iteration
+  d->iter++;
+  // Affine scaling (predictor) direction
+  for (i=0; i<p->nz; ++i) {
+    d->c_l[i] = -d->lam_l[i]*d->s_l[i];
+    d->c_u[i] = -d->lam_u[i]*d->s_u[i];
+  }
+  casadi_ipqp_step(d);
+  // Complementarity after the affine step
+  alpha = casadi_ipqp_max_step(d, 1.);
+  mu_aff = 0;
+  for (i=0; i<p->nz; ++i) {
+    mu_aff += (d->s_l[i] + alpha*d->ds_l[i]) * (d->lam_l[i] + alpha*d->dlam_l[i]);
+    mu_aff += (d->s_u[i] + alpha*d->ds_u[i]) * (d->lam_u[i] + alpha*d->dlam_u[i]);
+  }
+  if (d->n_ineq > 0) mu_aff /= d->n_ineq;
+  // Centering parameter
+  d->sigma = d->mu > 0 ? mu_aff / d->mu : 0;
+  d->sigma = d->sigma * d->sigma * d->sigma;
+  // Centering-corrector direction, reusing the factorization
+  for (i=0; i<p->nz; ++i) {
+    if (d->lbz[i] > -p->inf && d->lbz[i]!=d->ubz[i]) {
+      d->c_l[i] = d->sigma*d->mu - d->lam_l[i]*d->s_l[i] - d->ds_l[i]*d->dlam_l[i];
+    }
+    if (d->ubz[i] < p->inf && d->lbz[i]!=d->ubz[i]) {
+      d->c_u[i] = d->sigma*d->mu - d->lam_u[i]*d->s_u[i] - d->ds_u[i]*d->dlam_u[i];
+    }
+  }
+  casadi_ipqp_step(d);
+  // Take a step, staying in the interior
+  d->alpha = casadi_ipqp_max_step(d, p->tau);
+  casadi_axpy(p->nx, d->alpha, d->dz, d->z);
+  casadi_axpy(p->nz, d->alpha, d->dlam, d->lam);
+  casadi_axpy(p->nz, d->alpha, d->ds_l, d->s_l);
+  casadi_axpy(p->nz, d->alpha, d->ds_u, d->s_u);
+  casadi_axpy(p->nz, d->alpha, d->dlam_l, d->lam_l);
+  casadi_axpy(p->nz, d->alpha, d->dlam_u, d->lam_u);
+  // Keep iterating
+  return 0;
+}
+
+// The following routines require stdio
+#ifndef CASADI_PRINTF
+
+// SYMBOL "ipqp_print_header"
+template<typename T1>
+int casadi_ipqp_print_header(casadi_ipqp_data<T1>* d, char* buf, size_t buf_sz) {
+  int flag;
+  // Print to string
+  flag = snprintf(buf, buf_sz, "%5s %9s %9s %5s %9s %5s %9s %9s %9s  %4s",
+          "Iter", "fk", "|pr|", "con", "|du|", "var", "mu", "sigma", "alpha", "Note");
+  // Check if error
+  if (flag < 0) {
+    d->status = IPQP_PRINTING_ERROR;
+    return 1;
+  }
+  // Successful return
+  return 0;
+}
+
+// SYMBOL "ipqp_print_iteration"
+template<typename T1>
+int casadi_ipqp_print_iteration(casadi_ipqp_data<T1>* d, char* buf, int buf_sz) {
+  int flag;
+  // Print iteration data without note to string
+  flag = snprintf(buf, buf_sz,
+    "%5d %9.2g %9.2g %5d %9.2g %5d %9.2g %9.2g %9.2g  ",
+    static_cast<int>(d->iter), d->f, d->pr, static_cast<int>(d->ipr),
+    d->du, static_cast<int>(d->idu), d->mu, d->sigma, d->alpha);
+  // Check if error
+  if (flag < 0) {
+    d->status = IPQP_PRINTING_ERROR;
+    return 1;
+  }
+  // Rest of buffer reserved for iteration note
+  buf += flag;
+  buf_sz -= flag;
+  // Print iteration note, if any
+  if (d->msg) {
+    flag = snprintf(buf, buf_sz, "%s", d->msg);
+    // Check if error
+    if (flag < 0) {
+      d->status = IPQP_PRINTING_ERROR;
+      return 1;
+    }
+  }
+  // Successful return
+  return 0;
+}
+
+#endif  // CASADI_PRINTF
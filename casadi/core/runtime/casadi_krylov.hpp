@@ -0,0 +1,555 @@
+// NOLINT(legal/copyright)
+
+// C-REPLACE "fabs" "casadi_fabs"
+// SYMBOL "krylov_method_t"
+typedef enum {
+  KRYLOV_CG,
+  KRYLOV_MINRES,
+  KRYLOV_GMRES
+} casadi_krylov_method_t;
+
+// SYMBOL "krylov_precon_t"
+typedef enum {
+  KRYLOV_PRECON_NONE,
+  KRYLOV_PRECON_JACOBI,
+  KRYLOV_PRECON_ILU0,
+  KRYLOV_PRECON_IC0
+} casadi_krylov_precon_t;
+
+// SYMBOL "krylov_flag_t"
+typedef enum {
+  KRYLOV_SUCCESS,
+  KRYLOV_MAX_ITER,
+  KRYLOV_BREAKDOWN,
+  KRYLOV_PRECON_FAIL
+} casadi_krylov_flag_t;
+
+// SYMBOL "krylov_prob"
+template<typename T1>
+struct casadi_krylov_prob {
+  // Sparsity pattern of the (square) matrix, null if matrix-free
+  const casadi_int *sp_a;
+  // Dimension
+  casadi_int n;
+  // Iterative method
+  casadi_krylov_method_t method;
+  // Preconditioner, requires sp_a unless KRYLOV_PRECON_NONE
+  casadi_krylov_precon_t precon;
+  // GMRES restart length
+  casadi_int restart;
+  // Maximum number of iterations
+  casadi_int max_iter;
+  // Relative residual tolerance
+  T1 tol;
+};
+// C-REPLACE "casadi_krylov_prob<T1>" "struct casadi_krylov_prob"
+
+// SYMBOL "krylov_setup"
+template<typename T1>
+void casadi_krylov_setup(casadi_krylov_prob<T1>* p, const casadi_int* sp_a, casadi_int n) {
+  p->sp_a = sp_a;
+  p->n = n;
+  p->method = KRYLOV_GMRES;
+  p->precon = sp_a ? KRYLOV_PRECON_ILU0 : KRYLOV_PRECON_NONE;
+  p->restart = n < 30 ? n : 30;
+  p->max_iter = 10*n;
+  p->tol = 1e-10;
+}
+
+// SYMBOL "krylov_work"
+template<typename T1>
+void casadi_krylov_work(const casadi_krylov_prob<T1>* p, casadi_int* sz_iw, casadi_int* sz_w) {
+  // Local variables
+  casadi_int n, m;
+  n = p->n;
+  m = p->restart;
+  // Reset sz_w, sz_iw
+  *sz_w = *sz_iw = 0;
+  // Preconditioner
+  if (p->precon==KRYLOV_PRECON_JACOBI) {
+    *sz_w += n; // inverse diagonal
+  } else if (p->precon!=KRYLOV_PRECON_NONE) {
+    *sz_w += p->sp_a[2+n]; // incomplete factors
+    *sz_iw += 2*n; // diagonal positions, scatter
+  }
+  // Right-hand-side
+  *sz_w += n;
+  // Method specific vectors
+  if (p->method==KRYLOV_CG) {
+    *sz_w += 4*n; // r, z, p, q
+  } else if (p->method==KRYLOV_MINRES) {
+    *sz_w += 7*n; // r1, r2, y, v, w, w1, w2
+  } else {
+    *sz_w += (m+1)*n; // Krylov basis
+    *sz_w += (m+1)*m; // Hessenberg matrix
+    *sz_w += 2*m + m+1; // Givens rotations, residual vector
+    *sz_w += n; // preconditioned basis vector
+  }
+}
+
+// SYMBOL "krylov_data"
+template<typename T1>
+struct casadi_krylov_data {
+  // Problem structure
+  const casadi_krylov_prob<T1>* prob;
+  // Solver status
+  casadi_krylov_flag_t status;
+  // Matrix nonzeros, used by the preconditioner
+  const T1* nz_a;
+  // Solution (right-hand-side on entry), right-hand-side
+  T1 *x, *b;
+  // Preconditioner nonzeros
+  T1* pc;
+  // Diagonal positions, scatter vector
+  casadi_int *diag, *iw;
+  // Matrix-vector product requested by casadi_krylov_iterate: mv_out = A*mv_in
+  const T1* mv_in;
+  T1* mv_out;
+  // Work vectors
+  T1 *r, *z, *p, *q, *v, *y, *w, *w1, *w2;
+  // GMRES storage
+  T1 *h, *cs, *sn, *g;
+  // Transposed solve
+  casadi_int tr;
+  // Iteration, state, GMRES inner iteration
+  casadi_int iter, state, j;
+  // Norm of the right-hand-side, residual norm
+  T1 bnorm, res;
+  // CG and MINRES scalars
+  T1 rz, beta, beta1, oldb, dbar, epsln, phibar, c, s;
+};
+// C-REPLACE "casadi_krylov_data<T1>" "struct casadi_krylov_data"
+
+// SYMBOL "krylov_init"
+template<typename T1>
+void casadi_krylov_init(casadi_krylov_data<T1>* d, casadi_int** iw, T1** w) {
+  // Local variables
+  casadi_int n, m;
+  const casadi_krylov_prob<T1>* p = d->prob;
+  n = p->n;
+  m = p->restart;
+  // Preconditioner
+  d->pc = *w;
+  if (p->precon==KRYLOV_PRECON_JACOBI) {
+    *w += n;
+  } else if (p->precon!=KRYLOV_PRECON_NONE) {
+    *w += p->sp_a[2+n];
+    d->diag = *iw; *iw += n;
+    d->iw = *iw; *iw += n;
+  }
+  d->b = *w; *w += n;
+  if (p->method==KRYLOV_CG) {
+    d->r = *w; *w += n;
+    d->z = *w; *w += n;
+    d->p = *w; *w += n;
+    d->q = *w; *w += n;
+  } else if (p->method==KRYLOV_MINRES) {
+    d->r = *w; *w += n;
+    d->q = *w; *w += n;
+    d->y = *w; *w += n;
+    d->v = *w; *w += n;
+    d->w = *w; *w += n;
+    d->w1 = *w; *w += n;
+    d->w2 = *w; *w += n;
+  } else {
+    d->v = *w; *w += (m+1)*n;
+    d->h = *w; *w += (m+1)*m;
+    d->cs = *w; *w += m;
+    d->sn = *w; *w += m;
+    d->g = *w; *w += m+1;
+    d->z = *w; *w += n;
+  }
+}
+
+// SYMBOL "krylov_precon_fact"
+// Compute the preconditioner from d->nz_a. ILU(0) and IC(0) keep the sparsity
+// pattern of A, which must have sorted rows and a structurally nonzero diagonal.
+// IC(0) is formed as L*D*L' from the ILU(0) factors, exact for symmetric A.
+// Returns nonzero if a zero (or, for IC(0), nonpositive) pivot is encountered
+template<typename T1>
+int casadi_krylov_precon_fact(casadi_krylov_data<T1>* d) {
+  // Local variables
+  casadi_int n, c, r, i, k, kk;
+  const casadi_int *colind, *row;
+  T1 u, piv;
+  const casadi_krylov_prob<T1>* p = d->prob;
+  if (p->precon==KRYLOV_PRECON_NONE) return 0;
+  n = p->n;
+  colind = p->sp_a + 2;
+  row = p->sp_a + 2 + n + 1;
+  if (p->precon==KRYLOV_PRECON_JACOBI) {
+    for (c=0; c<n; ++c) {
+      d->pc[c] = 0;
+      for (k=colind[c]; k<colind[c+1]; ++k) {
+        if (row[k]==c) d->pc[c] = d->nz_a[k];
+      }
+      if (d->pc[c]==0) return 1;
+      d->pc[c] = 1/d->pc[c];
+    }
+    return 0;
+  }
+  // Locate diagonal entries
+  for (c=0; c<n; ++c) {
+    d->diag[c] = -1;
+    d->iw[c] = -1;
+    for (k=colind[c]; k<colind[c+1]; ++k) {
+      if (row[k]==c) d->diag[c] = k;
+    }
+    if (d->diag[c]<0) return 1;
+  }
+  // Left-looking ILU(0), restricted to the pattern of A
+  casadi_copy(d->nz_a, colind[n], d->pc);
+  for (c=0; c<n; ++c) {
+    // Scatter column c
+    for (k=colind[c]; k<colind[c+1]; ++k) d->iw[row[k]] = k;
+    // Apply updates from columns r<c, in increasing order
+    for (k=colind[c]; k<colind[c+1]; ++k) {
+      r = row[k];
+      if (r>=c) break;
+      u = d->pc[k];
+      for (kk=d->diag[r]+1; kk<colind[r+1]; ++kk) {
+        i = d->iw[row[kk]];
+        if (i>=0) d->pc[i] -= d->pc[kk]*u;
+      }
+    }
+    // Scale the strictly lower part
+    piv = d->pc[d->diag[c]];
+    if (piv==0) return 1;
+    if (p->precon==KRYLOV_PRECON_IC0 && piv<0) return 1;
+    for (k=d->diag[c]+1; k<colind[c+1]; ++k) d->pc[k] /= piv;
+    // Gather
+    for (k=colind[c]; k<colind[c+1]; ++k) d->iw[row[k]] = -1;
+  }
+  return 0;
+}
+
+// SYMBOL "krylov_precon_solve"
+// Apply the inverse of the preconditioner in-place
+template<typename T1>
+void casadi_krylov_precon_solve(const casadi_krylov_data<T1>* d, T1* x, casadi_int tr) {
+  // Local variables
+  casadi_int n, c, k;
+  const casadi_int *colind, *row;
+  const casadi_krylov_prob<T1>* p = d->prob;
+  if (p->precon==KRYLOV_PRECON_NONE) return;
+  n = p->n;
+  if (p->precon==KRYLOV_PRECON_JACOBI) {
+    for (c=0; c<n; ++c) x[c] *= d->pc[c];
+    return;
+  }
+  colind = p->sp_a + 2;
+  row = p->sp_a + 2 + n + 1;
+  if (tr && p->precon==KRYLOV_PRECON_ILU0) {
+    // Solve with U'
+    for (c=0; c<n; ++c) {
+      for (k=colind[c]; k<d->diag[c]; ++k) x[c] -= d->pc[k]*x[row[k]];
+      x[c] /= d->pc[d->diag[c]];
+    }
+  } else {
+    // Solve with L
+    for (c=0; c<n; ++c) {
+      for (k=d->diag[c]+1; k<colind[c+1]; ++k) x[row[k]] -= d->pc[k]*x[c];
+    }
+    if (p->precon==KRYLOV_PRECON_IC0) {
+      // Solve with D
+      for (c=0; c<n; ++c) x[c] /= d->pc[d->diag[c]];
+    } else {
+      // Solve with U
+      for (c=n-1; c>=0; --c) {
+        x[c] /= d->pc[d->diag[c]];
+        for (k=colind[c]; k<d->diag[c]; ++k) x[row[k]] -= d->pc[k]*x[c];
+      }
+      return;
+    }
+  }
+  // Solve with L'
+  for (c=n-1; c>=0; --c) {
+    for (k=d->diag[c]+1; k<colind[c+1]; ++k) x[c] -= d->pc[k]*x[row[k]];
+  }
+}
+
+// SYMBOL "krylov_reset"
+// Start a new solve, right-hand-side in d->x, zero initial guess
+template<typename T1>
+void casadi_krylov_reset(casadi_krylov_data<T1>* d, casadi_int tr) {
+  casadi_copy(d->x, d->prob->n, d->b);
+  casadi_clear(d->x, d->prob->n);
+  d->tr = tr;
+  d->iter = 0;
+  d->state = 0;
+  d->status = KRYLOV_SUCCESS;
+}
+
+// SYMBOL "krylov_cg"
+// Preconditioned conjugate gradients, A and the preconditioner must be SPD
+template<typename T1>
+int casadi_krylov_cg(casadi_krylov_data<T1>* d) {
+  // Local variables
+  casadi_int n, i;
+  T1 pq, alpha, rz, beta;
+  const casadi_krylov_prob<T1>* p = d->prob;
+  n = p->n;
+  if (d->state==0) {
+    // Initial residual
+    casadi_copy(d->b, n, d->r);
+  } else {
+    // Step length
+    pq = casadi_dot(n, d->p, d->q);
+    if (pq<=0) {
+      d->status = KRYLOV_BREAKDOWN;
+      return 0;
+    }
+    alpha = d->rz/pq;
+    casadi_axpy(n, alpha, d->p, d->x);
+    casadi_axpy(n, -alpha, d->q, d->r);
+    d->iter++;
+  }
+  // Check convergence
+  d->res = casadi_norm_2(n, d->r);
+  if (d->state==0) d->bnorm = d->res;
+  if (d->res <= p->tol*d->bnorm) return 0;
+  if (d->iter >= p->max_iter) {
+    d->status = KRYLOV_MAX_ITER;
+    return 0;
+  }
+  // New search direction
+  casadi_copy(d->r, n, d->z);
+  casadi_krylov_precon_solve(d, d->z, d->tr);
+  rz = casadi_dot(n, d->r, d->z);
+  if (d->state==0) {
+    casadi_copy(d->z, n, d->p);
+  } else {
+    beta = rz/d->rz;
+    for (i=0; i<n; ++i) d->p[i] = d->z[i] + beta*d->p[i];
+  }
+  d->rz = rz;
+  // Request q = A*p
+  d->mv_in = d->p;
+  d->mv_out = d->q;
+  d->state = 1;
+  return 1;
+}
+
+// SYMBOL "krylov_minres"
+// Preconditioned MINRES (Paige & Saunders), A symmetric, preconditioner SPD.
+// Convergence is measured in the preconditioned residual norm.
+// Ref: scipy
+template<typename T1>
+int casadi_krylov_minres(casadi_krylov_data<T1>* d) {
+  // Local variables
+  casadi_int n, i;
+  T1 alfa, oldeps, delta, gbar, gamma, phi;
+  const casadi_krylov_prob<T1>* p = d->prob;
+  n = p->n;
+  if (d->state==0) {
+    // r1 = r2 = b, y = M\b
+    casadi_copy(d->b, n, d->r);
+    casadi_copy(d->b, n, d->q);
+    casadi_copy(d->b, n, d->y);
+    casadi_krylov_precon_solve(d, d->y, d->tr);
+    d->beta1 = casadi_dot(n, d->b, d->y);
+    if (d->beta1<0) {
+      d->status = KRYLOV_PRECON_FAIL;
+      return 0;
+    }
+    d->beta1 = sqrt(d->beta1);
+    if (d->beta1==0) return 0;
+    d->oldb = 0;
+    d->beta = d->beta1;
+    d->dbar = 0;
+    d->epsln = 0;
+    d->phibar = d->beta1;
+    d->c = -1;
+    d->s = 0;
+    casadi_clear(d->w, n);
+    casadi_clear(d->w2, n);
+  } else {
+    d->iter++;
+    // Lanczos step, d->y holds A*v
+    if (d->iter>=2) casadi_axpy(n, -d->beta/d->oldb, d->r, d->y);
+    alfa = casadi_dot(n, d->v, d->y);
+    casadi_axpy(n, -alfa/d->beta, d->q, d->y);
+    casadi_copy(d->q, n, d->r);
+    casadi_copy(d->y, n, d->q);
+    casadi_krylov_precon_solve(d, d->y, d->tr);
+    d->oldb = d->beta;
+    d->beta = casadi_dot(n, d->q, d->y);
+    if (d->beta<0) {
+      d->status = KRYLOV_PRECON_FAIL;
+      return 0;
+    }
+    d->beta = sqrt(d->beta);
+    // Apply previous rotation, compute next
+    oldeps = d->epsln;
+    delta = d->c*d->dbar + d->s*alfa;
+    gbar = d->s*d->dbar - d->c*alfa;
+    d->epsln = d->s*d->beta;
+    d->dbar = -d->c*d->beta;
+    gamma = sqrt(gbar*gbar + d->beta*d->beta);
+    if (gamma==0) {
+      d->status = KRYLOV_BREAKDOWN;
+      return 0;
+    }
+    d->c = gbar/gamma;
+    d->s = d->beta/gamma;
+    phi = d->c*d->phibar;
+    d->phibar = d->s*d->phibar;
+    // Update solution
+    for (i=0; i<n; ++i) {
+      d->w1[i] = d->w2[i];
+      d->w2[i] = d->w[i];
+      d->w[i] = (d->v[i] - oldeps*d->w1[i] - delta*d->w2[i])/gamma;
+      d->x[i] += phi*d->w[i];
+    }
+    // Check convergence
+    d->res = d->phibar;
+    if (d->res <= p->tol*d->beta1 || d->beta==0) return 0;
+    if (d->iter >= p->max_iter) {
+      d->status = KRYLOV_MAX_ITER;
+      return 0;
+    }
+  }
+  // Request y = A*v
+  for (i=0; i<n; ++i) d->v[i] = d->y[i]/d->beta;
+  d->mv_in = d->v;
+  d->mv_out = d->y;
+  d->state = 1;
+  return 1;
+}
+
+// SYMBOL "krylov_gmres"
+// Restarted GMRES with right preconditioning, convergence is measured in the
+// true residual norm
+template<typename T1>
+int casadi_krylov_gmres(casadi_krylov_data<T1>* d) {
+  // Local variables
+  casadi_int n, m, i, j, k, ld;
+  T1 *vj, *hj;
+  T1 hn, t, beta;
+  int done;
+  const casadi_krylov_prob<T1>* p = d->prob;
+  n = p->n;
+  m = p->restart;
+  ld = m+1;
+  if (d->state==0) {
+    // Initial residual
+    casadi_copy(d->b, n, d->v);
+    d->bnorm = casadi_norm_2(n, d->b);
+    d->state = 1;
+  } else if (d->state==2) {
+    // Residual after restart, d->v holds A*x
+    for (i=0; i<n; ++i) d->v[i] = d->b[i] - d->v[i];
+    d->state = 1;
+  }
+  if (d->state==1) {
+    // Start a new cycle
+    beta = casadi_norm_2(n, d->v);
+    d->res = beta;
+    if (beta <= p->tol*d->bnorm) return 0;
+    if (d->iter >= p->max_iter) {
+      d->status = KRYLOV_MAX_ITER;
+      return 0;
+    }
+    casadi_scal(n, 1/beta, d->v);
+    casadi_clear(d->g, m+1);
+    d->g[0] = beta;
+    d->j = 0;
+  } else {
+    // Arnoldi step, d->v + (j+1)*n holds A*(M\v_j)
+    j = d->j;
+    vj = d->v + (j+1)*n;
+    hj = d->h + j*ld;
+    d->iter++;
+    // Modified Gram-Schmidt
+    for (i=0; i<=j; ++i) {
+      hj[i] = casadi_dot(n, vj, d->v + i*n);
+      casadi_axpy(n, -hj[i], d->v + i*n, vj);
+    }
+    hn = casadi_norm_2(n, vj);
+    if (hn!=0) casadi_scal(n, 1/hn, vj);
+    hj[j+1] = hn;
+    // Apply previous Givens rotations to the new column
+    for (i=0; i<j; ++i) {
+      t = d->cs[i]*hj[i] + d->sn[i]*hj[i+1];
+      hj[i+1] = -d->sn[i]*hj[i] + d->cs[i]*hj[i+1];
+      hj[i] = t;
+    }
+    // New rotation eliminating hj[j+1]
+    t = sqrt(hj[j]*hj[j] + hn*hn);
+    if (t==0) {
+      d->status = KRYLOV_BREAKDOWN;
+      return 0;
+    }
+    d->cs[j] = hj[j]/t;
+    d->sn[j] = hn/t;
+    hj[j] = t;
+    hj[j+1] = 0;
+    d->g[j+1] = -d->sn[j]*d->g[j];
+    d->g[j] = d->cs[j]*d->g[j];
+    d->res = fabs(d->g[j+1]);
+    d->j = ++j;
+    done = d->res <= p->tol*d->bnorm || hn==0;
+    if (done || j==m || d->iter >= p->max_iter) {
+      // Solve the triangular least squares system in-place in g
+      for (i=j-1; i>=0; --i) {
+        for (k=i+1; k<j; ++k) d->g[i] -= d->h[i+k*ld]*d->g[k];
+        d->g[i] /= d->h[i+i*ld];
+      }
+      // x += M\(V*g)
+      casadi_clear(d->z, n);
+      for (i=0; i<j; ++i) casadi_axpy(n, d->g[i], d->v + i*n, d->z);
+      casadi_krylov_precon_solve(d, d->z, d->tr);
+      casadi_axpy(n, 1., d->z, d->x);
+      if (done) return 0;
+      // Restart: request v_0 = A*x
+      d->mv_in = d->x;
+      d->mv_out = d->v;
+      d->state = 2;
+      return 1;
+    }
+  }
+  // Request v_{j+1} = A*(M\v_j)
+  casadi_copy(d->v + d->j*n, n, d->z);
+  casadi_krylov_precon_solve(d, d->z, d->tr);
+  d->mv_in = d->z;
+  d->mv_out = d->v + (d->j+1)*n;
+  d->state = 3;
+  return 1;
+}
+
+// SYMBOL "krylov_iterate"
+// Reverse communication: returns 1 when the product d->mv_out = A*d->mv_in
+// (A'*d->mv_in for transposed solves) is needed before the next call,
+// returns 0 when done, with the outcome in d->status
+template<typename T1>
+int casadi_krylov_iterate(casadi_krylov_data<T1>* d) {
+  if (d->prob->method==KRYLOV_CG) {
+    return casadi_krylov_cg(d);
+  } else if (d->prob->method==KRYLOV_MINRES) {
+    return casadi_krylov_minres(d);
+  } else {
+    return casadi_krylov_gmres(d);
+  }
+}
+
+// SYMBOL "krylov_solve"
+// Solve with an explicit matrix, the preconditioner must have been computed
+// Returns nonzero if any right-hand-side failed to converge
+template<typename T1>
+int casadi_krylov_solve(casadi_krylov_data<T1>* d, T1* x, casadi_int nrhs, casadi_int tr) {
+  // Local variables
+  casadi_int k, n;
+  int flag;
+  n = d->prob->n;
+  flag = 0;
+  for (k=0; k<nrhs; ++k) {
+    d->x = x + k*n;
+    casadi_krylov_reset(d, tr);
+    while (casadi_krylov_iterate(d)) {
+      casadi_clear(d->mv_out, n);
+      casadi_mv(d->nz_a, d->prob->sp_a, d->mv_in, d->mv_out, tr);
+    }
+    if (d->status!=KRYLOV_SUCCESS) flag = 1;
+  }
+  return flag;
+}
@@ -0,0 +1,155 @@
+// NOLINT(legal/copyright)
+
+// C-REPLACE "fabs" "casadi_fabs"
+
+// SYMBOL "lbfgs_mem"
+// Limited-memory BFGS approximation of a Hessian, stored as the unrolled
+// update B = gamma*I + sum_i (b_i*b_i' - a_i*a_i') over the m latest pairs
+template<typename T1>
+struct casadi_lbfgs_mem {
+  // Dimension, maximum number of pairs
+  casadi_int nx, m;
+  // Number of pairs stored, ring slot of the next pair
+  casadi_int n, next;
+  // Scaling of the initial approximation
+  T1 gamma;
+  // Steps and gradient differences, len = m*nx each, ring ordered
+  T1 *s, *y;
+  // Unrolled update vectors, len = m*nx each, oldest pair first
+  T1 *a, *b;
+  // Work vector, len = nx
+  T1* q;
+};
+// C-REPLACE "casadi_lbfgs_mem<T1>" "struct casadi_lbfgs_mem"
+
+// SYMBOL "lbfgs_work"
+// Length of the real work vector
+inline
+casadi_int casadi_lbfgs_work(casadi_int nx, casadi_int m) {
+  return 4*m*nx + nx;
+}
+
+// SYMBOL "lbfgs_reset"
+// Discard all pairs
+template<typename T1>
+void casadi_lbfgs_reset(casadi_lbfgs_mem<T1>* m) {
+  m->n = m->next = 0;
+  m->gamma = 1;
+}
+
+// SYMBOL "lbfgs_init"
+// Set up work vectors, nx and m must have been set
+template<typename T1>
+void casadi_lbfgs_init(casadi_lbfgs_mem<T1>* m, T1** w) {
+  m->s = *w; *w += m->m*m->nx;
+  m->y = *w; *w += m->m*m->nx;
+  m->a = *w; *w += m->m*m->nx;
+  m->b = *w; *w += m->m*m->nx;
+  m->q = *w; *w += m->nx;
+  casadi_lbfgs_reset(m);
+}
+
+// SYMBOL "lbfgs_mv"
+// y += B*x, matrix-free
+template<typename T1>
+void casadi_lbfgs_mv(const casadi_lbfgs_mem<T1>* m, const T1* x, T1* y) {
+  casadi_int i;
+  const T1 *a, *b;
+  casadi_axpy(m->nx, m->gamma, x, y);
+  for (i=0; i<m->n; ++i) {
+    a = m->a + i*m->nx;
+    b = m->b + i*m->nx;
+    casadi_axpy(m->nx, casadi_dot(m->nx, b, x), b, y);
+    casadi_axpy(m->nx, -casadi_dot(m->nx, a, x), a, y);
+  }
+}
+
+// SYMBOL "lbfgs_update"
+// Add the pair (dx, glag - glag_old), dropping the oldest one if full.
+// The unrolled vectors are recomputed with the same damping as casadi_bfgs
+template<typename T1>
+void casadi_lbfgs_update(casadi_lbfgs_mem<T1>* m, const T1* dx,
+                         const T1* glag, const T1* glag_old) {
+  casadi_int i, k, nx, n_pair, first;
+  T1 *s, *y, *a, *b, sy, sBs, omega;
+  nx = m->nx;
+  if (m->m==0) return;
+  // Ignore zero steps
+  if (casadi_dot(nx, dx, dx)==0) return;
+  // Store the pair
+  s = m->s + m->next*nx;
+  y = m->y + m->next*nx;
+  casadi_copy(dx, nx, s);
+  casadi_copy(glag, nx, y);
+  casadi_axpy(nx, -1., glag_old, y);
+  m->next = (m->next + 1) % m->m;
+  n_pair = m->n + 1;
+  if (n_pair>m->m) n_pair = m->m;
+  first = (m->next + m->m - n_pair) % m->m;
+  // Initial approximation from the latest pair
+  sy = casadi_dot(nx, s, y);
+  if (sy>0) m->gamma = casadi_dot(nx, y, y)/sy;
+  // Unroll the updates, oldest pair first
+  m->n = 0;
+  for (i=0; i<n_pair; ++i) {
+    k = (first + i) % m->m;
+    s = m->s + k*nx;
+    y = m->y + k*nx;
+    a = m->a + i*nx;
+    b = m->b + i*nx;
+    // q = B_i*s_i
+    casadi_clear(m->q, nx);
+    casadi_lbfgs_mv(m, s, m->q);
+    sBs = casadi_dot(nx, s, m->q);
+    sy = casadi_dot(nx, s, y);
+    // Powell damping, b = omega*y + (1-omega)*q
+    omega = 1;
+    if (sy < 0.2*sBs) omega = 0.8*sBs/(sBs - sy);
+    casadi_copy(y, nx, b);
+    casadi_scal(nx, omega, b);
+    casadi_axpy(nx, 1-omega, m->q, b);
+    sy = casadi_dot(nx, s, b);
+    if (sBs<=0 || sy<=0) break;
+    casadi_scal(nx, 1/sqrt(sy), b);
+    casadi_copy(m->q, nx, a);
+    casadi_scal(nx, 1/sqrt(sBs), a);
+    m->n++;
+  }
+}
+
+// SYMBOL "lbfgs_project"
+// Entries of B in the sparsity pattern sp_h, e.g. a diagonal or banded pattern.
+// The diagonal of B is positive, but a banded part of B can be indefinite: where
+// a column is not diagonally dominant, its diagonal entry is raised so that it is,
+// which makes the result positive definite. sp_h must be symmetric, with diagonal
+template<typename T1>
+void casadi_lbfgs_project(const casadi_lbfgs_mem<T1>* m, const casadi_int* sp_h, T1* h) {
+  casadi_int ncol, c, k, r, i, kd;
+  const casadi_int *colind, *row;
+  const T1 *a, *b;
+  T1 v, rad;
+  ncol = sp_h[1];
+  colind = sp_h+2; row = sp_h+ncol+3;
+  for (c=0; c<ncol; ++c) {
+    kd = -1;
+    rad = 0;
+    for (k=colind[c]; k<colind[c+1]; ++k) {
+      r = row[k];
+      v = 0;
+      if (r==c) v = m->gamma;
+      for (i=0; i<m->n; ++i) {
+        a = m->a + i*m->nx;
+        b = m->b + i*m->nx;
+        v += b[r]*b[c] - a[r]*a[c];
+      }
+      h[k] = v;
+      if (r==c) {
+        kd = k;
+      } else {
+        rad += fabs(v);
+      }
+    }
+    // Diagonal shift, Gershgorin
+    if (kd>=0 && rad>0 && h[kd]<=rad) h[kd] = rad + 1e-8*m->gamma;
+  }
+}
@@ -40,6 +40,141 @@ void casadi_ldl(const casadi_int* sp_a, const T1* a,
   }
 }
 
+// SYMBOL "ldl_super_work"
+// Work vector sizes for casadi_ldl_super
+inline
+void casadi_ldl_super_work(const casadi_int* sp_sn, const casadi_int* sn,
+                           casadi_int* sz_iw, casadi_int* sz_w) {
+  casadi_int n, nsn, s, ncol, max_ncol;
+  const casadi_int *sn_colind;
+  n=sp_sn[0]; nsn=sp_sn[1];
+  sn_colind=sp_sn+2;
+  *sz_iw = 3*n + 4*nsn + 1;
+  *sz_w = n;
+  max_ncol = 0;
+  for (s=0; s<nsn; ++s) {
+    ncol = sn[s+1]-sn[s];
+    *sz_w += (sn_colind[s+1]-sn_colind[s])*ncol;
+    if (ncol>max_ncol) max_ncol = ncol;
+  }
+  *sz_w += max_ncol;
+}
+
+// SYMBOL "ldl_super"
+// Supernodal variant of casadi_ldl, with the same output. Supernode s consists of
+// the columns sn[s] <= c < sn[s+1] of L, which share the row pattern given by
+// column s of sp_sn (diagonal block included). Each supernode is assembled as
+// a dense panel, updated by its descendants with dense block kernels and
+// factorized, before the result is written back to lt and d.
+// len[iw], len[w] given by casadi_ldl_super_work
+template<typename T1>
+void casadi_ldl_super(const casadi_int* sp_a, const T1* a,
+                      const casadi_int* sp_lt, T1* lt, T1* d, const casadi_int* p,
+                      const casadi_int* sp_sn, const casadi_int* sn,
+                      casadi_int* iw, T1* w) {
+  const casadi_int *lt_colind, *a_colind, *a_row, *sn_colind, *sn_row, *rows, *rows_t;
+  casadi_int n, nsn, s, s2, t, t_next, f, f_t, ncol, ncol_t, m, m_t, i, j, k, c, p1, p2;
+  casadi_int *map, *pos, *poff, *next, *head, *link, *col2sn;
+  T1 *x, *panel, *tmp, *P, *P_t;
+  T1 r;
+  // Extract sparsities
+  n=sp_lt[1];
+  lt_colind=sp_lt+2;
+  a_colind=sp_a+2; a_row=sp_a+2+n+1;
+  nsn=sp_sn[1];
+  sn_colind=sp_sn+2; sn_row=sp_sn+2+nsn+1;
+  // Work vectors
+  map=iw; iw+=n;
+  pos=iw; iw+=n;
+  col2sn=iw; iw+=n;
+  poff=iw; iw+=nsn+1;
+  next=iw; iw+=nsn;
+  head=iw; iw+=nsn;
+  link=iw; iw+=nsn;
+  x=w; w+=n;
+  panel=w;
+  // Panel offsets, supernode of each column
+  poff[0] = 0;
+  for (s=0; s<nsn; ++s) {
+    poff[s+1] = poff[s] + (sn_colind[s+1]-sn_colind[s])*(sn[s+1]-sn[s]);
+    for (c=sn[s]; c<sn[s+1]; ++c) col2sn[c] = s;
+    head[s] = -1;
+  }
+  tmp = panel + poff[nsn];
+  // Clear x, position of next entry in each column of lt
+  for (c=0; c<n; ++c) {
+    x[c] = 0;
+    pos[c] = lt_colind[c];
+  }
+  // Loop over supernodes
+  for (s=0; s<nsn; ++s) {
+    f = sn[s];
+    ncol = sn[s+1]-f;
+    m = sn_colind[s+1]-sn_colind[s];
+    rows = sn_row+sn_colind[s];
+    P = panel+poff[s];
+    // Position of each row in the panel
+    for (i=0; i<m; ++i) map[rows[i]] = i;
+    // Sparse copy of A to the panel
+    for (j=0; j<ncol; ++j) {
+      c = p[f+j];
+      for (k=a_colind[c]; k<a_colind[c+1]; ++k) x[a_row[k]] = a[k];
+      for (i=0; i<j; ++i) P[i+j*m] = 0;
+      for (i=j; i<m; ++i) P[i+j*m] = x[p[rows[i]]];
+      for (k=a_colind[c]; k<a_colind[c+1]; ++k) x[a_row[k]] = 0;
+    }
+    // Update with all descendants t with L(f:f+ncol-1, sn[t]:sn[t+1]-1) nonzero
+    for (t=head[s]; t>=0; t=t_next) {
+      t_next = link[t];
+      f_t = sn[t];
+      ncol_t = sn[t+1]-f_t;
+      m_t = sn_colind[t+1]-sn_colind[t];
+      rows_t = sn_row+sn_colind[t];
+      P_t = panel+poff[t];
+      // Rows p1 <= i < p2 of the descendant panel fall in this supernode
+      p1 = next[t];
+      for (p2=p1; p2<m_t && rows_t[p2]<sn[s+1]; ++p2) {}
+      // Dense update P -= L_t(p1:m_t-1,:) * D_t * L_t(p1:p2-1,:)'
+      for (j=p1; j<p2; ++j) {
+        for (k=0; k<ncol_t; ++k) tmp[k] = P_t[j+k*m_t]*d[f_t+k];
+        c = rows_t[j]-f;
+        for (i=j; i<m_t; ++i) {
+          r = 0;
+          for (k=0; k<ncol_t; ++k) r += P_t[i+k*m_t]*tmp[k];
+          P[map[rows_t[i]]+c*m] -= r;
+        }
+      }
+      // Move t to the next supernode it updates, if any
+      next[t] = p2;
+      if (p2<m_t) {
+        s2 = col2sn[rows_t[p2]];
+        link[t] = head[s2];
+        head[s2] = t;
+      }
+    }
+    // Dense LDL^T factorization of the panel
+    for (j=0; j<ncol; ++j) {
+      d[f+j] = P[j+j*m];
+      for (i=j+1; i<m; ++i) P[i+j*m] /= d[f+j];
+      for (k=j+1; k<ncol; ++k) {
+        r = P[k+j*m]*d[f+j];
+        for (i=k; i<m; ++i) P[i+k*m] -= P[i+j*m]*r;
+      }
+    }
+    // Copy strictly lower entries to lt
+    for (j=0; j<ncol; ++j) {
+      for (i=j+1; i<m; ++i) lt[pos[rows[i]]++] = P[i+j*m];
+    }
+    // Add s to the list of the first supernode it updates, if any
+    if (ncol<m) {
+      next[s] = ncol;
+      s2 = col2sn[rows[ncol]];
+      link[s] = head[s2];
+      head[s2] = s;
+    }
+  }
+}
+
 // SYMBOL "ldl_trs"
 // Solve for (I+R) with R an optionally transposed strictly upper triangular matrix.
 template<typename T1>
@@ -89,3 +224,69 @@ void casadi_ldl_solve(T1* x, casadi_int nrhs, const casadi_int* sp_lt, const T1*
     x += n;
   }
 }
+
+// SYMBOL "ldl_trs_blk"
+// Solve for (I+R) with R an optionally transposed strictly upper triangular matrix,
+// for a block of nb vectors, stored interleaved: x[i*nb+j]
+template<typename T1>
+void casadi_ldl_trs_blk(const casadi_int* sp_r, const T1* nz_r, T1* x, casadi_int nb,
+                        casadi_int tr) {
+  casadi_int ncol, c, k, j;
+  const casadi_int *colind, *row;
+  T1 *xr, *xc;
+  // Extract sparsity
+  ncol=sp_r[1];
+  colind=sp_r+2; row=sp_r+2+ncol+1;
+  if (tr) {
+    // Forward substitution
+    for (c=0; c<ncol; ++c) {
+      xc = x + c*nb;
+      for (k=colind[c]; k<colind[c+1]; ++k) {
+        xr = x + row[k]*nb;
+        for (j=0; j<nb; ++j) xc[j] -= nz_r[k]*xr[j];
+      }
+    }
+  } else {
+    // Backward substitution
+    for (c=ncol-1; c>=0; --c) {
+      xc = x + c*nb;
+      for (k=colind[c+1]-1; k>=colind[c]; --k) {
+        xr = x + row[k]*nb;
+        for (j=0; j<nb; ++j) xr[j] -= nz_r[k]*xc[j];
+      }
+    }
+  }
+}
+
+// SYMBOL "ldl_solve_blk"
+// Linear solve using an LDL^T factorized linear system, sweeping the factor
+// once for every block of up to nb right-hand-sides
+// len[w] >= nb*n
+template<typename T1>
+void casadi_ldl_solve_blk(T1* x, casadi_int nrhs, const casadi_int* sp_lt, const T1* lt,
+                          const T1* d, const casadi_int* p, T1* w, casadi_int nb) {
+  casadi_int i, j, k, nk;
+  casadi_int n = sp_lt[1];
+  for (k=0; k<nrhs; k+=nk) {
+    // Number of right-hand-sides in this block
+    nk = nrhs-k < nb ? nrhs-k : nb;
+    // Multiply by P
+    for (i=0; i<n; ++i) {
+      for (j=0; j<nk; ++j) w[i*nk+j] = x[j*n+p[i]];
+    }
+    //  Solve for L
+    casadi_ldl_trs_blk(sp_lt, lt, w, nk, 1);
+    // Divide by D
+    for (i=0; i<n; ++i) {
+      for (j=0; j<nk; ++j) w[i*nk+j] /= d[i];
+    }
+    // Solve for L'
+    casadi_ldl_trs_blk(sp_lt, lt, w, nk, 0);
+    // Multiply by P'
+    for (i=0; i<n; ++i) {
+      for (j=0; j<nk; ++j) x[j*n+p[i]] = w[i*nk+j];
+    }
+    // Next block
+    x += nk*n;
+  }
+}
@@ -15,6 +15,7 @@ casadi_int casadi_low(T1 x, const double* grid, casadi_int ng, casadi_int lookup
         return ret;
       }
     case 2: // binary
+    case 3: // index, binary search when no table is available
       {
         casadi_int start, stop, pivot;
         // Quick return
@@ -44,3 +45,18 @@ casadi_int casadi_low(T1 x, const double* grid, casadi_int ng, casadi_int lookup
       }
   }
 }
+
+// SYMBOL "low_index"
+// Find the interval using a precomputed table: index[b] is the left index of
+// the interval containing g[0] + b*(g[ng-1]-g[0])/ni, followed by a short scan
+template<typename T1>
+casadi_int casadi_low_index(T1 x, const double* grid, casadi_int ng,
+                            const casadi_int* index, casadi_int ni) {
+  casadi_int b, ret;
+  b = (casadi_int) ((x-grid[0])*ni/(grid[ng-1]-grid[0])); // NOLINT(readability/casting)
+  if (b<0) b=0;
+  if (b>ni-1) b=ni-1;
+  ret = index[b];
+  while (ret<ng-2 && x>=grid[ret+1]) ret++;
+  return ret;
+}
@@ -0,0 +1,30 @@
+// NOLINT(legal/copyright)
+// SYMBOL "nd_boor_basis"
+// Basis values and coefficient indices at npoints points, nb = prod(degree+1)
+// entries per point. strides must correspond to m=1
+template<typename T1>
+void casadi_nd_boor_basis(T1* val, casadi_int* nz, casadi_int n_dims, const T1* all_knots, const casadi_int* offset, const casadi_int* all_degree, const casadi_int* strides, const T1* all_x, const casadi_int* lookup_mode, casadi_int npoints, casadi_int nb, casadi_int* iw, T1* w) { // NOLINT(whitespace/line_length)
+  casadi_int j;
+  casadi_clear(val, nb*npoints);
+  for (j=0; j<npoints; ++j) {
+    casadi_nd_boor_dual_eval(val+j*nb, nz+j*nb, n_dims, all_knots, offset, all_degree, strides,
+      all_x+j*n_dims, lookup_mode, iw, w);
+  }
+}
+
+// SYMBOL "nd_boor_basis_eval"
+// Accumulate the spline values at npoints points from precomputed basis values
+template<typename T1>
+void casadi_nd_boor_basis_eval(T1* ret, casadi_int m, const T1* val, const casadi_int* nz, casadi_int nb, const T1* c, casadi_int npoints) { // NOLINT(whitespace/line_length)
+  casadi_int j, k, i;
+  const T1* cc;
+  for (j=0; j<npoints; ++j) {
+    for (k=0; k<nb; ++k) {
+      cc = c + nz[k]*m;
+      for (i=0; i<m; ++i) ret[i] += val[k]*cc[i];
+    }
+    ret += m;
+    val += nb;
+    nz += nb;
+  }
+}
@@ -20,28 +20,127 @@ struct casadi_newton_mem {
   T1* lin_v;
   T1* lin_r;
   T1* lin_beta;
+
+  // Jacobian reuse: 0 refactorize every iteration, 1 reuse the factorization
+  // within a solve. Each solve starts with a fresh factorization
+  casadi_int jac_reuse;
+  // Refactorize when the step contraction rate |dx_k|/|dx_{k-1}| exceeds
+  // theta_max, e.g. 0.5
+  T1 theta_max;
+  // Maximum number of Broyden rank-1 updates of a factorization, 0 disables
+  casadi_int broyden_max;
+  // Broyden storage: len[g_prev] = len[s_prev] = n,
+  // len[broyden_u] = len[broyden_s] = n*broyden_max
+  T1* g_prev;
+  T1* s_prev;
+  T1* broyden_u;
+  T1* broyden_s;
+
+  // Set when the caller must evaluate jac_g_x before the next call
+  casadi_int refresh;
+  // Number of factorizations, Broyden updates in use
+  casadi_int n_fact, n_broyden;
+  // Norm of the previous step, negative if none
+  T1 step_prev;
 };
 
 // C-REPLACE "casadi_newton_mem<T1>" "struct casadi_newton_mem"
+// SYMBOL "newton_init"
+// Default options and state: refactorize every iteration, no Broyden updates.
+// Call once before setting the problem fields
+template<typename T1>
+void casadi_newton_init(casadi_newton_mem<T1>* m) {
+  m->jac_reuse = 0;
+  m->theta_max = 0.5;
+  m->broyden_max = 0;
+  m->g_prev = m->s_prev = m->broyden_u = m->broyden_s = 0;
+  m->refresh = 1;
+  m->n_fact = m->n_broyden = 0;
+  m->step_prev = -1;
+}
+
+// SYMBOL "newton_reset"
+// Call at the start of each solve
+template<typename T1>
+void casadi_newton_reset(casadi_newton_mem<T1>* m) {
+  m->refresh = 1;
+  m->step_prev = -1;
+}
+
+// SYMBOL "newton_apply"
+// Apply the inverse of the (updated) Jacobian approximation in-place
+template<typename T1>
+void casadi_newton_apply(const casadi_newton_mem<T1>* m, T1* x) {
+  casadi_int i;
+  // Factorized Jacobian
+  casadi_qr_solve(x, 1, 0, m->sp_v, m->lin_v, m->sp_r, m->lin_r, m->lin_beta,
+                  m->prinv, m->pc, m->lin_w);
+  // Broyden updates, H_{i+1} = (I + u_i*s_i') H_i
+  for (i=0; i<m->n_broyden; ++i) {
+    casadi_axpy(m->n, casadi_dot(m->n, m->broyden_s + i*m->n, x), m->broyden_u + i*m->n, x);
+  }
+}
+
 // SYMBOL "newton"
+// The caller evaluates g at x before each call, and also jac_g_x if m->refresh
+// is set. Returns 1 or 2 on convergence of the residual or step, otherwise 0
 template<typename T1>
-int casadi_newton(const casadi_newton_mem<T1>* m) {
+int casadi_newton(casadi_newton_mem<T1>* m) {
+    casadi_int i;
+    T1 step, sy;
+    T1 *u, *s;
     // Check tolerance on residual
     if (m->abstol>0 && casadi_norm_inf(m->n, m->g) <= m->abstol) return 1;
 
-    // Factorize J
-    casadi_qr(m->sp_a, m->jac_g_x, m->lin_w,
-              m->sp_v,  m->lin_v, m->sp_r, m->lin_r, m->lin_beta,
-              m->prinv, m->pc);
+    if (m->refresh) {
+      // Factorize J
+      casadi_qr(m->sp_a, m->jac_g_x, m->lin_w,
+                m->sp_v,  m->lin_v, m->sp_r, m->lin_r, m->lin_beta,
+                m->prinv, m->pc);
+      m->n_fact++;
+      m->n_broyden = 0;
+      m->refresh = 0;
+    } else if (m->broyden_max>0 && m->step_prev>=0) {
+      // Good Broyden update: u = (s - H*y)/(s'*H*y), y = g - g_prev
+      u = m->broyden_u + m->n_broyden*m->n;
+      s = m->broyden_s + m->n_broyden*m->n;
+      for (i=0; i<m->n; ++i) u[i] = m->g[i] - m->g_prev[i];
+      casadi_newton_apply(m, u);
+      sy = casadi_dot(m->n, m->s_prev, u);
+      if (sy!=0) {
+        for (i=0; i<m->n; ++i) u[i] = (m->s_prev[i] - u[i])/sy;
+        casadi_copy(m->s_prev, m->n, s);
+        m->n_broyden++;
+      }
+    }
+
+    // Keep residual for the next Broyden update
+    if (m->broyden_max>0) casadi_copy(m->g, m->n, m->g_prev);
+
     // Solve J^(-1) g
-    casadi_qr_solve(m->g, 1, 0, m->sp_v, m->lin_v, m->sp_r, m->lin_r, m->lin_beta,
-                    m->prinv, m->pc, m->lin_w);
+    casadi_newton_apply(m, m->g);
 
     // Update Xk+1 = Xk - J^(-1) g
     casadi_axpy(m->n, -1., m->g, m->x);
 
     // Check tolerance on step
-    if (m->abstol_step>0 && casadi_norm_inf(m->n, m->g) <= m->abstol_step) return 2;
+    step = casadi_norm_inf(m->n, m->g);
+    if (m->abstol_step>0 && step <= m->abstol_step) return 2;
+
+    // Decide if the Jacobian needs to be refreshed
+    if (m->jac_reuse==0) {
+      m->refresh = 1;
+    } else if (m->step_prev>=0 && step > m->theta_max*m->step_prev) {
+      // Insufficient contraction
+      m->refresh = 1;
+    } else if (m->broyden_max>0 && m->n_broyden==m->broyden_max) {
+      // Broyden storage exhausted
+      m->refresh = 1;
+    }
+    m->step_prev = m->refresh ? -1 : step;
+    if (m->broyden_max>0) {
+      for (i=0; i<m->n; ++i) m->s_prev[i] = -m->g[i];
+    }
 
     // We will need another newton step
     return 0;
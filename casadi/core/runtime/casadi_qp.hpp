@@ -24,6 +24,8 @@ struct casadi_qp_prob {
   casadi_int max_iter;
   // Primal and dual error tolerance
   T1 constr_viol_tol, dual_inf_tol;
+  // Maximum number of low-rank updates before the KKT matrix is refactorized
+  casadi_int max_upd;
 };
 // C-REPLACE "casadi_qp_prob<T1>" "struct casadi_qp_prob"
 
@@ -39,15 +41,17 @@ void casadi_qp_setup(casadi_qp_prob<T1>* p) {
   p->max_iter = 1000;
   p->constr_viol_tol = 1e-8;
   p->dual_inf_tol = 1e-8;
+  p->max_upd = 10;
 }
 
 // SYMBOL "qp_work"
 template<typename T1>
 void casadi_qp_work(const casadi_qp_prob<T1>* p, casadi_int* sz_iw, casadi_int* sz_w) {
   // Local variables
-  casadi_int nnz_a, nnz_kkt, nnz_v, nnz_r;
+  casadi_int nnz_a, nnz_h, nnz_kkt, nnz_v, nnz_r;
   // Get matrix number of nonzeros
   nnz_a = p->sp_a[2+p->sp_a[1]];
+  nnz_h = p->sp_h[2+p->sp_h[1]];
   nnz_kkt = p->sp_kkt[2+p->sp_kkt[1]];
   nnz_v = p->sp_v[2+p->sp_v[1]];
   nnz_r = p->sp_r[2+p->sp_r[1]];
@@ -75,6 +79,16 @@ void casadi_qp_work(const casadi_qp_prob<T1>* p, casadi_int* sz_iw, casadi_int*
   *sz_iw += p->nz; // lincomb
   *sz_w += casadi_max(nnz_v+nnz_r, nnz_kkt); // [v,r] or trans(kkt)
   *sz_w += p->nz; // beta
+  *sz_w += p->max_upd*p->nz; // upd_u
+  *sz_w += p->max_upd*p->max_upd; // upd_s
+  *sz_w += p->max_upd*p->max_upd; // upd_lu
+  *sz_w += p->nz + p->max_upd; // upd_t
+  *sz_iw += p->nz; // fact_act
+  *sz_iw += p->nz; // upd_act
+  *sz_iw += p->max_upd; // upd_ind
+  *sz_iw += p->max_upd; // upd_piv
+  *sz_w += nnz_h; // h_prev
+  *sz_w += nnz_a; // a_prev
 }
 
 // SYMBOL "qp_flag_t"
@@ -101,6 +115,15 @@ struct casadi_qp_data {
   casadi_int *iw, *neverzero, *neverlower, *neverupper, *lincomb;
   // Numeric QR factorization
   T1 *nz_at, *nz_kkt, *beta, *nz_v, *nz_r;
+  // Low-rank updates of the factorization: KKT^T = KKT0^T + U*E'
+  T1 *upd_u, *upd_s, *upd_lu, *upd_t;
+  casadi_int *fact_act, *upd_act, *upd_ind, *upd_piv;
+  // Number of low-rank updates, -1 if no valid factorization
+  casadi_int n_upd;
+  // H and A corresponding to the factorization
+  T1 *h_prev, *a_prev;
+  // Has the factorization from the previous solve been reused?
+  int hot_start;
   // Message buffer
   const char *msg;
   // Message index
@@ -130,10 +153,11 @@ struct casadi_qp_data {
 template<typename T1>
 void casadi_qp_init(casadi_qp_data<T1>* d, casadi_int** iw, T1** w) {
   // Local variables
-  casadi_int nnz_a, nnz_kkt, nnz_v, nnz_r;
+  casadi_int nnz_a, nnz_h, nnz_kkt, nnz_v, nnz_r;
   const casadi_qp_prob<T1>* p = d->prob;
   // Get matrix number of nonzeros
   nnz_a = p->sp_a[2+p->sp_a[1]];
+  nnz_h = p->sp_h[2+p->sp_h[1]];
   nnz_kkt = p->sp_kkt[2+p->sp_kkt[1]];
   nnz_v = p->sp_v[2+p->sp_v[1]];
   nnz_r = p->sp_r[2+p->sp_r[1]];
@@ -151,20 +175,41 @@ void casadi_qp_init(casadi_qp_data<T1>* d, casadi_int** iw, T1** w) {
   d->infeas = *w; *w += p->nx;
   d->tinfeas = *w; *w += p->nx;
   d->sens = *w; *w += p->nz;
+  d->upd_u = *w; *w += p->max_upd*p->nz;
+  d->upd_s = *w; *w += p->max_upd*p->max_upd;
+  d->upd_lu = *w; *w += p->max_upd*p->max_upd;
+  d->upd_t = *w; *w += p->nz + p->max_upd;
+  d->fact_act = *iw; *iw += p->nz;
+  d->upd_act = *iw; *iw += p->nz;
+  d->upd_ind = *iw; *iw += p->max_upd;
+  d->upd_piv = *iw; *iw += p->max_upd;
+  d->h_prev = *w; *w += nnz_h;
+  d->a_prev = *w; *w += nnz_a;
   d->neverzero = *iw; *iw += p->nz;
   d->neverupper = *iw; *iw += p->nz;
   d->neverlower = *iw; *iw += p->nz;
   d->lincomb = *iw; *iw += p->nz;
   d->w = *w;
   d->iw = *iw;
+  // No factorization yet
+  d->n_upd = -1;
+  d->hot_start = 0;
 }
 
 // SYMBOL "qp_reset"
+// Prepare a new solve. The KKT factorization lives in the work vectors set up
+// by casadi_qp_init. A caller that keeps d and its work vectors between solves,
+// calling casadi_qp_init only once, gets a hot start: if the nonzeros of H and A
+// are unchanged, the factorization is kept and brought up to date with the
+// initial active set by low-rank updates. Set n_upd to -1 to force a cold start
 template<typename T1>
 int casadi_qp_reset(casadi_qp_data<T1>* d) {
   // Local variables
-  casadi_int i;
+  casadi_int i, nnz_a, nnz_h;
   const casadi_qp_prob<T1>* p = d->prob;
+  // Get matrix number of nonzeros
+  nnz_a = p->sp_a[2+p->sp_a[1]];
+  nnz_h = p->sp_h[2+p->sp_h[1]];
   // Reset variables corresponding to previous iteration
   d->msg = 0;
   d->tau = 0.;
@@ -198,6 +243,18 @@ int casadi_qp_reset(casadi_qp_data<T1>* d) {
   d->r_sign = 0;
   // Reset iteration counter
   d->iter = 0;
+  // No search direction from a previous solve
+  d->has_search_dir = 0;
+  // Reuse the factorization from the previous solve if H and A are unchanged
+  d->hot_start = d->n_upd >= 0;
+  for (i=0; i<nnz_h && d->hot_start; ++i) d->hot_start = d->nz_h[i] == d->h_prev[i];
+  for (i=0; i<nnz_a && d->hot_start; ++i) d->hot_start = d->nz_a[i] == d->a_prev[i];
+  if (!d->hot_start) {
+    // No valid factorization
+    d->n_upd = -1;
+    casadi_copy(d->nz_h, nnz_h, d->h_prev);
+    casadi_copy(d->nz_a, nnz_a, d->a_prev);
+  }
   return 0;
 }
 
@@ -649,6 +706,223 @@ void casadi_qp_take_step(casadi_qp_data<T1>* d) {
   }
 }
 
+// SYMBOL "qp_upd_lu"
+// Dense LU factorization with partial pivoting of the update matrix S
+// Returns 1 if S is (numerically) singular
+template<typename T1>
+int casadi_qp_upd_lu(casadi_qp_data<T1>* d) {
+  // Local variables
+  casadi_int n, ld, i, j, k, ipiv;
+  T1 smax, piv, r, *lu;
+  const casadi_qp_prob<T1>* p = d->prob;
+  n = d->n_upd;
+  ld = p->max_upd;
+  lu = d->upd_lu;
+  // Copy S, get largest entry in absolute value
+  smax = 1.;
+  for (j=0; j<n; ++j) {
+    for (i=0; i<n; ++i) {
+      lu[i+j*ld] = d->upd_s[i+j*ld];
+      smax = fmax(smax, fabs(lu[i+j*ld]));
+    }
+  }
+  // Gaussian elimination, column by column
+  for (k=0; k<n; ++k) {
+    // Find pivot
+    ipiv = k;
+    piv = fabs(lu[k+k*ld]);
+    for (i=k+1; i<n; ++i) {
+      if (fabs(lu[i+k*ld]) > piv) {
+        piv = fabs(lu[i+k*ld]);
+        ipiv = i;
+      }
+    }
+    d->upd_piv[k] = ipiv;
+    // Singular?
+    if (piv < 1e-12*smax) return 1;
+    // Swap rows
+    if (ipiv!=k) {
+      for (j=0; j<n; ++j) {
+        r = lu[k+j*ld];
+        lu[k+j*ld] = lu[ipiv+j*ld];
+        lu[ipiv+j*ld] = r;
+      }
+    }
+    // Eliminate below the diagonal
+    for (i=k+1; i<n; ++i) {
+      lu[i+k*ld] /= lu[k+k*ld];
+      for (j=k+1; j<n; ++j) lu[i+j*ld] -= lu[i+k*ld]*lu[k+j*ld];
+    }
+  }
+  return 0;
+}
+
+// SYMBOL "qp_upd_solve"
+// Solve S*x = b or S'*x = b using the dense LU factorization
+template<typename T1>
+void casadi_qp_upd_solve(casadi_qp_data<T1>* d, T1* x, casadi_int tr) {
+  // Local variables
+  casadi_int n, ld, i, k;
+  T1 r;
+  const T1* lu;
+  const casadi_qp_prob<T1>* p = d->prob;
+  n = d->n_upd;
+  ld = p->max_upd;
+  lu = d->upd_lu;
+  if (tr) {
+    // S' = U' L' P, solve for U', then L', then multiply by P'
+    for (k=0; k<n; ++k) {
+      for (i=0; i<k; ++i) x[k] -= lu[i+k*ld]*x[i];
+      x[k] /= lu[k+k*ld];
+    }
+    for (k=n-1; k>=0; --k) {
+      for (i=k+1; i<n; ++i) x[k] -= lu[i+k*ld]*x[i];
+    }
+    for (k=n-1; k>=0; --k) {
+      i = d->upd_piv[k];
+      r = x[k]; x[k] = x[i]; x[i] = r;
+    }
+  } else {
+    // P S = L U, multiply by P, then solve for L, then U
+    for (k=0; k<n; ++k) {
+      i = d->upd_piv[k];
+      r = x[k]; x[k] = x[i]; x[i] = r;
+    }
+    for (k=0; k<n; ++k) {
+      for (i=k+1; i<n; ++i) x[i] -= lu[i+k*ld]*x[k];
+    }
+    for (k=n-1; k>=0; --k) {
+      x[k] /= lu[k+k*ld];
+      for (i=0; i<k; ++i) x[i] -= lu[i+k*ld]*x[k];
+    }
+  }
+}
+
+// SYMBOL "qp_solve"
+// Solve a linear system with the (transposed) KKT matrix, taking into account
+// the low-rank updates. With M = M0 + U*E' (Sherman-Morrison-Woodbury):
+// M \ b = M0 \ (b - U * (S \ (E' * (M0 \ b))))
+// M' \ b = M0' \ (b - E * (S' \ (U' * (M0' \ b))))
+// with S = I + E' * (M0 \ U)
+template<typename T1>
+void casadi_qp_solve(casadi_qp_data<T1>* d, T1* x, casadi_int tr) {
+  // Local variables
+  casadi_int k;
+  T1 *t, *s;
+  const casadi_qp_prob<T1>* p = d->prob;
+  // Solve with the factorized matrix if no updates
+  if (d->n_upd <= 0) {
+    casadi_qr_solve(x, 1, tr, p->sp_v, d->nz_v, p->sp_r, d->nz_r, d->beta,
+                    p->prinv, p->pc, d->w);
+    return;
+  }
+  // Work vectors
+  t = d->upd_t;
+  s = t + p->nz;
+  // Solve with the factorized matrix
+  casadi_copy(x, p->nz, t);
+  casadi_qr_solve(t, 1, tr, p->sp_v, d->nz_v, p->sp_r, d->nz_r, d->beta,
+                  p->prinv, p->pc, d->w);
+  // Project onto the update space
+  for (k=0; k<d->n_upd; ++k) {
+    s[k] = tr ? casadi_dot(p->nz, d->upd_u + k*p->nz, t) : t[d->upd_ind[k]];
+  }
+  // Solve the small, dense system
+  casadi_qp_upd_solve(d, s, tr);
+  // Correct right-hand-side
+  for (k=0; k<d->n_upd; ++k) {
+    if (tr) {
+      x[d->upd_ind[k]] -= s[k];
+    } else {
+      casadi_axpy(p->nz, -s[k], d->upd_u + k*p->nz, x);
+    }
+  }
+  // Solve with the factorized matrix
+  casadi_qr_solve(x, 1, tr, p->sp_v, d->nz_v, p->sp_r, d->nz_r, d->beta,
+                  p->prinv, p->pc, d->w);
+}
+
+// SYMBOL "qp_upd_col"
+// Update column k of U, recalculate column k of S
+template<typename T1>
+void casadi_qp_upd_col(casadi_qp_data<T1>* d, casadi_int k) {
+  // Local variables
+  casadi_int i, j;
+  T1 *u, *t;
+  const casadi_qp_prob<T1>* p = d->prob;
+  u = d->upd_u + k*p->nz;
+  t = d->upd_t;
+  i = d->upd_ind[k];
+  // Difference between the current and the factorized column of KKT^T
+  d->upd_act[i] = d->lam[i]!=0;
+  if (d->upd_act[i] == d->fact_act[i]) {
+    // Column i changed back to its factorized value
+    casadi_clear(u, p->nz);
+  } else {
+    casadi_qp_kkt_vector(d, u, i);
+    if (!d->fact_act[i]) casadi_scal(p->nz, -1., u);
+  }
+  // Column k of S
+  casadi_copy(u, p->nz, t);
+  casadi_qr_solve(t, 1, 0, p->sp_v, d->nz_v, p->sp_r, d->nz_r, d->beta,
+                  p->prinv, p->pc, d->w);
+  for (j=0; j<d->n_upd; ++j) {
+    d->upd_s[j+k*p->max_upd] = t[d->upd_ind[j]] + (j==k ? 1. : 0.);
+  }
+}
+
+// SYMBOL "qp_upd_add"
+// Add a new column to the low-rank update, corresponding to index i
+template<typename T1>
+void casadi_qp_upd_add(casadi_qp_data<T1>* d, casadi_int i) {
+  // Local variables
+  casadi_int k;
+  T1 *t;
+  const casadi_qp_prob<T1>* p = d->prob;
+  t = d->upd_t;
+  // Append index
+  d->upd_ind[d->n_upd++] = i;
+  // New row of S: e_i' * (M0 \ U) = (M0' \ e_i)' * U
+  casadi_clear(t, p->nz);
+  t[i] = 1.;
+  casadi_qr_solve(t, 1, 1, p->sp_v, d->nz_v, p->sp_r, d->nz_r, d->beta,
+                  p->prinv, p->pc, d->w);
+  for (k=0; k<d->n_upd-1; ++k) {
+    d->upd_s[d->n_upd-1 + k*p->max_upd] = casadi_dot(p->nz, d->upd_u + k*p->nz, t);
+  }
+  // New column of U and S
+  casadi_qp_upd_col(d, d->n_upd-1);
+}
+
+// SYMBOL "qp_update"
+// Try to update the factorization for the current active set
+// Returns 1 if a full refactorization is needed
+template<typename T1>
+int casadi_qp_update(casadi_qp_data<T1>* d) {
+  // Local variables
+  casadi_int i, k;
+  const casadi_qp_prob<T1>* p = d->prob;
+  // Need a valid, nonsingular factorization
+  if (d->n_upd < 0) return 1;
+  // Loop over changes in the active set since the last update
+  for (i=0; i<p->nz; ++i) {
+    // Skip if column i of the KKT^T is unchanged
+    if ((d->lam[i]!=0) == d->upd_act[i]) continue;
+    // Update existing column, if any
+    for (k=0; k<d->n_upd; ++k) if (d->upd_ind[k]==i) break;
+    if (k<d->n_upd) {
+      casadi_qp_upd_col(d, k);
+    } else if (d->n_upd < p->max_upd) {
+      casadi_qp_upd_add(d, i);
+    } else {
+      // Too many updates, refactorize
+      return 1;
+    }
+  }
+  // Factorize S, refactorize if close to singular
+  return casadi_qp_upd_lu(d);
+}
+
 // SYMBOL "qp_flip_check"
 template<typename T1>
 int casadi_qp_flip_check(casadi_qp_data<T1>* d) {
@@ -658,15 +932,13 @@ int casadi_qp_flip_check(casadi_qp_data<T1>* d) {
   // Calculate the difference between old and new column index
   if (d->sign == 0) casadi_scal(p->nz, -1., d->dlam);
   // Try to find a linear combination of the new columns
-  casadi_qr_solve(d->dlam, 1, 0, p->sp_v, d->nz_v, p->sp_r, d->nz_r, d->beta,
-    p->prinv, p->pc, d->w);
+  casadi_qp_solve(d, d->dlam, 0);
   // If dlam[index]!=1, new columns must be linearly independent
   if (fabs(d->dlam[d->index]-1.) >= 1e-12) return 0;
   // Next, find a linear combination of the new rows
   casadi_clear(d->dz, p->nz);
   d->dz[d->index] = 1;
-  casadi_qr_solve(d->dz, 1, 1, p->sp_v, d->nz_v, p->sp_r, d->nz_r, d->beta,
-    p->prinv, p->pc, d->w);
+  casadi_qp_solve(d, d->dz, 1);
   // Normalize dlam, dz
   casadi_scal(p->nz, 1./sqrt(casadi_dot(p->nz, d->dlam, d->dlam)), d->dlam);
   casadi_scal(p->nz, 1./sqrt(casadi_dot(p->nz, d->dz, d->dz)), d->dz);
@@ -677,12 +949,19 @@ int casadi_qp_flip_check(casadi_qp_data<T1>* d) {
 // SYMBOL "qp_factorize"
 template<typename T1>
 void casadi_qp_factorize(casadi_qp_data<T1>* d) {
+  // Local variables
+  casadi_int i;
   const casadi_qp_prob<T1>* p = d->prob;
   // Do we already have a search direction due to lost singularity?
   if (d->has_search_dir) {
     d->sing = 1;
     return;
   }
+  // Low-rank update of the existing factorization, if possible
+  if (!casadi_qp_update(d)) {
+    d->sing = 0;
+    return;
+  }
   // Construct the KKT matrix
   casadi_qp_kkt(d);
   // QR factorization
@@ -690,6 +969,10 @@ void casadi_qp_factorize(casadi_qp_data<T1>* d) {
             d->nz_r, d->beta, p->prinv, p->pc);
   // Check singularity
   d->sing = casadi_qr_singular(&d->mina, &d->imina, d->nz_r, p->sp_r, p->pc, 1e-12);
+  // Active set corresponding to the factorization
+  for (i=0; i<p->nz; ++i) d->fact_act[i] = d->upd_act[i] = d->lam[i]!=0;
+  // Updates only possible for a nonsingular factorization
+  d->n_upd = d->sing ? -1 : 0;
 }
 
 // SYMBOL "qp_expand_step"
@@ -801,6 +1084,8 @@ int casadi_qp_singular_step(casadi_qp_data<T1>* d) {
     // One, given search direction
     nk = 1;
   } else {
+    // Factorization will no longer correspond to KKT^T
+    d->n_upd = -1;
     // QR factorization of the transpose
     casadi_trans(d->nz_kkt, p->sp_kkt, d->nz_v, p->sp_kkt, d->iw);
     nnz_kkt = p->sp_kkt[2+p->nz]; // kkt_colind[nz]
@@ -914,8 +1199,7 @@ int casadi_qp_calc_step(casadi_qp_data<T1>* d) {
   // Negative KKT residual
   casadi_qp_kkt_residual(d, d->dz);
   // Solve to get step in z[:nx] and lam[nx:]
-  casadi_qr_solve(d->dz, 1, 1, p->sp_v, d->nz_v, p->sp_r, d->nz_r, d->beta,
-                  p->prinv, p->pc, d->w);
+  casadi_qp_solve(d, d->dz, 1);
   // Have step in dz[:nx] and dlam[nx:]. Calculate complete dz and dlam
   casadi_qp_expand_step(d);
   // Successful return
@@ -1060,6 +1344,8 @@ int casadi_qp_prepare(casadi_qp_data<T1>* d) {
   const casadi_qp_prob<T1>* p = d->prob;
   // Calculate dependent quantities
   casadi_qp_calc_dependent(d);
+  // Update a reused factorization for the initial active set
+  if (d->iter == 0 && d->hot_start) casadi_qp_factorize(d);
   // Make an active set change
   casadi_qp_flip(d);
   // Form and factorize the KKT system
@@ -178,6 +178,130 @@ void casadi_qr_solve(T1* x, casadi_int nrhs, casadi_int tr,
   }
 }
 
+// SYMBOL "qr_mv_blk"
+// Multiply with Q or Q' for a block of nb vectors, stored interleaved: x[i*nb+j]
+// len[x] >= nb*nrow_ext, len[w] >= nb
+template<typename T1>
+void casadi_qr_mv_blk(const casadi_int* sp_v, const T1* v, const T1* beta, T1* x,
+                      casadi_int nb, casadi_int tr, T1* w) {
+  // Local variables
+  casadi_int ncol, c, c1, k, j;
+  const casadi_int *colind, *row;
+  T1 *xr;
+  // Extract sparsity
+  ncol=sp_v[1];
+  colind=sp_v+2; row=sp_v+2+ncol+1;
+  // Loop over vectors
+  for (c1=0; c1<ncol; ++c1) {
+    // Forward order for transpose, otherwise backwards
+    c = tr ? c1 : ncol-1-c1;
+    // Calculate scalar factors w = beta(c)*dot(v(:,c), x)
+    for (j=0; j<nb; ++j) w[j] = 0;
+    for (k=colind[c]; k<colind[c+1]; ++k) {
+      xr = x + row[k]*nb;
+      for (j=0; j<nb; ++j) w[j] += v[k]*xr[j];
+    }
+    for (j=0; j<nb; ++j) w[j] *= beta[c];
+    // x -= v(:,c)*w
+    for (k=colind[c]; k<colind[c+1]; ++k) {
+      xr = x + row[k]*nb;
+      for (j=0; j<nb; ++j) xr[j] -= w[j]*v[k];
+    }
+  }
+}
+
+// SYMBOL "qr_trs_blk"
+// Solve for an (optionally transposed) upper triangular matrix R
+// for a block of nb vectors, stored interleaved: x[i*nb+j]
+template<typename T1>
+void casadi_qr_trs_blk(const casadi_int* sp_r, const T1* nz_r, T1* x, casadi_int nb,
+                       casadi_int tr) {
+  // Local variables
+  casadi_int ncol, r, c, k, j;
+  const casadi_int *colind, *row;
+  T1 *xr, *xc;
+  // Extract sparsity
+  ncol=sp_r[1];
+  colind=sp_r+2; row=sp_r+2+ncol+1;
+  if (tr) {
+    // Forward substitution
+    for (c=0; c<ncol; ++c) {
+      xc = x + c*nb;
+      for (k=colind[c]; k<colind[c+1]; ++k) {
+        r = row[k];
+        if (r==c) {
+          for (j=0; j<nb; ++j) xc[j] /= nz_r[k];
+        } else {
+          xr = x + r*nb;
+          for (j=0; j<nb; ++j) xc[j] -= nz_r[k]*xr[j];
+        }
+      }
+    }
+  } else {
+    // Backward substitution
+    for (c=ncol-1; c>=0; --c) {
+      xc = x + c*nb;
+      for (k=colind[c+1]-1; k>=colind[c]; --k) {
+        r=row[k];
+        xr = x + r*nb;
+        if (r==c) {
+          for (j=0; j<nb; ++j) xr[j] /= nz_r[k];
+        } else {
+          for (j=0; j<nb; ++j) xr[j] -= nz_r[k]*xc[j];
+        }
+      }
+    }
+  }
+}
+
+// SYMBOL "qr_solve_blk"
+// Solve a factorized linear system, sweeping the factors once for every
+// block of up to nb right-hand-sides
+// len[w] >= nb*(max(ncol, nrow_ext)+1)
+template<typename T1>
+void casadi_qr_solve_blk(T1* x, casadi_int nrhs, casadi_int tr,
+                         const casadi_int* sp_v, const T1* v, const casadi_int* sp_r,
+                         const T1* r, const T1* beta, const casadi_int* prinv,
+                         const casadi_int* pc, T1* w, casadi_int nb) {
+  casadi_int k, c, j, nrow_ext, ncol, nk;
+  T1 *y;
+  nrow_ext = sp_v[0]; ncol = sp_v[1];
+  y = w + nb;
+  for (k=0; k<nrhs; k+=nk) {
+    // Number of right-hand-sides in this block
+    nk = nrhs-k < nb ? nrhs-k : nb;
+    for (c=0; c<nrow_ext*nk; ++c) y[c] = 0;
+    if (tr) {
+      // Multiply by PC
+      for (c=0; c<ncol; ++c) {
+        for (j=0; j<nk; ++j) y[c*nk+j] = x[j*ncol+pc[c]];
+      }
+      //  Solve for R'
+      casadi_qr_trs_blk(sp_r, r, y, nk, 1);
+      // Multiply by Q
+      casadi_qr_mv_blk(sp_v, v, beta, y, nk, 0, w);
+      // Multiply by PR'
+      for (c=0; c<ncol; ++c) {
+        for (j=0; j<nk; ++j) x[j*ncol+c] = y[prinv[c]*nk+j];
+      }
+    } else {
+      // Multiply with PR
+      for (c=0; c<ncol; ++c) {
+        for (j=0; j<nk; ++j) y[prinv[c]*nk+j] = x[j*ncol+c];
+      }
+      // Multiply with Q'
+      casadi_qr_mv_blk(sp_v, v, beta, y, nk, 1, w);
+      //  Solve for R
+      casadi_qr_trs_blk(sp_r, r, y, nk, 0);
+      // Multiply with PC'
+      for (c=0; c<ncol; ++c) {
+        for (j=0; j<nk; ++j) x[j*ncol+pc[c]] = y[c*nk+j];
+      }
+    }
+    x += nk*ncol;
+  }
+}
+
 // SYMBOL "qr_singular"
 // Check if QR factorization corresponds to a singular matrix
 template<typename T1>
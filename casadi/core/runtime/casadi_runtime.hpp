@@ -153,7 +153,9 @@ namespace casadi {
   // Get weights for the multilinear interpolant
   template<typename T1>
   void casadi_interpn_weights(casadi_int ndim, const T1* grid, const casadi_int* offset,
-                                      const T1* x, T1* alpha, casadi_int* index);
+                              const T1* x, T1* alpha, casadi_int* index,
+                              const casadi_int* lookup_mode, const casadi_int* lookup_index,
+                              const casadi_int* lookup_offset);
 
   // Get coefficients for the multilinear interpolant
   template<typename T1>
@@ -163,13 +165,24 @@ namespace casadi {
 
   // Multilinear interpolant
   template<typename T1>
-  T1 casadi_interpn(casadi_int ndim, const T1* grid, const casadi_int* offset, const T1* values,
-                            const T1* x, casadi_int* iw, T1* w);
+  void casadi_interpn(T1* res, casadi_int ndim, const T1* grid, const casadi_int* offset,
+                      const T1* values, const T1* x, const casadi_int* lookup_mode,
+                      const casadi_int* lookup_index, const casadi_int* lookup_offset,
+                      casadi_int m, casadi_int* iw, T1* w);
+
+  // Multilinear interpolant at multiple points
+  template<typename T1>
+  void casadi_interpn_batch(T1* res, casadi_int ndim, const T1* grid, const casadi_int* offset,
+                            const T1* values, const T1* x, const casadi_int* lookup_mode,
+                            const casadi_int* lookup_index, const casadi_int* lookup_offset,
+                            casadi_int m, casadi_int npoints, casadi_int* iw, T1* w);
 
   // Multilinear interpolant - calculate gradient
   template<typename T1>
   void casadi_interpn_grad(T1* grad, casadi_int ndim, const T1* grid, const casadi_int* offset,
-                                   const T1* values, const T1* x, casadi_int* iw, T1* w);
+                           const T1* values, const T1* x, const casadi_int* lookup_mode,
+                           const casadi_int* lookup_index, const casadi_int* lookup_offset,
+                           casadi_int m, casadi_int* iw, T1* w);
 
   // De boor single basis evaluation
   template<typename T1>
@@ -182,6 +195,13 @@ namespace casadi {
                             casadi_int m,
                             const T1* x, const casadi_int* lookup_mode, casadi_int* iw, T1* w);
 
+  // De boor nd basis values and coefficient indices
+  template<typename T1>
+  casadi_int casadi_nd_boor_dual_eval(T1* val, casadi_int* nz, casadi_int n_dims,
+                            const T1* knots, const casadi_int* offset,
+                            const casadi_int* degree, const casadi_int* strides,
+                            const T1* x, const casadi_int* lookup_mode, casadi_int* iw, T1* w);
+
   template<typename T1>
   T1 casadi_mmax(const T1* x, casadi_int n, T1 is_dense);
 
@@ -213,7 +233,7 @@ namespace casadi {
 
   // Newton step
   template<typename T1>
-  int casadi_newton(const casadi_newton_mem<T1>* m);
+  int casadi_newton(casadi_newton_mem<T1>* m);
 
   // Dense matrix multiplication
   #define CASADI_GEMM_NT(M, N, K, A, LDA, B, LDB, C, LDC) \
@@ -255,22 +275,28 @@ namespace casadi {
   #include "casadi_de_boor.hpp"
   #include "casadi_nd_boor_eval.hpp"
   #include "casadi_nd_boor_dual_eval.hpp"
+  #include "casadi_nd_boor_basis.hpp"
   #include "casadi_interpn_weights.hpp"
   #include "casadi_interpn_interpolate.hpp"
   #include "casadi_interpn.hpp"
   #include "casadi_interpn_grad.hpp"
+  #include "casadi_interpn_batch.hpp"
   #include "casadi_mv_dense.hpp"
   #include "casadi_finite_diff.hpp"
   #include "casadi_ldl.hpp"
   #include "casadi_qr.hpp"
   #include "casadi_qp.hpp"
+  #include "casadi_ipqp.hpp"
   #include "casadi_nlp.hpp"
-  #include "casadi_sqpmethod.hpp"
   #include "casadi_bfgs.hpp"
+  #include "casadi_lbfgs.hpp"
+  #include "casadi_sqpmethod.hpp"
   #include "casadi_regularize.hpp"
   #include "casadi_newton.hpp"
   #include "casadi_bound_consistency.hpp"
   #include "casadi_lsqr.hpp"
+  #include "casadi_krylov.hpp"
+  #include "casadi_expm.hpp"
 
 } // namespace casadi
 
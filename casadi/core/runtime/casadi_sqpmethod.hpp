@@ -1,6 +1,7 @@
 // NOLINT(legal/copyright)
 
 // C-REPLACE "casadi_nlpsol_prob<T1>" "struct casadi_nlpsol_prob"
+// C-REPLACE "casadi_lbfgs_mem<T1>" "struct casadi_lbfgs_mem"
 
 // SYMBOL "sqpmethod_prob"
 template<typename T1>
@@ -10,6 +11,9 @@ struct casadi_sqpmethod_prob {
   const casadi_int *sp_h, *sp_a;
   casadi_int merit_memsize;
   casadi_int max_iter_ls;
+  // Number of L-BFGS pairs. The zero-initialized default 0 gives a BFGS
+  // update of the full Bk, as before the field existed
+  casadi_int lbfgs_m;
 };
 // C-REPLACE "casadi_sqpmethod_prob<T1>" "struct casadi_sqpmethod_prob"
 
@@ -31,6 +35,8 @@ struct casadi_sqpmethod_data {
   T1 *dx, *dlam;
   // Hessian approximation
   T1* Bk;
+  // Limited-memory Hessian approximation, if lbfgs_m>0
+  casadi_lbfgs_mem<T1> lbfgs;
   // Jacobian
   T1* Jk;
   // merit_mem
@@ -66,6 +72,7 @@ void casadi_sqpmethod_work(const casadi_sqpmethod_prob<T1>* p,
   *sz_w += nx + ng; // dlam
   // Hessian approximation
   *sz_w += nnz_h; // Bk
+  if (p->lbfgs_m>0) *sz_w += casadi_lbfgs_work(nx, p->lbfgs_m); // lbfgs
   // Jacobian
   *sz_w += nnz_a; // Jk
   // merit_mem
@@ -100,6 +107,11 @@ void casadi_sqpmethod_init(casadi_sqpmethod_data<T1>* d, casadi_int** iw, T1** w
   d->dlam = *w; *w += nx + ng;
   // Hessian approximation
   d->Bk = *w; *w += nnz_h;
+  if (p->lbfgs_m>0) {
+    d->lbfgs.nx = nx;
+    d->lbfgs.m = p->lbfgs_m;
+    casadi_lbfgs_init(&d->lbfgs, w);
+  }
   // Jacobian
   d->Jk = *w; *w += nnz_a;
   // merit_mem
@@ -108,3 +120,32 @@ void casadi_sqpmethod_init(casadi_sqpmethod_data<T1>* d, casadi_int** iw, T1** w
     *w += p->merit_memsize;
   }
 }
+
+// SYMBOL "sqpmethod_hess_update"
+// Update the Hessian approximation Bk after a step dx.
+// With L-BFGS, Bk holds the approximation restricted to the pattern sp_h,
+// e.g. its diagonal, while products with the full approximation are available
+// through casadi_lbfgs_mv. len[w] = 2*nx
+template<typename T1>
+void casadi_sqpmethod_hess_update(casadi_sqpmethod_data<T1>* d, T1* w) {
+  const casadi_sqpmethod_prob<T1>* p = d->prob;
+  if (p->lbfgs_m>0) {
+    casadi_lbfgs_update(&d->lbfgs, d->dx, d->gLag, d->gLag_old);
+    casadi_lbfgs_project(&d->lbfgs, p->sp_h, d->Bk);
+  } else {
+    casadi_bfgs(p->sp_h, d->Bk, d->dx, d->gLag, d->gLag_old, w);
+  }
+}
+
+// SYMBOL "sqpmethod_hess_reset"
+// Restart the Hessian approximation
+template<typename T1>
+void casadi_sqpmethod_hess_reset(casadi_sqpmethod_data<T1>* d) {
+  const casadi_sqpmethod_prob<T1>* p = d->prob;
+  if (p->lbfgs_m>0) {
+    casadi_lbfgs_reset(&d->lbfgs);
+    casadi_lbfgs_project(&d->lbfgs, p->sp_h, d->Bk);
+  } else {
+    casadi_bfgs_reset(p->sp_h, d->Bk);
+  }
+}
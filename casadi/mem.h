@@ -32,9 +32,24 @@ extern "C" {
 
 #ifndef CASADI_STATIC
 #include <stdlib.h>
+#ifdef _WIN32
+#include <malloc.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#endif /* _WIN32 */
 #endif /* CASADI_STATIC */
 #include <assert.h>
 
+/* Alignment of the work vectors in a memory pool, in bytes (cache line) */
+#ifndef CASADI_MEM_ALIGN
+#define CASADI_MEM_ALIGN 64
+#endif
+
+/* Alignment of memory pools allocated on huge pages, in bytes */
+#ifndef CASADI_MEM_HUGE_PAGE
+#define CASADI_MEM_HUGE_PAGE 2097152
+#endif
+
 /* Floating point type */
 #ifndef casadi_real
 #define casadi_real double
@@ -54,6 +69,11 @@ typedef int (*casadi_work_t)(casadi_int* sz_arg, casadi_int* sz_res,
                              casadi_int* sz_iw, casadi_int* sz_w);
 typedef int (*casadi_eval_t)(const casadi_real** arg, casadi_real** res,
                              casadi_int* iw, casadi_real* w, void* mem);
+/* Evaluate n instances: input/output k of instance i starts at arg[k]/res[k] + i*nnz,
+   where nnz is the number of nonzeros of input/output k. Null pointers are skipped.
+   Work vectors are sized by the work entry point, as for a single evaluation. */
+typedef int (*casadi_eval_batch_t)(casadi_int n, const casadi_real** arg, casadi_real** res,
+                                   casadi_int* iw, casadi_real* w, void* mem);
 
 /* Structure to hold meta information about an input or output */
 typedef struct {
@@ -107,6 +127,10 @@ typedef struct {
   /* Function pointers */
   casadi_functions* f;
 
+  /* Optional <name>_eval_batch entry point, looked up separately by the
+     caller since casadi_functions has a fixed layout. Null if absent */
+  casadi_eval_batch_t eval_batch;
+
   /* Work arrays */
   casadi_int sz_arg, sz_res, sz_iw, sz_w;
   const casadi_real** arg;
@@ -131,6 +155,7 @@ inline void casadi_init(casadi_mem* mem, casadi_functions* f) {
 
   /* Store function pointers */
   mem->f = f;
+  mem->eval_batch = 0;
 
   /* Increase reference counter */
   if (f->incref) f->incref();
@@ -243,6 +268,29 @@ inline int casadi_eval(casadi_mem* mem) {
   return mem->f->eval(mem->arg, mem->res, mem->iw, mem->w, mem->mem);
 }
 
+/* Evaluate n instances, inputs and outputs stored one instance after the other */
+inline int casadi_eval_batch(casadi_mem* mem, casadi_int n) {
+  casadi_int i, k;
+  int flag;
+  assert(mem!=0);
+  if (mem->eval_batch) {
+    return mem->eval_batch(n, mem->arg, mem->res, mem->iw, mem->w, mem->mem);
+  }
+  /* Fall back to one evaluation per instance, requires initialized io meta data */
+  assert(mem->in!=0 && mem->out!=0);
+  flag = 0;
+  for (i=0; i<n; ++i) {
+    flag = mem->f->eval(mem->arg, mem->res, mem->iw, mem->w, mem->mem);
+    if (flag) break;
+    for (k=0; k<mem->n_in; ++k) if (mem->arg[k]) mem->arg[k] += mem->in[k].nnz;
+    for (k=0; k<mem->n_out; ++k) if (mem->res[k]) mem->res[k] += mem->out[k].nnz;
+  }
+  /* Restore pointers */
+  for (k=0; k<mem->n_in; ++k) if (mem->arg[k]) mem->arg[k] -= i*mem->in[k].nnz;
+  for (k=0; k<mem->n_out; ++k) if (mem->res[k]) mem->res[k] -= i*mem->out[k].nnz;
+  return flag;
+}
+
 /* Create a memory struct with dynamic memory allocation */
 #ifndef CASADI_STATIC
 inline casadi_mem* casadi_alloc(casadi_functions* f) {
@@ -282,6 +330,178 @@ inline void casadi_free(casadi_mem* mem) {
 }
 #endif /* CASADI_STATIC */
 
+/* Pool of memory objects, typically one per thread.
+   The work vectors of all memory objects share one block, where each vector
+   starts on its own cache line so that threads never share one.
+   Only available with dynamic memory allocation */
+#ifndef CASADI_STATIC
+typedef void* (*casadi_alloc_mem_t)(void);
+typedef int (*casadi_init_mem_t)(void* mem);
+typedef void (*casadi_free_mem_t)(void* mem);
+
+typedef struct {
+  casadi_int n;
+  casadi_mem* mem;
+  casadi_io* in;
+  casadi_io* out;
+  void* block;
+  size_t block_size;
+  int huge_pages;
+  /* Optional <name>_free_mem entry point, releases the function memory of each slot */
+  casadi_free_mem_t free_mem;
+  /* Slots handed out by casadi_pool_checkout */
+  int* busy;
+} casadi_mem_pool;
+
+/* Round up to a multiple of the alignment */
+inline size_t casadi_mem_pad(size_t sz) {
+  return (sz + CASADI_MEM_ALIGN - 1) / CASADI_MEM_ALIGN * CASADI_MEM_ALIGN;
+}
+
+/* Allocate aligned memory, optionally advising huge pages */
+inline void* casadi_alloc_aligned(size_t sz, int huge_pages) {
+  void* p = 0;
+#ifdef _WIN32
+  (void)huge_pages;
+  p = _aligned_malloc(sz, CASADI_MEM_ALIGN);
+#else /* _WIN32 */
+  if (posix_memalign(&p, huge_pages ? CASADI_MEM_HUGE_PAGE : CASADI_MEM_ALIGN, sz)) return 0;
+#ifdef MADV_HUGEPAGE
+  if (huge_pages) madvise(p, sz, MADV_HUGEPAGE);
+#endif /* MADV_HUGEPAGE */
+#endif /* _WIN32 */
+  return p;
+}
+
+/* Free memory allocated with casadi_alloc_aligned */
+inline void casadi_free_aligned(void* p) {
+#ifdef _WIN32
+  _aligned_free(p);
+#else /* _WIN32 */
+  free(p);
+#endif /* _WIN32 */
+}
+
+/* Create a pool of n memory objects, e.g. one per thread */
+inline int casadi_pool_init(casadi_mem_pool* pool, casadi_functions* f, casadi_int n,
+                            int huge_pages) {
+  casadi_int i;
+  size_t sz_arg, sz_res, sz_iw, sz_w, sz;
+  char* p;
+  assert(pool!=0);
+  assert(n>0);
+  pool->n = n;
+  pool->huge_pages = huge_pages;
+  pool->block = 0;
+  pool->in = pool->out = 0;
+  pool->free_mem = 0;
+  pool->busy = 0;
+
+  /* Initialize the memory objects, all slots available */
+  pool->mem = (casadi_mem*)malloc(n*sizeof(casadi_mem));
+  if (pool->mem==0) return 1;
+  for (i=0; i<n; ++i) casadi_init(pool->mem+i, f);
+  pool->busy = (int*)calloc(n, sizeof(int));
+  if (pool->busy==0) return 1;
+
+  /* Meta information is shared between the memory objects */
+  pool->in = (casadi_io*)malloc(pool->mem->n_in*sizeof(casadi_io));
+  if (pool->mem->n_in!=0 && pool->in==0) return 1;
+  pool->out = (casadi_io*)malloc(pool->mem->n_out*sizeof(casadi_io));
+  if (pool->mem->n_out!=0 && pool->out==0) return 1;
+  pool->mem->in = pool->in;
+  pool->mem->out = pool->out;
+  casadi_init_arrays(pool->mem);
+
+  /* One block for all work vectors */
+  sz_arg = casadi_mem_pad(pool->mem->sz_arg*sizeof(const casadi_real*));
+  sz_res = casadi_mem_pad(pool->mem->sz_res*sizeof(casadi_real*));
+  sz_iw = casadi_mem_pad(pool->mem->sz_iw*sizeof(casadi_int));
+  sz_w = casadi_mem_pad(pool->mem->sz_w*sizeof(casadi_real));
+  sz = sz_arg + sz_res + sz_iw + sz_w;
+  pool->block_size = n*sz;
+  if (pool->block_size==0) pool->block_size = CASADI_MEM_ALIGN;
+  pool->block = casadi_alloc_aligned(pool->block_size, huge_pages);
+  if (pool->block==0) return 1;
+
+  /* Distribute */
+  p = (char*)pool->block;
+  for (i=0; i<n; ++i) {
+    pool->mem[i].in = pool->in;
+    pool->mem[i].out = pool->out;
+    pool->mem[i].arg = (const casadi_real**)p; p += sz_arg;
+    pool->mem[i].res = (casadi_real**)p; p += sz_res;
+    pool->mem[i].iw = (casadi_int*)p; p += sz_iw;
+    pool->mem[i].w = (casadi_real*)p; p += sz_w;
+  }
+  return 0;
+}
+
+/* Give each slot its own function memory, for functions that export the
+   optional <name>_alloc_mem, <name>_init_mem and <name>_free_mem entry points.
+   Looked up separately by the caller; null pointers are skipped */
+inline int casadi_pool_init_mem(casadi_mem_pool* pool, casadi_alloc_mem_t alloc_mem,
+                                casadi_init_mem_t init_mem, casadi_free_mem_t free_mem) {
+  casadi_int i;
+  assert(pool!=0);
+  pool->free_mem = free_mem;
+  for (i=0; i<pool->n; ++i) {
+    if (alloc_mem) {
+      pool->mem[i].mem = alloc_mem();
+      if (pool->mem[i].mem==0) return 1;
+    }
+    if (init_mem && init_mem(pool->mem[i].mem)) return 1;
+  }
+  return 0;
+}
+
+/* Check out an unused slot, returns its index or -1 if all are in use.
+   Not synchronized: threads either use fixed slots via casadi_pool_mem, or
+   serialize their calls to casadi_pool_checkout and casadi_pool_release */
+inline casadi_int casadi_pool_checkout(casadi_mem_pool* pool) {
+  casadi_int i;
+  assert(pool!=0);
+  for (i=0; i<pool->n; ++i) {
+    if (!pool->busy[i]) {
+      pool->busy[i] = 1;
+      return i;
+    }
+  }
+  return -1;
+}
+
+/* Return a slot obtained from casadi_pool_checkout */
+inline void casadi_pool_release(casadi_mem_pool* pool, casadi_int i) {
+  assert(pool!=0);
+  assert(i>=0 && i<pool->n && pool->busy[i]);
+  pool->busy[i] = 0;
+}
+
+/* Memory object i of a pool, to be used by one thread at a time */
+inline casadi_mem* casadi_pool_mem(casadi_mem_pool* pool, casadi_int i) {
+  assert(pool!=0);
+  assert(i>=0 && i<pool->n);
+  return pool->mem + i;
+}
+
+/* Free a pool */
+inline void casadi_pool_free(casadi_mem_pool* pool) {
+  casadi_int i;
+  assert(pool!=0);
+  if (pool->block) casadi_free_aligned(pool->block);
+  if (pool->in) free(pool->in);
+  if (pool->out) free(pool->out);
+  if (pool->busy) free(pool->busy);
+  if (pool->mem) {
+    for (i=0; i<pool->n; ++i) {
+      if (pool->free_mem && pool->mem[i].mem) pool->free_mem(pool->mem[i].mem);
+      casadi_deinit(pool->mem+i);
+    }
+    free(pool->mem);
+  }
+}
+#endif /* CASADI_STATIC */
+
 #ifdef __cplusplus
 }
 #endif
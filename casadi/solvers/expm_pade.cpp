@@ -0,0 +1,268 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+
+#include "expm_pade.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_EXPM_PADE_EXPORT
+  casadi_register_expm_pade(Expm::Plugin* plugin) {
+    plugin->creator = ExpmPade::creator;
+    plugin->name = "pade";
+    plugin->doc = ExpmPade::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Expm::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_EXPM_PADE_EXPORT casadi_load_expm_pade() {
+    Expm::registerPlugin(casadi_register_expm_pade);
+  }
+
+  ExpmPade::ExpmPade(const std::string& name, const Sparsity& A) : Expm(name, A) {
+  }
+
+  ExpmPade::~ExpmPade() {
+    clear_mem();
+  }
+
+  void ExpmPade::init(const Dict& opts) {
+    // Call the init method of the base class
+    Expm::init(opts);
+    n_ = A_.size1();
+
+    // Strongly connected components of the graph of A
+    vector<casadi_int> index, offset;
+    casadi_int nscc = A_.scc(index, offset);
+    vector<casadi_int> comp(n_);
+    for (casadi_int c=0; c<nscc; ++c) {
+      for (casadi_int k=offset[c]; k<offset[c+1]; ++k) comp[index[k]] = c;
+    }
+
+    // Structurally nonzero blocks of A between different components
+    vector< vector<casadi_int> > succ(nscc);
+    const casadi_int* colind = A_.colind();
+    const casadi_int* row = A_.row();
+    for (casadi_int c=0; c<n_; ++c) {
+      for (casadi_int k=colind[c]; k<colind[c+1]; ++k) {
+        casadi_int I = comp[row[k]], J = comp[c];
+        if (I!=J) succ[I].push_back(J);
+      }
+    }
+
+    // Block (I, J) of a power of A is structurally nonzero if J can be reached from I
+    vector<casadi_int> reach(nscc*nscc, 0), stack;
+    for (casadi_int I=0; I<nscc; ++I) {
+      reach[I+I*nscc] = 1;
+      stack.push_back(I);
+      while (!stack.empty()) {
+        casadi_int K = stack.back();
+        stack.pop_back();
+        for (casadi_int J : succ[K]) {
+          if (!reach[I+J*nscc]) {
+            reach[I+J*nscc] = 1;
+            stack.push_back(J);
+          }
+        }
+      }
+    }
+
+    // Order the components such that the blocks become upper triangular:
+    // if J can be reached from I, J has more predecessors than I
+    vector<casadi_int> npred(nscc, 0), order(nscc);
+    for (casadi_int J=0; J<nscc; ++J) {
+      for (casadi_int I=0; I<nscc; ++I) npred[J] += reach[I+J*nscc];
+    }
+    for (casadi_int I=0; I<nscc; ++I) order[I] = I;
+    stable_sort(order.begin(), order.end(),
+      [&npred](casadi_int I, casadi_int J) { return npred[I] < npred[J];});
+
+    // Symmetric permutation and block structure
+    iperm_.resize(n_);
+    blk_.resize(nscc+1);
+    blk_[0] = 0;
+    for (casadi_int b=0; b<nscc; ++b) {
+      casadi_int I = order[b];
+      blk_[b+1] = blk_[b] + offset[I+1] - offset[I];
+      for (casadi_int k=offset[I]; k<offset[I+1]; ++k) {
+        iperm_[index[k]] = blk_[b] + k - offset[I];
+      }
+    }
+    mask_.resize(nscc*nscc);
+    for (casadi_int b1=0; b1<nscc; ++b1) {
+      for (casadi_int b2=0; b2<nscc; ++b2) {
+        mask_[b1+b2*nscc] = reach[order[b1]+order[b2]*nscc];
+      }
+    }
+
+    if (verbose_) {
+      casadi_message("ExpmPade: " + str(nscc) + " diagonal blocks");
+    }
+
+    // Dense A, its powers, result and work for casadi_expm
+    alloc_w(9*n_*n_);
+  }
+
+  int ExpmPade::init_mem(void* mem) const {
+    if (!mem) return 1;
+    auto m = static_cast<ExpmPadeMemory*>(mem);
+    m->a.resize(A_.nnz());
+    m->ad.resize(n_*n_);
+    m->p.resize(3*n_*n_);
+    m->e.resize(n_*n_);
+    m->t = 0;
+    m->has_a = m->has_e = false;
+    return 0;
+  }
+
+  int ExpmPade::eval(const double** arg, double** res, casadi_int* iw, double* w,
+                     void* mem) const {
+    auto m = static_cast<ExpmPadeMemory*>(mem);
+    if (!res[0]) return 0;
+    double t = arg[1] ? *arg[1] : 0;
+    casadi_int nb = blk_.size()-1;
+
+    // Reuse the powers of A if A is unchanged
+    bool new_a = !m->has_a;
+    if (!new_a && !const_A_) {
+      if (arg[0]) {
+        new_a = !equal(arg[0], arg[0]+A_.nnz(), m->a.begin());
+      } else {
+        new_a = any_of(m->a.begin(), m->a.end(), [](double v) { return v!=0;});
+      }
+    }
+    if (new_a) {
+      if (arg[0]) {
+        casadi_copy(arg[0], A_.nnz(), get_ptr(m->a));
+      } else {
+        casadi_clear(get_ptr(m->a), A_.nnz());
+      }
+      casadi_expm_densify(A_, get_ptr(m->a), get_ptr(iperm_), get_ptr(m->ad));
+      casadi_expm_powers(n_, nb, get_ptr(blk_), get_ptr(mask_), get_ptr(m->ad), get_ptr(m->p));
+      m->has_a = true;
+      m->has_e = false;
+    }
+
+    // Calculate the exponential, unless t is unchanged as well
+    if (!m->has_e || t!=m->t) {
+      m->has_e = false;
+      if (casadi_expm(n_, nb, get_ptr(blk_), get_ptr(mask_), get_ptr(m->ad), get_ptr(m->p),
+                      t, get_ptr(m->e), w)) {
+        if (verbose_) casadi_warning("ExpmPade: singular Pade denominator");
+        return 1;
+      }
+      m->t = t;
+      m->has_e = true;
+    }
+    casadi_expm_sparsify(get_ptr(m->e), get_ptr(iperm_), sparsity_out(0), res[0]);
+    return 0;
+  }
+
+  MX ExpmPade::frechet(const MX& A, const MX& B, const MX& t) const {
+    casadi_int n = A.size1(), nd = B.size2()/n;
+    MX M = MX::blockcat({{A, B}, {MX(nd*n, n), MX::diagcat(vector<MX>(nd, A))}});
+    Function F = expmsol(name_ + "_frechet", plugin_name(), M.sparsity());
+    MX E = F(vector<MX>{M, t}).at(0);
+    return E(Slice(0, n), Slice(n, (nd+1)*n));
+  }
+
+  Function ExpmPade::get_forward(casadi_int nfwd, const std::string& name,
+                                 const std::vector<std::string>& inames,
+                                 const std::vector<std::string>& onames,
+                                 const Dict& opts) const {
+    MX A = MX::sym("A", A_);
+    MX t = MX::sym("t");
+    MX Y = MX::sym("Y", sparsity_out(0));
+    MX fwd_A = MX::sym("fwd_A", repmat(A_, 1, nfwd));
+    MX fwd_t = MX::sym("fwd_t", 1, nfwd);
+
+    // A commutes with expm(A*t): the t-sensitivity is A*Y*fwd_t
+    MX AY = mtimes(A, Y);
+    vector<MX> fwd_Y(nfwd);
+    for (casadi_int d=0; d<nfwd; ++d) fwd_Y[d] = AY*fwd_t(d);
+
+    // L(A*t, fwd_A*t), the upper right blocks of expm([A, fwd_A; 0, diag(A)]*t)
+    if (!const_A_) {
+      vector<MX> L = horzsplit(frechet(A, fwd_A, t), n_);
+      for (casadi_int d=0; d<nfwd; ++d) fwd_Y[d] += L[d];
+    }
+    MX fwd = MX::project(horzcat(fwd_Y), repmat(sparsity_out(0), 1, nfwd));
+    return Function(name, {A, t, Y, fwd_A, fwd_t}, {fwd}, inames, onames, opts);
+  }
+
+  Function ExpmPade::get_reverse(casadi_int nadj, const std::string& name,
+                                 const std::vector<std::string>& inames,
+                                 const std::vector<std::string>& onames,
+                                 const Dict& opts) const {
+    MX A = MX::sym("A", A_);
+    MX t = MX::sym("t");
+    MX Y = MX::sym("Y", sparsity_out(0));
+    MX adj_Y = MX::sym("adj_Y", repmat(sparsity_out(0), 1, nadj));
+    vector<MX> Ybar = horzsplit(adj_Y, n_);
+
+    // Adjoint of the t-sensitivity A*Y*fwd_t
+    MX AY = mtimes(A, Y);
+    vector<MX> adj_t(nadj);
+    for (casadi_int d=0; d<nadj; ++d) adj_t[d] = dot(Ybar[d], AY);
+
+    // The adjoint of L(A*t, .) is L(A'*t, .)
+    MX adj_A;
+    if (const_A_) {
+      adj_A = MX(n_, n_*nadj);
+    } else {
+      adj_A = frechet(A.T(), adj_Y, t);
+    }
+    adj_A = MX::project(adj_A, repmat(A_, 1, nadj));
+    return Function(name, {A, t, Y, adj_Y}, {adj_A, horzcat(adj_t)}, inames, onames, opts);
+  }
+
+  void ExpmPade::codegen_body(CodeGenerator& g) const {
+    g.add_auxiliary(CodeGenerator::AUX_EXPM);
+    casadi_int nn = n_*n_, nb = blk_.size()-1;
+    std::string blk = g.constant(blk_), mask = g.constant(mask_);
+    g << "if (!res[0]) return 0;\n";
+    g.comment("Dense permuted A and its powers");
+    g << "if (arg[0]) {\n"
+      << "casadi_expm_densify(" << g.sparsity(A_) << ", arg[0], " << g.constant(iperm_)
+      << ", w);\n"
+      << "} else {\n"
+      << "casadi_clear(w, " << nn << ");\n"
+      << "}\n";
+    g << "casadi_expm_powers(" << n_ << ", " << nb << ", " << blk << ", " << mask
+      << ", w, w+" << nn << ");\n";
+    g.comment("Exponential");
+    g << "if (casadi_expm(" << n_ << ", " << nb << ", " << blk << ", " << mask
+      << ", w, w+" << nn << ", arg[1] ? *arg[1] : 0, w+" << 4*nn << ", w+" << 5*nn
+      << ")) return 1;\n";
+    g << "casadi_expm_sparsify(w+" << 4*nn << ", " << g.constant(iperm_) << ", "
+      << g.sparsity(sparsity_out(0)) << ", res[0]);\n";
+  }
+
+} // namespace casadi
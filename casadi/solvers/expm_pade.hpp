@@ -0,0 +1,134 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_EXPM_PADE_HPP
+#define CASADI_EXPM_PADE_HPP
+
+/** \defgroup plugin_Expm_pade
+ * Matrix exponential by scaling and squaring with Pade approximants
+ */
+
+/** \pluginsection{Expm,pade} */
+
+/// \cond INTERNAL
+#include "casadi/core/expm_impl.hpp"
+#include <casadi/solvers/casadi_expm_pade_export.h>
+
+namespace casadi {
+  struct CASADI_EXPM_PADE_EXPORT ExpmPadeMemory {
+    // Nonzeros of A in the last call
+    std::vector<double> a;
+    // Dense permuted A, its powers A^2, A^4, A^6 and the last result
+    std::vector<double> ad, p, e;
+    // Time in the last call
+    double t;
+    // Cached entries valid?
+    bool has_a, has_e;
+  };
+
+  /** \brief \pluginbrief{Expm,pade}
+   * @copydoc Expm_doc
+   * @copydoc plugin_Expm_pade
+   */
+  class CASADI_EXPM_PADE_EXPORT ExpmPade : public Expm {
+  public:
+    // Constructor
+    ExpmPade(const std::string& name, const Sparsity& A);
+
+    /** \brief  Create a new Expm */
+    static Expm* creator(const std::string& name, const Sparsity& A) {
+      return new ExpmPade(name, A);
+    }
+
+    // Destructor
+    ~ExpmPade() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "pade";}
+
+    // Get name of the class
+    std::string class_name() const override { return "ExpmPade";}
+
+    // Initialize
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new ExpmPadeMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<ExpmPadeMemory*>(mem);}
+
+    /** \brief  Evaluate numerically */
+    int eval(const double** arg, double** res, casadi_int* iw, double* w,
+             void* mem) const override;
+
+    ///@{
+    /** \brief Forward sensitivities through the Frechet derivative */
+    Function get_forward(casadi_int nfwd, const std::string& name,
+                         const std::vector<std::string>& inames,
+                         const std::vector<std::string>& onames,
+                         const Dict& opts) const override;
+    ///@}
+
+    ///@{
+    /** \brief Adjoint sensitivities through the Frechet derivative */
+    Function get_reverse(casadi_int nadj, const std::string& name,
+                         const std::vector<std::string>& inames,
+                         const std::vector<std::string>& onames,
+                         const Dict& opts) const override;
+    ///@}
+
+    /** \brief Is codegen supported? */
+    bool has_codegen() const override { return true;}
+
+    /** \brief Generate code for the function body */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+  private:
+    // Exponential of the augmented matrix [A, B; 0, diag(A, ..., A)]
+    MX frechet(const MX& A, const MX& B, const MX& t) const;
+
+    // Dimension
+    casadi_int n_;
+
+    // Symmetric permutation to block upper triangular form, inverse
+    std::vector<casadi_int> iperm_;
+
+    // Block offsets, structurally nonzero blocks of the powers of A
+    std::vector<casadi_int> blk_, mask_;
+  };
+
+} // namespace casadi
+
+/// \endcond
+
+#endif // CASADI_EXPM_PADE_HPP
@@ -0,0 +1,39 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+
+
+      #include "expm_pade.hpp"
+      #include <string>
+
+      const std::string casadi::ExpmPade::meta_doc=
+      "\n"
+"Matrix exponential by scaling and squaring with [m/m] Pade approximants,\n"
+"m in {3, 5, 7, 9, 13} (Higham, 2005). A is symmetrically permuted to\n"
+"block upper triangular form and the dense kernels skip the blocks that\n"
+"remain structurally zero. The powers of A are cached and reused when\n"
+"only t changes. Sensitivities use the Frechet derivative.\n"
+"\n";
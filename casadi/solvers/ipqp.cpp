@@ -0,0 +1,323 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "ipqp.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_CONIC_IPQP_EXPORT
+  casadi_register_conic_ipqp(Conic::Plugin* plugin) {
+    plugin->creator = Ipqp::creator;
+    plugin->name = "ipqp";
+    plugin->doc = Ipqp::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Ipqp::options_;
+    plugin->deserialize = &Ipqp::deserialize;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_CONIC_IPQP_EXPORT casadi_load_conic_ipqp() {
+    Conic::registerPlugin(casadi_register_conic_ipqp);
+  }
+
+  Ipqp::Ipqp(const std::string& name, const std::map<std::string, Sparsity> &st)
+    : Conic(name, st) {
+  }
+
+  Ipqp::~Ipqp() {
+    clear_mem();
+  }
+
+  const Options Ipqp::options_
+  = {{&Conic::options_},
+     {{"max_iter",
+       {OT_INT,
+        "Maximum number of iterations [100]."}},
+      {"constr_viol_tol",
+       {OT_DOUBLE,
+        "Constraint violation tolerance [1e-8]."}},
+      {"dual_inf_tol",
+       {OT_DOUBLE,
+        "Dual feasibility violation tolerance [1e-8]"}},
+      {"compl_tol",
+       {OT_DOUBLE,
+        "Average complementarity violation tolerance [1e-8]"}},
+      {"print_header",
+       {OT_BOOL,
+        "Print header [true]."}},
+      {"print_iter",
+       {OT_BOOL,
+        "Print iterations [true]."}}
+     }
+  };
+
+  void Ipqp::init(const Dict& opts) {
+    // Initialize the base classes
+    Conic::init(opts);
+    // Default options
+    print_iter_ = true;
+    print_header_ = true;
+    max_iter_ = 100;
+    constr_viol_tol_ = 1e-8;
+    dual_inf_tol_ = 1e-8;
+    compl_tol_ = 1e-8;
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="max_iter") {
+        max_iter_ = op.second;
+      } else if (op.first=="constr_viol_tol") {
+        constr_viol_tol_ = op.second;
+      } else if (op.first=="dual_inf_tol") {
+        dual_inf_tol_ = op.second;
+      } else if (op.first=="compl_tol") {
+        compl_tol_ = op.second;
+      } else if (op.first=="print_iter") {
+        print_iter_ = op.second;
+      } else if (op.first=="print_header") {
+        print_header_ = op.second;
+      }
+    }
+    // Transpose of the Jacobian
+    AT_ = A_.T();
+    // Assemble KKT system sparsity, symbolic factorization done once
+    kkt_ = Sparsity::kkt(H_, A_, true, true);
+    kkt_.qr_sparse(sp_v_, sp_r_, prinv_, pc_);
+    // Setup memory structure
+    set_ipqp_prob();
+    // Allocate memory
+    casadi_int sz_w, sz_iw;
+    casadi_ipqp_work(&p_, &sz_iw, &sz_w);
+    alloc_iw(sz_iw, true);
+    alloc_w(sz_w, true);
+    if (print_header_) {
+      // Print summary
+      print("-------------------------------------------\n");
+      print("This is casadi::IPQP\n");
+      print("Number of variables:                       %9d\n", nx_);
+      print("Number of constraints:                     %9d\n", na_);
+      print("Number of nonzeros in H:                   %9d\n", H_.nnz());
+      print("Number of nonzeros in A:                   %9d\n", A_.nnz());
+      print("Number of nonzeros in KKT:                 %9d\n", kkt_.nnz());
+      print("Number of nonzeros in QR(V):               %9d\n", sp_v_.nnz());
+      print("Number of nonzeros in QR(R):               %9d\n", sp_r_.nnz());
+    }
+  }
+
+  void Ipqp::set_ipqp_prob() {
+    p_.sp_a = A_;
+    p_.sp_h = H_;
+    p_.sp_at = AT_;
+    p_.sp_kkt = kkt_;
+    p_.sp_v = sp_v_;
+    p_.sp_r = sp_r_;
+    p_.prinv = get_ptr(prinv_);
+    p_.pc = get_ptr(pc_);
+    casadi_ipqp_setup(&p_);
+    p_.max_iter = max_iter_;
+    p_.constr_viol_tol = constr_viol_tol_;
+    p_.dual_inf_tol = dual_inf_tol_;
+    p_.compl_tol = compl_tol_;
+  }
+
+  int Ipqp::init_mem(void* mem) const {
+    if (Conic::init_mem(mem)) return 1;
+    auto m = static_cast<IpqpMemory*>(mem);
+    m->return_status = "";
+    return 0;
+  }
+
+  int Ipqp::
+  solve(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    auto m = static_cast<IpqpMemory*>(mem);
+    // Message buffer
+    char buf[121];
+    // Setup data structure
+    casadi_ipqp_data<double> d;
+    d.prob = &p_;
+    d.nz_h = arg[CONIC_H];
+    d.g = arg[CONIC_G];
+    d.nz_a = arg[CONIC_A];
+    casadi_ipqp_init(&d, &iw, &w);
+    // Pass bounds on z
+    casadi_copy(arg[CONIC_LBX], nx_, d.lbz);
+    casadi_copy(arg[CONIC_LBA], na_, d.lbz+nx_);
+    casadi_copy(arg[CONIC_UBX], nx_, d.ubz);
+    casadi_copy(arg[CONIC_UBA], na_, d.ubz+nx_);
+    // Pass initial guess
+    casadi_copy(arg[CONIC_X0], nx_, d.z);
+    casadi_copy(arg[CONIC_LAM_X0], nx_, d.lam);
+    casadi_copy(arg[CONIC_LAM_A0], na_, d.lam+nx_);
+    // Reset solver
+    if (casadi_ipqp_reset(&d)) return 1;
+    while (true) {
+      // Prepare QP
+      int flag = casadi_ipqp_prepare(&d);
+      // Print iteration progress
+      if (print_iter_) {
+        if (d.iter % 10 == 0) {
+          // Print header
+          if (casadi_ipqp_print_header(&d, buf, sizeof(buf))) break;
+          uout() << buf << "\n";
+        }
+        // Print iteration
+        if (casadi_ipqp_print_iteration(&d, buf, sizeof(buf))) break;
+        uout() << buf << "\n";
+      }
+      // Make an iteration
+      flag = flag || casadi_ipqp_iterate(&d);
+      // Termination?
+      if (flag) break;
+    }
+    // Get solution
+    casadi_copy(&d.f, 1, res[CONIC_COST]);
+    casadi_copy(d.z, nx_, res[CONIC_X]);
+    casadi_copy(d.lam, nx_, res[CONIC_LAM_X]);
+    casadi_copy(d.lam+nx_, na_, res[CONIC_LAM_A]);
+    // Return
+    if (verbose_) casadi_warning(d.msg);
+    m->return_status = d.msg;
+    m->iter_count = d.iter;
+    m->success = d.status == IPQP_SUCCESS;
+    if (m->success) {
+      m->unified_return_status = SOLVER_RET_SUCCESS;
+    } else if (d.status == IPQP_MAX_ITER) {
+      m->unified_return_status = SOLVER_RET_LIMITED;
+    }
+    return 0;
+  }
+
+  void Ipqp::codegen_body(CodeGenerator& g) const {
+    g.add_auxiliary(CodeGenerator::AUX_IPQP);
+    if (print_iter_) g.add_auxiliary(CodeGenerator::AUX_PRINTF);
+    g.local("d", "struct casadi_ipqp_data");
+    g.local("p", "struct casadi_ipqp_prob");
+    g.local("flag", "int");
+    if (print_iter_) g.local("print_buf[121]", "char");
+
+    // Setup memory structure
+    g << "p.sp_a = " << g.sparsity(A_) << ";\n";
+    g << "p.sp_h = " << g.sparsity(H_) << ";\n";
+    g << "p.sp_at = " << g.sparsity(AT_) << ";\n";
+    g << "p.sp_kkt = " << g.sparsity(kkt_) << ";\n";
+    g << "p.sp_v = " << g.sparsity(sp_v_) << ";\n";
+    g << "p.sp_r = " << g.sparsity(sp_r_) << ";\n";
+    g << "p.prinv = " << g.constant(prinv_) << ";\n";
+    g << "p.pc =  " << g.constant(pc_) << ";\n";
+    g << "casadi_ipqp_setup(&p);\n";
+    g << "p.max_iter = " << max_iter_ << ";\n";
+    g << "p.constr_viol_tol = " << constr_viol_tol_ << ";\n";
+    g << "p.dual_inf_tol = " << dual_inf_tol_ << ";\n";
+    g << "p.compl_tol = " << compl_tol_ << ";\n";
+
+    // Setup data structure
+    g << "d.prob = &p;\n";
+    g << "d.nz_h = arg[" << CONIC_H << "];\n";
+    g << "d.g = arg[" << CONIC_G << "];\n";
+    g << "d.nz_a = arg[" << CONIC_A << "];\n";
+    g << "casadi_ipqp_init(&d, &iw, &w);\n";
+
+    g.comment("Pass bounds on z");
+    g.copy_default("arg[" + str(CONIC_LBX) + "]", nx_, "d.lbz", "-casadi_inf", false);
+    g.copy_default("arg[" + str(CONIC_LBA) + "]", na_, "d.lbz+" + str(nx_),
+                   "-casadi_inf", false);
+    g.copy_default("arg[" + str(CONIC_UBX) + "]", nx_, "d.ubz", "casadi_inf", false);
+    g.copy_default("arg[" + str(CONIC_UBA) + "]", na_, "d.ubz+" + str(nx_),
+                   "casadi_inf", false);
+
+    g.comment("Pass initial guess");
+    g.copy_default("arg[" + str(CONIC_X0) + "]", nx_, "d.z", "0", false);
+    g.copy_default("arg[" + str(CONIC_LAM_X0) + "]", nx_, "d.lam", "0", false);
+    g.copy_default("arg[" + str(CONIC_LAM_A0) + "]", na_, "d.lam+" + str(nx_), "0", false);
+
+    g.comment("Solve QP");
+    g << "if (casadi_ipqp_reset(&d)) return 1;\n";
+    g << "while (1) {\n";
+    g << "flag = casadi_ipqp_prepare(&d);\n";
+    if (print_iter_) {
+      g << "if (d.iter % 10 == 0) {\n";
+      g << "if (casadi_ipqp_print_header(&d, print_buf, sizeof(print_buf))) break;\n";
+      g << g.printf("%s\\n", "print_buf") << "\n";
+      g << "}\n";
+      g << "if (casadi_ipqp_print_iteration(&d, print_buf, sizeof(print_buf))) break;\n";
+      g << g.printf("%s\\n", "print_buf") << "\n";
+    }
+    g << "if (flag || casadi_ipqp_iterate(&d)) break;\n";
+    g << "}\n";
+
+    g.comment("Get solution");
+    g.copy_check("&d.f", 1, "res[" + str(CONIC_COST) + "]", false, true);
+    g.copy_check("d.z", nx_, "res[" + str(CONIC_X) + "]", false, true);
+    g.copy_check("d.lam", nx_, "res[" + str(CONIC_LAM_X) + "]", false, true);
+    g.copy_check("d.lam+" + str(nx_), na_, "res[" + str(CONIC_LAM_A) + "]", false, true);
+    g << "return 0;\n";
+  }
+
+  Dict Ipqp::get_stats(void* mem) const {
+    Dict stats = Conic::get_stats(mem);
+    auto m = static_cast<IpqpMemory*>(mem);
+    stats["return_status"] = m->return_status;
+    stats["iter_count"] = m->iter_count;
+    return stats;
+  }
+
+  Ipqp::Ipqp(DeserializingStream& s) : Conic(s) {
+    s.version("Ipqp", 1);
+    s.unpack("Ipqp::AT", AT_);
+    s.unpack("Ipqp::kkt", kkt_);
+    s.unpack("Ipqp::sp_v", sp_v_);
+    s.unpack("Ipqp::sp_r", sp_r_);
+    s.unpack("Ipqp::prinv", prinv_);
+    s.unpack("Ipqp::pc", pc_);
+    s.unpack("Ipqp::print_iter", print_iter_);
+    s.unpack("Ipqp::print_header", print_header_);
+    s.unpack("Ipqp::max_iter", max_iter_);
+    s.unpack("Ipqp::constr_viol_tol", constr_viol_tol_);
+    s.unpack("Ipqp::dual_inf_tol", dual_inf_tol_);
+    s.unpack("Ipqp::compl_tol", compl_tol_);
+    set_ipqp_prob();
+  }
+
+  void Ipqp::serialize_body(SerializingStream &s) const {
+    Conic::serialize_body(s);
+    s.version("Ipqp", 1);
+    s.pack("Ipqp::AT", AT_);
+    s.pack("Ipqp::kkt", kkt_);
+    s.pack("Ipqp::sp_v", sp_v_);
+    s.pack("Ipqp::sp_r", sp_r_);
+    s.pack("Ipqp::prinv", prinv_);
+    s.pack("Ipqp::pc", pc_);
+    s.pack("Ipqp::print_iter", print_iter_);
+    s.pack("Ipqp::print_header", print_header_);
+    s.pack("Ipqp::max_iter", max_iter_);
+    s.pack("Ipqp::constr_viol_tol", constr_viol_tol_);
+    s.pack("Ipqp::dual_inf_tol", dual_inf_tol_);
+    s.pack("Ipqp::compl_tol", compl_tol_);
+  }
+
+} // namespace casadi
@@ -0,0 +1,148 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "linear_interpolant.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_INTERPOLANT_LINEAR_EXPORT
+  casadi_register_interpolant_linear(Interpolant::Plugin* plugin) {
+    plugin->creator = LinearInterpolant::creator;
+    plugin->name = "linear";
+    plugin->doc = LinearInterpolant::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Interpolant::options_;
+    plugin->deserialize = &LinearInterpolant::deserialize;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_INTERPOLANT_LINEAR_EXPORT casadi_load_interpolant_linear() {
+    Interpolant::registerPlugin(casadi_register_interpolant_linear);
+  }
+
+  LinearInterpolant::
+  LinearInterpolant(const string& name,
+                    const std::vector<double>& grid,
+                    const std::vector<casadi_int>& offset,
+                    const vector<double>& values,
+                    casadi_int m)
+                    : Interpolant(name, grid, offset, values, m) {
+  }
+
+  LinearInterpolant::~LinearInterpolant() {
+    clear_mem();
+  }
+
+  int LinearInterpolant::
+  eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    if (res[0]) {
+      const double* values = is_parametric() ? arg[1] : get_ptr(values_);
+      if (batch_x_==1) {
+        casadi_interpn(res[0], ndim_, get_ptr(grid_), get_ptr(offset_), values, arg[0],
+                       get_ptr(lookup_mode_), get_ptr(lookup_index_),
+                       get_ptr(lookup_index_offset_), m_, iw, w);
+      } else {
+        interpn_batch(res[0], arg[0], values, iw, w);
+      }
+    }
+    return 0;
+  }
+
+  void LinearInterpolant::codegen_body(CodeGenerator& g) const {
+    string values = is_parametric() ? "arg[1]" : g.constant(values_);
+    g << "if (res[0]) {\n";
+    if (batch_x_==1) {
+      g << g.interpn("res[0]", ndim_, g.constant(grid_), g.constant(offset_), values,
+                     "arg[0]", g.constant(lookup_mode_),
+                     lookup_index_.empty() ? "0" : g.constant(lookup_index_),
+                     g.constant(lookup_index_offset_), m_, "iw", "w") << "\n";
+    } else {
+      g << codegen_interpn_batch(g, "res[0]", "arg[0]", values, "iw", "w") << "\n";
+    }
+    g << "}\n";
+  }
+
+  Function LinearInterpolant::
+  get_jacobian(const std::string& name,
+                   const std::vector<std::string>& inames,
+                   const std::vector<std::string>& onames,
+                   const Dict& opts) const {
+    Function ret;
+    ret.own(new LinearInterpolantJac(name));
+    ret->construct(opts);
+    return ret;
+  }
+
+  Sparsity LinearInterpolantJac::get_sparsity_out(casadi_int i) {
+    auto m = derivative_of_.get<LinearInterpolant>();
+    casadi_assert_dev(i==0);
+    // Each query point only depends on its own coordinates
+    return Sparsity::kron(Sparsity::diag(m->batch_x_), Sparsity::dense(m->m_, m->ndim_));
+  }
+
+  void LinearInterpolantJac::init(const Dict& opts) {
+    // Call the base class initializer
+    FunctionInternal::init(opts);
+
+    // Needed by casadi_interpn_grad
+    auto m = derivative_of_.get<LinearInterpolant>();
+    alloc_w(2*m->ndim_ + m->m_, true);
+    alloc_iw(2*m->ndim_, true);
+  }
+
+  int LinearInterpolantJac::
+  eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    auto m = derivative_of_.get<LinearInterpolant>();
+    if (!res[0]) return 0;
+    // One dense m-by-ndim block per query point
+    for (casadi_int k=0; k<m->batch_x_; ++k) {
+      casadi_interpn_grad(res[0] + k*m->m_*m->ndim_, m->ndim_, get_ptr(m->grid_),
+                          get_ptr(m->offset_), get_ptr(m->values_),
+                          arg[0] ? arg[0] + k*m->ndim_ : nullptr,
+                          get_ptr(m->lookup_mode_), get_ptr(m->lookup_index_),
+                          get_ptr(m->lookup_index_offset_), m->m_, iw, w);
+    }
+    return 0;
+  }
+
+  void LinearInterpolantJac::codegen_body(CodeGenerator& g) const {
+    auto m = derivative_of_.get<LinearInterpolant>();
+    g.local("k", "casadi_int");
+    g << "if (res[0]) {\n";
+    g << "for (k=0; k<" << m->batch_x_ << "; ++k) {\n";
+    g << g.interpn_grad("res[0]+k*" + str(m->m_*m->ndim_), m->ndim_,
+                        g.constant(m->grid_), g.constant(m->offset_),
+                        g.constant(m->values_), "arg[0]+k*" + str(m->ndim_),
+                        g.constant(m->lookup_mode_),
+                        m->lookup_index_.empty() ? "0" : g.constant(m->lookup_index_),
+                        g.constant(m->lookup_index_offset_), m->m_, "iw", "w") << "\n";
+    g << "}\n";
+    g << "}\n";
+  }
+
+} // namespace casadi
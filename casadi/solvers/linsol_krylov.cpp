@@ -0,0 +1,346 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "linsol_krylov.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_LINSOL_KRYLOV_EXPORT
+  casadi_register_linsol_krylov(LinsolInternal::Plugin* plugin) {
+    plugin->creator = LinsolKrylov::creator;
+    plugin->name = "krylov";
+    plugin->doc = LinsolKrylov::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &LinsolKrylov::options_;
+    plugin->deserialize = &LinsolKrylov::deserialize;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_LINSOL_KRYLOV_EXPORT casadi_load_linsol_krylov() {
+    LinsolInternal::registerPlugin(casadi_register_linsol_krylov);
+  }
+
+  LinsolKrylov::LinsolKrylov(const std::string& name, const Sparsity& sp)
+    : LinsolInternal(name, sp) {
+  }
+
+  LinsolKrylov::~LinsolKrylov() {
+    clear_mem();
+  }
+
+  const Options LinsolKrylov::options_
+  = {{&LinsolInternal::options_},
+     {{"method",
+       {OT_STRING,
+        "Krylov method: 'cg' (symmetric positive definite), "
+        "'minres' (symmetric) or 'gmres' (general) [gmres]."}},
+      {"preconditioner",
+       {OT_STRING,
+        "Preconditioner: 'none', 'jacobi', 'ilu0' or 'ic0' "
+        "[ilu0, none if matrix-free]."}},
+      {"restart",
+       {OT_INT,
+        "GMRES restart length [min(n, 30)]."}},
+      {"max_iter",
+       {OT_INT,
+        "Maximum number of iterations per right-hand-side [10*n]."}},
+      {"tol",
+       {OT_DOUBLE,
+        "Relative residual tolerance [1e-10]."}},
+      {"mv",
+       {OT_FUNCTION,
+        "Function v -> A*v used instead of the matrix nonzeros (matrix-free)."}},
+      {"mv_tr",
+       {OT_FUNCTION,
+        "Function v -> A'*v for transposed matrix-free solves [mv]."}}
+     }
+  };
+
+  void LinsolKrylov::init(const Dict& opts) {
+    // Call the init method of the base class
+    LinsolInternal::init(opts);
+
+    // Default options
+    casadi_int n = sp_.size1();
+    method_ = "gmres";
+    precon_ = "";
+    restart_ = std::min(n, casadi_int(30));
+    max_iter_ = 10*n;
+    tol_ = 1e-10;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="method") {
+        method_ = op.second.to_string();
+      } else if (op.first=="preconditioner") {
+        precon_ = op.second.to_string();
+      } else if (op.first=="restart") {
+        restart_ = op.second;
+      } else if (op.first=="max_iter") {
+        max_iter_ = op.second;
+      } else if (op.first=="tol") {
+        tol_ = op.second;
+      } else if (op.first=="mv") {
+        mv_ = op.second;
+      } else if (op.first=="mv_tr") {
+        mv_tr_ = op.second;
+      }
+    }
+    if (precon_.empty()) precon_ = mv_.is_null() ? "ilu0" : "none";
+
+    // Sanity checks
+    casadi_assert(sp_.is_square(), "Krylov methods require a square matrix");
+    casadi_assert(method_=="cg" || method_=="minres" || method_=="gmres",
+      "Unknown Krylov method '" + method_ + "'. Options are 'cg', 'minres' and 'gmres'");
+    casadi_assert(precon_=="none" || precon_=="jacobi" || precon_=="ilu0" || precon_=="ic0",
+      "Unknown preconditioner '" + precon_ + "'. "
+      "Options are 'none', 'jacobi', 'ilu0' and 'ic0'");
+    casadi_assert(restart_>0 || n==0, "'restart' must be positive");
+    if (precon_=="ilu0" || precon_=="ic0") {
+      casadi_assert(sp_.nnz_diag()==n,
+        "Preconditioner '" + precon_ + "' requires a structurally nonzero diagonal");
+    }
+    for (const Function* f : {&mv_, &mv_tr_}) {
+      if (f->is_null()) continue;
+      casadi_assert(f->n_in()==1 && f->n_out()==1,
+        "Matrix-free operator must have one input and one output");
+      casadi_assert(f->nnz_in(0)==n && f->nnz_out(0)==n,
+        "Matrix-free operator must map vectors of length " + str(n));
+    }
+    casadi_assert(mv_tr_.is_null() || !mv_.is_null(), "'mv_tr' requires 'mv'");
+
+    // Setup memory structure
+    set_krylov_prob();
+  }
+
+  void LinsolKrylov::set_krylov_prob() {
+    casadi_int n = sp_.size1();
+    casadi_krylov_setup(&p_, static_cast<const casadi_int*>(sp_), n);
+    if (method_=="cg") {
+      p_.method = KRYLOV_CG;
+    } else if (method_=="minres") {
+      p_.method = KRYLOV_MINRES;
+    } else {
+      p_.method = KRYLOV_GMRES;
+    }
+    if (precon_=="jacobi") {
+      p_.precon = KRYLOV_PRECON_JACOBI;
+    } else if (precon_=="ilu0") {
+      p_.precon = KRYLOV_PRECON_ILU0;
+    } else if (precon_=="ic0") {
+      p_.precon = KRYLOV_PRECON_IC0;
+    } else {
+      p_.precon = KRYLOV_PRECON_NONE;
+    }
+    p_.restart = std::min(restart_, n);
+    p_.max_iter = max_iter_;
+    p_.tol = tol_;
+  }
+
+  int LinsolKrylov::init_mem(void* mem) const {
+    if (LinsolInternal::init_mem(mem)) return 1;
+    auto m = static_cast<LinsolKrylovMemory*>(mem);
+
+    // Work vectors of the runtime
+    casadi_int sz_iw, sz_w;
+    casadi_krylov_work(&p_, &sz_iw, &sz_w);
+    m->iw.resize(sz_iw);
+    m->w.resize(sz_w);
+    casadi_int* iw = get_ptr(m->iw);
+    double* w = get_ptr(m->w);
+    m->d.prob = &p_;
+    casadi_krylov_init(&m->d, &iw, &w);
+
+    // Work vectors and memory for the matrix-vector products
+    size_t sz_arg = 0, sz_res = 0, sz_iw_f = 0, sz_w_f = 0;
+    for (const Function* f : {&mv_, &mv_tr_}) {
+      if (f->is_null()) continue;
+      sz_arg = std::max(sz_arg, f->sz_arg());
+      sz_res = std::max(sz_res, f->sz_res());
+      sz_iw_f = std::max(sz_iw_f, f->sz_iw());
+      sz_w_f = std::max(sz_w_f, f->sz_w());
+    }
+    m->mv_arg.resize(sz_arg);
+    m->mv_res.resize(sz_res);
+    m->mv_iw.resize(sz_iw_f);
+    m->mv_w.resize(sz_w_f);
+    m->mv_mem = mv_.is_null() ? -1 : mv_.checkout();
+    m->mv_tr_mem = mv_tr_.is_null() ? -1 : mv_tr_.checkout();
+    return 0;
+  }
+
+  void LinsolKrylov::free_mem(void *mem) const {
+    auto m = static_cast<LinsolKrylovMemory*>(mem);
+    if (m->mv_mem>=0) mv_.release(m->mv_mem);
+    if (m->mv_tr_mem>=0) mv_tr_.release(m->mv_tr_mem);
+    delete m;
+  }
+
+  int LinsolKrylov::nfact(void* mem, const double* A) const {
+    auto m = static_cast<LinsolKrylovMemory*>(mem);
+    m->d.nz_a = A;
+    if (casadi_krylov_precon_fact(&m->d)) {
+      if (verbose_) casadi_warning("LinsolKrylov::nfact: preconditioner '" + precon_ + "' failed");
+      return 1;
+    }
+    return 0;
+  }
+
+  int LinsolKrylov::solve(void* mem, const double* A, double* x, casadi_int nrhs,
+                          bool tr) const {
+    auto m = static_cast<LinsolKrylovMemory*>(mem);
+    casadi_int n = sp_.size1();
+    m->d.nz_a = A;
+
+    // Explicit matrix
+    if (mv_.is_null()) return casadi_krylov_solve(&m->d, x, nrhs, tr);
+
+    // Matrix-free: evaluate the products with the user function
+    const Function& f = mv(tr);
+    casadi_int f_mem = tr && !mv_tr_.is_null() ? m->mv_tr_mem : m->mv_mem;
+    casadi_assert(!tr || !mv_tr_.is_null() || method_!="gmres",
+      "Transposed matrix-free GMRES solves require 'mv_tr'");
+    int flag = 0;
+    for (casadi_int k=0; k<nrhs; ++k) {
+      m->d.x = x + k*n;
+      casadi_krylov_reset(&m->d, tr);
+      while (casadi_krylov_iterate(&m->d)) {
+        m->mv_arg[0] = m->d.mv_in;
+        m->mv_res[0] = m->d.mv_out;
+        if (f(get_ptr(m->mv_arg), get_ptr(m->mv_res), get_ptr(m->mv_iw),
+              get_ptr(m->mv_w), f_mem)) return 1;
+      }
+      if (m->d.status!=KRYLOV_SUCCESS) flag = 1;
+    }
+    return flag;
+  }
+
+  void LinsolKrylov::codegen_work(casadi_int nrhs, size_t& sz_iw, size_t& sz_w) const {
+    // Includes the preconditioner factors and the ILU(0)/IC(0) index vectors
+    casadi_int sz_iw_k, sz_w_k;
+    casadi_krylov_work(&p_, &sz_iw_k, &sz_w_k);
+    sz_iw = sz_iw_k;
+    sz_w = sz_w_k;
+    // The matrix-vector products work after the Krylov vectors
+    size_t sz_iw_f = 0, sz_w_f = 0;
+    for (const Function* f : {&mv_, &mv_tr_}) {
+      if (f->is_null()) continue;
+      sz_iw_f = std::max(sz_iw_f, f->sz_iw());
+      sz_w_f = std::max(sz_w_f, f->sz_w());
+    }
+    sz_iw += sz_iw_f;
+    sz_w += sz_w_f;
+  }
+
+  void LinsolKrylov::generate(CodeGenerator& g, const std::string& A, const std::string& x,
+                              casadi_int nrhs, bool tr) const {
+    casadi_int n = sp_.size1();
+    g.add_auxiliary(CodeGenerator::AUX_KRYLOV);
+
+    // Place in block to avoid conflicts caused by local variables
+    g << "{\n";
+    g << "struct casadi_krylov_prob p;\n";
+    g << "struct casadi_krylov_data d;\n";
+    g << "casadi_int *iwp = iw;\n";
+    g << "casadi_real *wp = w;\n";
+    std::string fname;
+    if (!mv_.is_null()) {
+      // Matrix-free: call the product function by reverse communication
+      const Function& f = mv(tr);
+      casadi_assert(!tr || !mv_tr_.is_null() || method_!="gmres",
+        "Transposed matrix-free GMRES solves require 'mv_tr'");
+      fname = g.add_dependency(f);
+      g << "const casadi_real* mv_arg[" << f.sz_arg() << "];\n";
+      g << "casadi_real* mv_res[" << f.sz_res() << "];\n";
+      g << "casadi_int k;\n";
+    }
+
+    // Setup memory structure
+    g << "casadi_krylov_setup(&p, " << g.sparsity(sp_) << ", " << n << ");\n";
+    g << "p.method = " << (method_=="cg" ? "KRYLOV_CG" :
+                           method_=="minres" ? "KRYLOV_MINRES" : "KRYLOV_GMRES") << ";\n";
+    g << "p.precon = " << (p_.precon==KRYLOV_PRECON_JACOBI ? "KRYLOV_PRECON_JACOBI" :
+                           p_.precon==KRYLOV_PRECON_ILU0 ? "KRYLOV_PRECON_ILU0" :
+                           p_.precon==KRYLOV_PRECON_IC0 ? "KRYLOV_PRECON_IC0" :
+                           "KRYLOV_PRECON_NONE") << ";\n";
+    g << "p.restart = " << p_.restart << ";\n";
+    g << "p.max_iter = " << max_iter_ << ";\n";
+    g << "p.tol = " << CodeGenerator::constant(tol_) << ";\n";
+    g << "d.prob = &p;\n";
+    g << "casadi_krylov_init(&d, &iwp, &wp);\n";
+    g << "d.nz_a = " << A << ";\n";
+    if (p_.precon!=KRYLOV_PRECON_NONE) {
+      g << "if (casadi_krylov_precon_fact(&d)) return 1;\n";
+    }
+
+    if (mv_.is_null()) {
+      g << "if (casadi_krylov_solve(&d, " << x << ", " << nrhs << ", "
+        << (tr ? "1" : "0") << ")) return 1;\n";
+    } else {
+      g << "for (k=0; k<" << nrhs << "; ++k) {\n";
+      g << "d.x = " << x << " + k*" << n << ";\n";
+      g << "casadi_krylov_reset(&d, " << (tr ? "1" : "0") << ");\n";
+      g << "while (casadi_krylov_iterate(&d)) {\n";
+      g << "mv_arg[0] = d.mv_in;\n";
+      g << "mv_res[0] = d.mv_out;\n";
+      g << "if (" << fname << "(mv_arg, mv_res, iwp, wp, 0)) return 1;\n";
+      g << "}\n";
+      g << "if (d.status!=KRYLOV_SUCCESS) return 1;\n";
+      g << "}\n";
+    }
+
+    // End of block
+    g << "}\n";
+  }
+
+  LinsolKrylov::LinsolKrylov(DeserializingStream& s) : LinsolInternal(s) {
+    s.version("LinsolKrylov", 1);
+    s.unpack("LinsolKrylov::method", method_);
+    s.unpack("LinsolKrylov::precon", precon_);
+    s.unpack("LinsolKrylov::restart", restart_);
+    s.unpack("LinsolKrylov::max_iter", max_iter_);
+    s.unpack("LinsolKrylov::tol", tol_);
+    s.unpack("LinsolKrylov::mv", mv_);
+    s.unpack("LinsolKrylov::mv_tr", mv_tr_);
+    set_krylov_prob();
+  }
+
+  void LinsolKrylov::serialize_body(SerializingStream &s) const {
+    LinsolInternal::serialize_body(s);
+    s.version("LinsolKrylov", 1);
+    s.pack("LinsolKrylov::method", method_);
+    s.pack("LinsolKrylov::precon", precon_);
+    s.pack("LinsolKrylov::restart", restart_);
+    s.pack("LinsolKrylov::max_iter", max_iter_);
+    s.pack("LinsolKrylov::tol", tol_);
+    s.pack("LinsolKrylov::mv", mv_);
+    s.pack("LinsolKrylov::mv_tr", mv_tr_);
+  }
+
+} // namespace casadi
@@ -0,0 +1,148 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_LINSOL_KRYLOV_HPP
+#define CASADI_LINSOL_KRYLOV_HPP
+
+/** \defgroup plugin_Linsol_krylov
+ * Linear solver using preconditioned Krylov subspace iterations
+ */
+
+/** \pluginsection{Linsol,krylov} */
+
+/// \cond INTERNAL
+#include "casadi/core/linsol_internal.hpp"
+#include <casadi/solvers/casadi_linsol_krylov_export.h>
+
+namespace casadi {
+  struct CASADI_LINSOL_KRYLOV_EXPORT LinsolKrylovMemory : public LinsolMemory {
+    // Runtime data structure
+    casadi_krylov_data<double> d;
+    // Work vectors
+    std::vector<casadi_int> iw;
+    std::vector<double> w;
+    // Work vectors for the matrix-vector product functions
+    std::vector<const double*> mv_arg;
+    std::vector<double*> mv_res;
+    std::vector<casadi_int> mv_iw;
+    std::vector<double> mv_w;
+    casadi_int mv_mem, mv_tr_mem;
+  };
+
+  /** \brief \pluginbrief{Linsol,krylov}
+   * @copydoc Linsol_doc
+   * @copydoc plugin_Linsol_krylov
+   */
+  class CASADI_LINSOL_KRYLOV_EXPORT LinsolKrylov : public LinsolInternal {
+  public:
+
+    // Create a linear solver given a sparsity pattern and a number of right hand sides
+    LinsolKrylov(const std::string& name, const Sparsity& sp);
+
+    /** \brief  Create a new Linsol */
+    static LinsolInternal* creator(const std::string& name, const Sparsity& sp) {
+      return new LinsolKrylov(name, sp);
+    }
+
+    // Destructor
+    ~LinsolKrylov() override;
+
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    // Initialize the solver
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new LinsolKrylovMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override;
+
+    // Factorize the linear system
+    int nfact(void* mem, const double* A) const override;
+
+    // Solve the linear system
+    int solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const override;
+
+    /// Work vector lengths of the generated code
+    void codegen_work(casadi_int nrhs, size_t& sz_iw, size_t& sz_w) const override;
+
+    /// Generate C code
+    void generate(CodeGenerator& g, const std::string& A, const std::string& x,
+                  casadi_int nrhs, bool tr) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "krylov";}
+
+    // Get name of the class
+    std::string class_name() const override { return "LinsolKrylov";}
+
+    // Runtime problem structure
+    casadi_krylov_prob<double> p_;
+
+    ///@{
+    // Options
+    std::string method_, precon_;
+    casadi_int restart_, max_iter_;
+    double tol_;
+    ///@}
+
+    // Matrix-free operators
+    Function mv_, mv_tr_;
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+
+    /** \brief Deserialize with type disambiguation */
+    static ProtoFunction* deserialize(DeserializingStream& s) { return new LinsolKrylov(s); }
+
+  protected:
+    /** \brief Deserializing constructor */
+    explicit LinsolKrylov(DeserializingStream& s);
+
+  private:
+    /** \brief Set the runtime problem structure */
+    void set_krylov_prob();
+
+    /** \brief Matrix-vector product function to use */
+    const Function& mv(bool tr) const { return tr && !mv_tr_.is_null() ? mv_tr_ : mv_;}
+  };
+
+} // namespace casadi
+
+/// \endcond
+
+#endif // CASADI_LINSOL_KRYLOV_HPP
@@ -0,0 +1,39 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+
+      #include "linsol_krylov.hpp"
+      #include <string>
+
+      const std::string casadi::LinsolKrylov::meta_doc=
+      "\n"
+"Linear solver using preconditioned Krylov subspace iterations:\n"
+"conjugate gradients (symmetric positive definite systems), MINRES\n"
+"(symmetric systems) or restarted GMRES (general systems). Available\n"
+"preconditioners are Jacobi, ILU(0) and IC(0), computed on the sparsity\n"
+"pattern of the matrix. With the 'mv' option, matrix-vector products are\n"
+"evaluated with a user Function instead of the matrix nonzeros.\n"
+"\n";
@@ -0,0 +1,287 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "qrqp.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_CONIC_QRQP_EXPORT
+  casadi_register_conic_qrqp(Conic::Plugin* plugin) {
+    plugin->creator = Qrqp::creator;
+    plugin->name = "qrqp";
+    plugin->doc = Qrqp::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Qrqp::options_;
+    plugin->deserialize = &Qrqp::deserialize;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_CONIC_QRQP_EXPORT casadi_load_conic_qrqp() {
+    Conic::registerPlugin(casadi_register_conic_qrqp);
+  }
+
+  Qrqp::Qrqp(const std::string& name, const std::map<std::string, Sparsity> &st)
+    : Conic(name, st) {
+  }
+
+  Qrqp::~Qrqp() {
+    clear_mem();
+  }
+
+  const Options Qrqp::options_
+  = {{&Conic::options_},
+     {{"max_iter",
+       {OT_INT,
+        "Maximum number of iterations [1000]."}},
+      {"constr_viol_tol",
+       {OT_DOUBLE,
+        "Constraint violation tolerance [1e-8]."}},
+      {"dual_inf_tol",
+       {OT_DOUBLE,
+        "Dual feasibility violation tolerance [1e-8]"}},
+      {"min_lam",
+       {OT_DOUBLE,
+        "Smallest multiplier treated as inactive for the initial active set [0]."}},
+      {"max_upd",
+       {OT_INT,
+        "Maximum number of low-rank updates before the KKT matrix is refactorized [10]."}},
+      {"hot_start",
+       {OT_BOOL,
+        "Keep the active set and the KKT factorization between solves. The factorization "
+        "is reused when H and A are unchanged [true]."}},
+      {"print_header",
+       {OT_BOOL,
+        "Print header [true]."}},
+      {"print_iter",
+       {OT_BOOL,
+        "Print iterations [true]."}}
+     }
+  };
+
+  void Qrqp::init(const Dict& opts) {
+    // Initialize the base classes
+    Conic::init(opts);
+    // Default options
+    print_iter_ = true;
+    print_header_ = true;
+    hot_start_ = true;
+    max_iter_ = 1000;
+    max_upd_ = 10;
+    constr_viol_tol_ = 1e-8;
+    dual_inf_tol_ = 1e-8;
+    min_lam_ = 0;
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="max_iter") {
+        max_iter_ = op.second;
+      } else if (op.first=="max_upd") {
+        max_upd_ = op.second;
+      } else if (op.first=="constr_viol_tol") {
+        constr_viol_tol_ = op.second;
+      } else if (op.first=="dual_inf_tol") {
+        dual_inf_tol_ = op.second;
+      } else if (op.first=="min_lam") {
+        min_lam_ = op.second;
+      } else if (op.first=="hot_start") {
+        hot_start_ = op.second;
+      } else if (op.first=="print_iter") {
+        print_iter_ = op.second;
+      } else if (op.first=="print_header") {
+        print_header_ = op.second;
+      }
+    }
+    casadi_assert(max_upd_>=0, "'max_upd' must be nonnegative");
+    // Transpose of the Jacobian
+    AT_ = A_.T();
+    // Assemble KKT system sparsity, symbolic factorization done once
+    kkt_ = Sparsity::kkt(H_, A_, true, true);
+    kkt_.qr_sparse(sp_v_, sp_r_, prinv_, pc_);
+    // Setup memory structure
+    set_qp_prob();
+    // The work vectors are owned by the memory object, see init_mem
+    if (print_header_) {
+      // Print summary
+      print("-------------------------------------------\n");
+      print("This is casadi::QRQP\n");
+      print("Number of variables:                       %9d\n", nx_);
+      print("Number of constraints:                     %9d\n", na_);
+      print("Number of nonzeros in H:                   %9d\n", H_.nnz());
+      print("Number of nonzeros in A:                   %9d\n", A_.nnz());
+      print("Number of nonzeros in KKT:                 %9d\n", kkt_.nnz());
+      print("Number of nonzeros in QR(V):               %9d\n", sp_v_.nnz());
+      print("Number of nonzeros in QR(R):               %9d\n", sp_r_.nnz());
+    }
+  }
+
+  void Qrqp::set_qp_prob() {
+    p_.sp_a = A_;
+    p_.sp_h = H_;
+    p_.sp_at = AT_;
+    p_.sp_kkt = kkt_;
+    p_.sp_v = sp_v_;
+    p_.sp_r = sp_r_;
+    p_.prinv = get_ptr(prinv_);
+    p_.pc = get_ptr(pc_);
+    casadi_qp_setup(&p_);
+    p_.max_iter = max_iter_;
+    p_.max_upd = max_upd_;
+    p_.constr_viol_tol = constr_viol_tol_;
+    p_.dual_inf_tol = dual_inf_tol_;
+    p_.min_lam = min_lam_;
+  }
+
+  int Qrqp::init_mem(void* mem) const {
+    if (Conic::init_mem(mem)) return 1;
+    auto m = static_cast<QrqpMemory*>(mem);
+    m->return_status = "";
+    m->iter_count = 0;
+    m->solved = false;
+    // Work vectors live as long as the memory, so that the factorization
+    // and the active set survive between solves
+    casadi_int sz_w, sz_iw;
+    casadi_qp_work(&p_, &sz_iw, &sz_w);
+    m->iw.resize(sz_iw);
+    m->w.resize(sz_w);
+    m->d.prob = &p_;
+    casadi_int* iw = get_ptr(m->iw);
+    double* w = get_ptr(m->w);
+    casadi_qp_init(&m->d, &iw, &w);
+    return 0;
+  }
+
+  int Qrqp::
+  solve(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    auto m = static_cast<QrqpMemory*>(mem);
+    casadi_qp_data<double>& d = m->d;
+    // Message buffer
+    char buf[121];
+    // Pass QP data
+    d.nz_h = arg[CONIC_H];
+    d.g = arg[CONIC_G];
+    d.nz_a = arg[CONIC_A];
+    // Pass bounds on z
+    casadi_copy(arg[CONIC_LBX], nx_, d.lbz);
+    casadi_copy(arg[CONIC_LBA], na_, d.lbz+nx_);
+    casadi_copy(arg[CONIC_UBX], nx_, d.ubz);
+    casadi_copy(arg[CONIC_UBA], na_, d.ubz+nx_);
+    // Pass initial guess, if not given keep the solution of the previous solve
+    bool keep = hot_start_ && m->solved;
+    if (!keep || arg[CONIC_X0]) casadi_copy(arg[CONIC_X0], nx_, d.z);
+    if (!keep || arg[CONIC_LAM_X0]) casadi_copy(arg[CONIC_LAM_X0], nx_, d.lam);
+    if (!keep || arg[CONIC_LAM_A0]) casadi_copy(arg[CONIC_LAM_A0], na_, d.lam+nx_);
+    // Discard the factorization of the previous solve
+    if (!hot_start_) d.n_upd = -1;
+    // Reset solver
+    if (casadi_qp_reset(&d)) return 1;
+    while (true) {
+      // Prepare QP
+      int flag = casadi_qp_prepare(&d);
+      // Print iteration progress
+      if (print_iter_) {
+        if (d.iter % 10 == 0) {
+          // Print header
+          if (casadi_qp_print_header(&d, buf, sizeof(buf))) break;
+          uout() << buf << "\n";
+        }
+        // Print iteration
+        if (casadi_qp_print_iteration(&d, buf, sizeof(buf))) break;
+        uout() << buf << "\n";
+      }
+      // Make an iteration
+      flag = flag || casadi_qp_iterate(&d);
+      // Termination?
+      if (flag) break;
+    }
+    m->solved = true;
+    // Get solution
+    casadi_copy(&d.f, 1, res[CONIC_COST]);
+    casadi_copy(d.z, nx_, res[CONIC_X]);
+    casadi_copy(d.lam, nx_, res[CONIC_LAM_X]);
+    casadi_copy(d.lam+nx_, na_, res[CONIC_LAM_A]);
+    // Return
+    if (verbose_) casadi_warning(d.msg);
+    m->return_status = d.msg;
+    m->iter_count = d.iter;
+    m->success = d.status == QP_SUCCESS;
+    if (m->success) {
+      m->unified_return_status = SOLVER_RET_SUCCESS;
+    } else if (d.status == QP_MAX_ITER) {
+      m->unified_return_status = SOLVER_RET_LIMITED;
+    }
+    return 0;
+  }
+
+  Dict Qrqp::get_stats(void* mem) const {
+    Dict stats = Conic::get_stats(mem);
+    auto m = static_cast<QrqpMemory*>(mem);
+    stats["return_status"] = m->return_status;
+    stats["iter_count"] = m->iter_count;
+    stats["hot_start"] = static_cast<bool>(m->d.hot_start);
+    return stats;
+  }
+
+  Qrqp::Qrqp(DeserializingStream& s) : Conic(s) {
+    s.version("Qrqp", 1);
+    s.unpack("Qrqp::AT", AT_);
+    s.unpack("Qrqp::kkt", kkt_);
+    s.unpack("Qrqp::sp_v", sp_v_);
+    s.unpack("Qrqp::sp_r", sp_r_);
+    s.unpack("Qrqp::prinv", prinv_);
+    s.unpack("Qrqp::pc", pc_);
+    s.unpack("Qrqp::print_iter", print_iter_);
+    s.unpack("Qrqp::print_header", print_header_);
+    s.unpack("Qrqp::hot_start", hot_start_);
+    s.unpack("Qrqp::max_iter", max_iter_);
+    s.unpack("Qrqp::max_upd", max_upd_);
+    s.unpack("Qrqp::constr_viol_tol", constr_viol_tol_);
+    s.unpack("Qrqp::dual_inf_tol", dual_inf_tol_);
+    s.unpack("Qrqp::min_lam", min_lam_);
+    set_qp_prob();
+  }
+
+  void Qrqp::serialize_body(SerializingStream &s) const {
+    Conic::serialize_body(s);
+    s.version("Qrqp", 1);
+    s.pack("Qrqp::AT", AT_);
+    s.pack("Qrqp::kkt", kkt_);
+    s.pack("Qrqp::sp_v", sp_v_);
+    s.pack("Qrqp::sp_r", sp_r_);
+    s.pack("Qrqp::prinv", prinv_);
+    s.pack("Qrqp::pc", pc_);
+    s.pack("Qrqp::print_iter", print_iter_);
+    s.pack("Qrqp::print_header", print_header_);
+    s.pack("Qrqp::hot_start", hot_start_);
+    s.pack("Qrqp::max_iter", max_iter_);
+    s.pack("Qrqp::max_upd", max_upd_);
+    s.pack("Qrqp::constr_viol_tol", constr_viol_tol_);
+    s.pack("Qrqp::dual_inf_tol", dual_inf_tol_);
+    s.pack("Qrqp::min_lam", min_lam_);
+  }
+
+} // namespace casadi
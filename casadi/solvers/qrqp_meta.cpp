@@ -0,0 +1,38 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+      #include "qrqp.hpp"
+      #include <string>
+
+      const std::string casadi::Qrqp::meta_doc=
+      "\n"
+"Solve QPs using a primal-dual active-set method. The KKT system is\n"
+"factorized with a sparse QR factorization, updated with low-rank\n"
+"corrections when the active set changes. The factorization and the\n"
+"active set are kept in the memory object: when H and A are unchanged\n"
+"from the previous solve, only the vectors are new and the solver hot\n"
+"starts from the previous factorization.\n"
+"\n";
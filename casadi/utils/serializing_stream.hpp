@@ -136,6 +136,8 @@ namespace casadi {
     //@}
 
     void version(const std::string& name, int v);
+    /// Accept versions min to max, returning the version read
+    int version(const std::string& name, int min, int max);
 
   private:
 
@@ -55,4 +55,22 @@ namespace casadi {
     n_call +=1;
   }
 
+  double timestamp_period() {
+#ifdef CASADI_HAS_RDTSC
+    // Count ticks over a short busy wait
+    static const double period = [] {
+      auto start_wall = steady_clock::now();
+      unsigned long long start_tick = timestamp();
+      duration<double> dt;
+      do {
+        dt = steady_clock::now() - start_wall;
+      } while (dt.count() < 0.01);
+      return dt.count() / static_cast<double>(timestamp() - start_tick);
+    }();
+    return period;
+#else // CASADI_HAS_RDTSC
+    return 1e-9;
+#endif // CASADI_HAS_RDTSC
+  }
+
 } // namespace casadi
@@ -31,6 +31,14 @@
 #include <chrono>
 #include <ctime>
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define CASADI_HAS_RDTSC
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define CASADI_HAS_RDTSC
+#endif
+
 namespace casadi {
   /// \cond INTERNAL
 
@@ -80,6 +88,22 @@ namespace casadi {
       /// Accumulated proc time [s] since last reset
       double t_proc;
   };
+
+  /** \brief Low-overhead time stamp in ticks
+
+      Reads the time stamp counter where available, otherwise a steady clock
+      in nanoseconds. Only differences of time stamps are meaningful. */
+  inline unsigned long long timestamp() {
+#ifdef CASADI_HAS_RDTSC
+    return __rdtsc();
+#else // CASADI_HAS_RDTSC
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif // CASADI_HAS_RDTSC
+  }
+
+  /// Duration of a timestamp tick [s], calibrated on the first call
+  CASADI_EXPORT double timestamp_period();
 /// \endcond
 } // namespace casadi
 